@@ -0,0 +1,60 @@
+#pragma once
+
+// A thread safe pool of fixed size blocks, used for memory that is allocated and freed at a high rate (such as the
+// voxel data of chunks that are streamed in and out).
+// Blocks are carved out of large pages. Freed blocks are put in a free list and re-used, and pages are only returned to
+// the system when the pool is destroyed. So, once the pool has grown to the working set, allocating or freeing a block
+// does not touch the heap at all, which is what the statistics can be used to verify.
+// On Linux, pages are mapped directly and (if VX_ENABLE_HUGE_PAGES is set) backed by transparent huge pages.
+struct BlockPool
+{
+    // Block size is rounded up to a multiple of BLOCK_ALIGNMENT.
+    explicit BlockPool(const size_t block_size, const size_t page_size = DEFAULT_PAGE_SIZE);
+
+    BlockPool(const BlockPool &other) = delete;
+    BlockPool &operator=(const BlockPool &other) = delete;
+
+    ~BlockPool();
+
+    // Blocks are cache line aligned, so blocks that are used by different threads never share a cache line.
+    static constexpr size_t BLOCK_ALIGNMENT = 64u;
+
+    // Size of a huge page on x64.
+    static constexpr size_t DEFAULT_PAGE_SIZE = 2u * 1024u * 1024u;
+
+    // The contents of the returned block are undefined.
+    void *allocate();
+    void deallocate(void *const block);
+
+    struct Statistics
+    {
+        // Number of blocks handed out, and the number of those that required a new page.
+        u64 m_number_of_allocations{};
+        u64 m_number_of_page_allocations{};
+
+        u64 m_number_of_blocks_in_use{};
+        u64 m_peak_number_of_blocks_in_use{};
+
+        size_t m_reserved_size_in_bytes{};
+
+        Statistics &operator+=(const Statistics &other);
+    };
+
+    Statistics get_statistics() const;
+
+    size_t m_block_size{};
+    size_t m_page_size{};
+
+    // Freed blocks form an intrusive linked list : the first bytes of a free block point to the next free block.
+    void *m_free_list{};
+
+    // Blocks of the most recently allocated page that have never been handed out.
+    u8 *m_page_cursor{};
+    u8 *m_page_end{};
+
+    std::vector<void *> m_pages{};
+
+    Statistics m_statistics{};
+
+    mutable std::mutex m_mutex{};
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include "voxel-engine/chunk.hpp"
+#include "voxel-engine/timer.hpp"
+
+// Cave culling : visibility propagation through the empty space of chunks.
+// For each chunk, the faces (sides) of the chunk that are connected to each other through empty voxels are computed
+// once, when the chunk is meshed. Each frame, a breadth first search from the chunk the camera is in walks from chunk
+// to chunk, only leaving a chunk through a face that is connected to the face it was entered through. Chunks that are
+// never reached cannot be seen from the camera, whatever the view direction : e.g the chunks of a cave system that is
+// not connected to the surface, or the surface seen from inside of a closed cave.
+// The naming convention of namespaces is being broken here, mostly because this "namespace" is a smart way of
+// simulating static class behaviour.
+namespace CaveCulling
+{
+static constexpr u8 ALL_FACES_MASK = static_cast<u8>((1u << NUMBER_OF_FACE_DIRECTIONS) - 1u);
+
+// Bit j of m_connected_faces_masks[i] is set if a path of empty voxels leads from face i to face j of the chunk (in
+// FaceDirection order). A face is connected to itself if any of its voxels is empty.
+struct FaceConnectivity
+{
+    inline bool are_faces_connected(const FaceDirection a, const FaceDirection b) const
+    {
+        return (m_connected_faces_masks[static_cast<u32>(a)] >> static_cast<u32>(b)) & 1u;
+    }
+
+    // Connectivity of an empty chunk. Also used for chunks whose voxels are not known (e.g chunks that are not loaded),
+    // as it never hides anything.
+    static constexpr FaceConnectivity all_connected()
+    {
+        FaceConnectivity face_connectivity{};
+        face_connectivity.m_connected_faces_masks.fill(ALL_FACES_MASK);
+
+        return face_connectivity;
+    }
+
+    bool operator==(const FaceConnectivity &other) const = default;
+
+    std::array<u8, NUMBER_OF_FACE_DIRECTIONS> m_connected_faces_masks{};
+};
+
+// Flood fills the empty voxels of the chunk, starting from the voxels on its border. Explicitly instantiated (in
+// cave_culling.cpp) for the same chunk dimensions as BasicChunk.
+template <u32 N>
+FaceConnectivity compute_face_connectivity(const BasicChunk<N> &chunk);
+
+// Chunks that can be seen from the chunk the camera is in, within a cube of chunks around it.
+// The search is a breadth first search over the chunks of the cube :
+// (i) From the camera chunk, the search may go in any direction.
+// (ii) From any other chunk, it may only go through the faces that are connected to a face it entered the chunk
+// through, and never towards the camera : a line of sight goes through chunks in a monotonic order along each axis.
+// As every step moves one chunk further away from the camera (in Manhattan distance), all of the faces a chunk is
+// entered through are known by the time it is dequeued, so each chunk is only expanded once.
+struct PotentiallyVisibleSet
+{
+    // Face connectivity is looked up with get_face_connectivity(chunk_index), which should return
+    // FaceConnectivity::all_connected() for the chunks whose voxels are not known.
+    template <u32 NUMBER_OF_CHUNKS_PER_DIMENSION, typename GetFaceConnectivity>
+    void update(const DirectX::XMINT3 camera_chunk_index_3d, const u32 radius,
+                GetFaceConnectivity &&get_face_connectivity);
+
+    // Chunks outside of the cube (or before the first update) are considered to be visible.
+    bool contains(const DirectX::XMUINT3 chunk_index_3d) const;
+
+    // Index of the chunk in the cube, or std::nullopt if it is outside of it.
+    std::optional<size_t> get_cube_index(const DirectX::XMINT3 chunk_index_3d) const;
+
+    DirectX::XMINT3 m_camera_chunk_index_3d{};
+    u32 m_radius{};
+    bool m_is_valid{};
+
+    // Indexed by cube index. Bit i is set if the chunk has been entered through face i, and the camera chunk counts as
+    // entered through every face. Chunks that have not been entered are not visible.
+    std::vector<u8> m_entered_faces_masks{};
+
+    // Chunks to expand, as their position in the cube packed into the bytes of a u32 (x, y and z, lowest byte first),
+    // so that the position does not have to be recovered from the cube index with divisions.
+    std::vector<u32> m_search_queue{};
+
+    static constexpr u32 MAX_RADIUS = 127u;
+
+    size_t m_number_of_visible_chunks{};
+    float m_search_time_us{};
+};
+
+template <u32 NUMBER_OF_CHUNKS_PER_DIMENSION, typename GetFaceConnectivity>
+void PotentiallyVisibleSet::update(const DirectX::XMINT3 camera_chunk_index_3d, const u32 radius,
+                                   GetFaceConnectivity &&get_face_connectivity)
+{
+    Timer search_timer{};
+    search_timer.start();
+
+    m_camera_chunk_index_3d = camera_chunk_index_3d;
+    m_is_valid = true;
+
+    // Positions in the cube must fit in a byte (see m_search_queue).
+    m_radius = std::min(radius, MAX_RADIUS);
+
+    const u32 cube_length = 2u * m_radius + 1u;
+    const size_t number_of_cube_chunks = static_cast<size_t>(cube_length) * cube_length * cube_length;
+
+    // Offset between the cube indices (and packed positions) of neighboring chunks, in FaceDirection order.
+    const std::array<i32, NUMBER_OF_FACE_DIRECTIONS> cube_index_offsets = {
+        -static_cast<i32>(cube_length * cube_length),
+        static_cast<i32>(cube_length * cube_length),
+        -1,
+        1,
+        static_cast<i32>(cube_length),
+        -static_cast<i32>(cube_length),
+    };
+    static constexpr std::array<i32, NUMBER_OF_FACE_DIRECTIONS> packed_cube_index_3d_offsets = {
+        -(1 << 16), 1 << 16, -1, 1, 1 << 8, -(1 << 8),
+    };
+
+    m_entered_faces_masks.assign(number_of_cube_chunks, 0u);
+    m_search_queue.clear();
+    m_search_queue.reserve(number_of_cube_chunks);
+
+    const u32 camera_cube_index = static_cast<u32>(*get_cube_index(camera_chunk_index_3d));
+    m_entered_faces_masks[camera_cube_index] = ALL_FACES_MASK;
+    m_search_queue.push_back(m_radius | (m_radius << 8u) | (m_radius << 16u));
+
+    // The queue is only appended to, so it doubles as the list of visible chunks.
+    for (size_t node_index = 0u; node_index < m_search_queue.size(); node_index++)
+    {
+        const u32 packed_cube_index_3d = m_search_queue[node_index];
+        const DirectX::XMUINT3 cube_index_3d = {
+            packed_cube_index_3d & 0xFFu,
+            (packed_cube_index_3d >> 8u) & 0xFFu,
+            packed_cube_index_3d >> 16u,
+        };
+        const u32 cube_index = cube_index_3d.x + (cube_index_3d.y + cube_index_3d.z * cube_length) * cube_length;
+
+        const DirectX::XMINT3 chunk_index_3d = {
+            camera_chunk_index_3d.x + static_cast<i32>(cube_index_3d.x) - static_cast<i32>(m_radius),
+            camera_chunk_index_3d.y + static_cast<i32>(cube_index_3d.y) - static_cast<i32>(m_radius),
+            camera_chunk_index_3d.z + static_cast<i32>(cube_index_3d.z) - static_cast<i32>(m_radius),
+        };
+
+        // The search never goes towards the camera, nor out of the cube or the world.
+        const auto get_bit = [](const bool is_allowed, const FaceDirection face_direction) {
+            return static_cast<u8>(static_cast<u8>(is_allowed) << static_cast<u8>(face_direction));
+        };
+
+        const i32 last_chunk_index = static_cast<i32>(NUMBER_OF_CHUNKS_PER_DIMENSION) - 1;
+        u8 exit_faces_mask =
+            get_bit(cube_index_3d.z <= m_radius && cube_index_3d.z > 0u && chunk_index_3d.z > 0, FaceDirection::Front) |
+            get_bit(cube_index_3d.z >= m_radius && cube_index_3d.z < cube_length - 1u &&
+                        chunk_index_3d.z < last_chunk_index,
+                    FaceDirection::Back) |
+            get_bit(cube_index_3d.x <= m_radius && cube_index_3d.x > 0u && chunk_index_3d.x > 0, FaceDirection::Left) |
+            get_bit(cube_index_3d.x >= m_radius && cube_index_3d.x < cube_length - 1u &&
+                        chunk_index_3d.x < last_chunk_index,
+                    FaceDirection::Right) |
+            get_bit(cube_index_3d.y >= m_radius && cube_index_3d.y < cube_length - 1u &&
+                        chunk_index_3d.y < last_chunk_index,
+                    FaceDirection::Top) |
+            get_bit(cube_index_3d.y <= m_radius && cube_index_3d.y > 0u && chunk_index_3d.y > 0, FaceDirection::Bottom);
+
+        if (cube_index != camera_cube_index)
+        {
+            const FaceConnectivity face_connectivity =
+                get_face_connectivity(convert_to_1d<NUMBER_OF_CHUNKS_PER_DIMENSION>({
+                    static_cast<u32>(chunk_index_3d.x),
+                    static_cast<u32>(chunk_index_3d.y),
+                    static_cast<u32>(chunk_index_3d.z),
+                }));
+
+            u8 connected_faces_mask = 0u;
+            for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+            {
+                if ((m_entered_faces_masks[cube_index] >> face) & 1u)
+                {
+                    connected_faces_mask |= face_connectivity.m_connected_faces_masks[face];
+                }
+            }
+
+            exit_faces_mask &= connected_faces_mask;
+        }
+
+        for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+        {
+            if (!((exit_faces_mask >> face) & 1u))
+            {
+                continue;
+            }
+
+            // The neighbor is entered through the face opposite to the direction the search went in.
+            const u32 neighbor_cube_index = static_cast<u32>(static_cast<i32>(cube_index) + cube_index_offsets[face]);
+            const u8 entry_face_bit =
+                static_cast<u8>(1u << static_cast<u32>(get_opposite_face_direction(static_cast<FaceDirection>(face))));
+
+            u8 &entered_faces_mask = m_entered_faces_masks[neighbor_cube_index];
+            if (entered_faces_mask == 0u)
+            {
+                m_search_queue.push_back(
+                    static_cast<u32>(static_cast<i32>(packed_cube_index_3d) + packed_cube_index_3d_offsets[face]));
+            }
+            entered_faces_mask |= entry_face_bit;
+        }
+    }
+
+    m_number_of_visible_chunks = m_search_queue.size();
+
+    search_timer.stop();
+    m_search_time_us = search_timer.get_delta_time() * 1000000.0f;
+}
+} // namespace CaveCulling
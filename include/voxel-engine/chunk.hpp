@@ -0,0 +1,326 @@
+#pragma once
+
+#include "voxel-engine/block_pool.hpp"
+
+// A voxel is just a value on a regular 3D grid. Think of it as the corners where the cells meet in a 3d grid.
+// For 3d visualization of voxels, A cube is rendered for each voxel where the front lower left corner is the 'voxel
+// position' and has a edge length as specified in the class below.
+// Voxels are not stored individually : a chunk stores a single occupancy bit per voxel (see Chunk).
+struct Voxel
+{
+    static constexpr u32 EDGE_LENGTH{640 * 8u};
+};
+
+// Material of a voxel. Air is never stored : a voxel that is not active is air.
+enum class BlockType : u8
+{
+    Air,
+    Stone,
+    Dirt,
+    Grass,
+    Sand,
+    Snow,
+};
+
+static constexpr u32 NUMBER_OF_BLOCK_TYPES = 6u;
+
+// Indexed by block type. Each emitted face has the color of the voxel it belongs to.
+static constexpr std::array<DirectX::XMFLOAT3, NUMBER_OF_BLOCK_TYPES> BLOCK_TYPE_COLORS = {
+    DirectX::XMFLOAT3{0.0f, 0.0f, 0.0f},
+    DirectX::XMFLOAT3{0.5f, 0.5f, 0.52f},
+    DirectX::XMFLOAT3{0.45f, 0.3f, 0.18f},
+    DirectX::XMFLOAT3{0.3f, 0.6f, 0.2f},
+    DirectX::XMFLOAT3{0.85f, 0.8f, 0.55f},
+    DirectX::XMFLOAT3{0.95f, 0.95f, 0.97f},
+};
+
+// Smallest unsigned integer type that can hold one bit for each voxel in a row of N voxels.
+template <u32 N>
+using occupancy_row_t =
+    std::conditional_t<N <= 8u, u8, std::conditional_t<N <= 16u, u16, std::conditional_t<N <= 32u, u32, u64>>>;
+
+// Directions of the 6 faces of a voxel (or chunk). The meshers emit faces grouped by direction, in this order.
+enum class FaceDirection : u8
+{
+    Front,
+    Back,
+    Left,
+    Right,
+    Top,
+    Bottom,
+};
+
+static constexpr u32 NUMBER_OF_FACE_DIRECTIONS = 6u;
+
+// Offset to the neighboring voxel (or chunk) in each face direction.
+static constexpr std::array<DirectX::XMINT3, NUMBER_OF_FACE_DIRECTIONS> FACE_DIRECTION_OFFSETS = {
+    DirectX::XMINT3{0, 0, -1},
+    DirectX::XMINT3{0, 0, 1},
+    DirectX::XMINT3{-1, 0, 0},
+    DirectX::XMINT3{1, 0, 0},
+    DirectX::XMINT3{0, 1, 0},
+    DirectX::XMINT3{0, -1, 0},
+};
+
+static inline FaceDirection get_opposite_face_direction(const FaceDirection face_direction)
+{
+    // Faces are ordered in pairs, so the opposite face only differs in the lowest bit.
+    return static_cast<FaceDirection>(static_cast<u8>(face_direction) ^ 1u);
+}
+
+// Mask of the face directions (bit i for FaceDirection i) in which the faces inside of an axis aligned box (e.g a
+// chunk) may face the camera. Faces that point away from the camera are back faces : e.g no left (-x) face of the box
+// can be seen from a camera at or beyond the maximum x of the box, whatever the position of the face in the box.
+// The camera position is relative to the minimum corner of the box. Mirrored by gpu_culling_shader.hlsl.
+static inline u8 get_visible_face_directions_mask(const DirectX::XMFLOAT3 camera_position, const float edge_length)
+{
+    const auto get_bit = [](const bool is_visible, const FaceDirection face_direction) {
+        return static_cast<u8>(static_cast<u8>(is_visible) << static_cast<u8>(face_direction));
+    };
+
+    return get_bit(camera_position.z < edge_length, FaceDirection::Front) |
+           get_bit(camera_position.z > 0.0f, FaceDirection::Back) |
+           get_bit(camera_position.x < edge_length, FaceDirection::Left) |
+           get_bit(camera_position.x > 0.0f, FaceDirection::Right) |
+           get_bit(camera_position.y > 0.0f, FaceDirection::Top) |
+           get_bit(camera_position.y < edge_length, FaceDirection::Bottom);
+}
+
+// Chunks that are entirely empty (air) or entirely full (solid, usually buried) are very common. Such uniform chunks do
+// not own any voxel data.
+enum class OccupancyState : u8
+{
+    Empty,
+    Full,
+    Mixed,
+};
+
+static constexpr u32 NUMBER_OF_OCCUPANCY_STATES = 3u;
+
+// A chunk is a cube of N x N x N voxels. N is a template parameter, so that the indexing math is resolved at compile
+// time and different chunk sizes can be compared (draw count vs re-mesh cost). The engine itself uses a single size,
+// see Chunk below. The member functions are explicitly instantiated (in chunk.cpp) for N = 8, 16, 32 and 64.
+template <u32 N>
+struct BasicChunk
+{
+    static_assert(std::has_single_bit(N) && N >= 8u && N <= 64u,
+                  "Chunk dimension must be a power of two in the range [8, 64].");
+
+    explicit BasicChunk();
+
+    BasicChunk(const BasicChunk &other) = delete;
+    BasicChunk &operator=(BasicChunk &other) = delete;
+
+    BasicChunk(BasicChunk &&other) noexcept;
+    BasicChunk &operator=(BasicChunk &&other) noexcept;
+
+    ~BasicChunk();
+
+    static constexpr u32 NUMBER_OF_VOXELS_PER_DIMENSION = N;
+    static constexpr size_t NUMBER_OF_VOXELS =
+        NUMBER_OF_VOXELS_PER_DIMENSION * NUMBER_OF_VOXELS_PER_DIMENSION * NUMBER_OF_VOXELS_PER_DIMENSION;
+
+    static constexpr u32 CHUNK_LENGTH = Voxel::EDGE_LENGTH * NUMBER_OF_VOXELS_PER_DIMENSION;
+
+    // Voxel occupancy is bit packed. Each row of voxels along the x axis is a single unsigned integer, where bit x is
+    // set if voxel (x, y, z) is active. Rows are laid out in the same order as convert_to_1d, i.e row (y, z) is at
+    // index y + z * N. A slab is the set of N rows that share the same z.
+    using OccupancyRow = occupancy_row_t<NUMBER_OF_VOXELS_PER_DIMENSION>;
+
+    static constexpr size_t NUMBER_OF_ROWS = NUMBER_OF_VOXELS_PER_DIMENSION * NUMBER_OF_VOXELS_PER_DIMENSION;
+
+    static constexpr u64 FULL_ROW_MASK =
+        NUMBER_OF_VOXELS_PER_DIMENSION == 64u ? ~0ull : (1ull << NUMBER_OF_VOXELS_PER_DIMENSION) - 1ull;
+
+    // Single voxel accessors.
+    inline bool is_voxel_active(const DirectX::XMUINT3 index_3d) const
+    {
+        return (get_row(index_3d.y, index_3d.z) >> index_3d.x) & 1ull;
+    }
+
+    inline void set_voxel_active(const DirectX::XMUINT3 index_3d, const bool active)
+    {
+        if (m_occupancy_state != OccupancyState::Mixed)
+        {
+            make_mixed();
+        }
+
+        OccupancyRow &row = m_occupancy[index_3d.y + index_3d.z * NUMBER_OF_VOXELS_PER_DIMENSION];
+        const OccupancyRow bit = static_cast<OccupancyRow>(1ull << index_3d.x);
+
+        row = active ? (row | bit) : (row & ~bit);
+    }
+
+    // Row accessors. Rows are returned as u64 so that callers can test upto 64 voxels at once, irrespective of the
+    // chunk dimension.
+    inline u64 get_row(const u32 y, const u32 z) const
+    {
+        return m_occupancy[y + z * NUMBER_OF_VOXELS_PER_DIMENSION];
+    }
+
+    inline void set_row(const u32 y, const u32 z, const u64 row)
+    {
+        if (m_occupancy_state != OccupancyState::Mixed)
+        {
+            make_mixed();
+        }
+
+        m_occupancy[y + z * NUMBER_OF_VOXELS_PER_DIMENSION] = static_cast<OccupancyRow>(row & FULL_ROW_MASK);
+    }
+
+    inline bool is_row_empty(const u32 y, const u32 z) const
+    {
+        return get_row(y, z) == 0ull;
+    }
+
+    inline bool is_row_full(const u32 y, const u32 z) const
+    {
+        return get_row(y, z) == FULL_ROW_MASK;
+    }
+
+    // Slab accessors. The slab is returned as a span of N contiguous rows.
+    inline std::span<const OccupancyRow, NUMBER_OF_VOXELS_PER_DIMENSION> get_slab(const u32 z) const
+    {
+        return std::span<const OccupancyRow, NUMBER_OF_VOXELS_PER_DIMENSION>(
+            m_occupancy + z * NUMBER_OF_VOXELS_PER_DIMENSION, NUMBER_OF_VOXELS_PER_DIMENSION);
+    }
+
+    bool is_slab_empty(const u32 z) const;
+    bool is_slab_full(const u32 z) const;
+
+    // For uniform chunks, these do not have to look at the voxel data.
+    bool is_empty() const;
+    bool is_full() const;
+
+    inline bool is_uniform() const
+    {
+        return m_occupancy_state != OccupancyState::Mixed;
+    }
+
+    // Makes the chunk uniform, releasing its voxel data (if any). Full chunks get a single block type.
+    void set_uniform(const OccupancyState occupancy_state, const BlockType block_type = DEFAULT_BLOCK_TYPE);
+
+    // Only changes the occupancy, the block types are kept.
+    void set_uniform_occupancy(const OccupancyState occupancy_state);
+
+    // Gives a uniform chunk its own voxel data (with the same contents). Done automatically by the setters.
+    void make_mixed();
+
+    // If a mixed chunk turns out to be empty or full, it is made uniform. Called once the voxel data is generated.
+    void update_occupancy_state();
+
+    // Block types are palette compressed : each chunk has a palette of the distinct block types of its active voxels,
+    // and stores a palette index per voxel, packed into 64 bit words (in the same order as convert_to_1d). The number
+    // of bits per index is the smallest of 0, 1, 2, 4 and 8 that can index the entire palette, so a chunk with a single
+    // block type stores no indices at all. When the palette outgrows the current index size, the indices are repacked.
+    // The block type of inactive voxels is ignored (it is air). Until a block type is set, active voxels are
+    // DEFAULT_BLOCK_TYPE.
+    // The palette is stored inline, as it can have at most one entry per block type.
+    static constexpr BlockType DEFAULT_BLOCK_TYPE = BlockType::Stone;
+
+    static constexpr u32 MAX_PALETTE_SIZE = NUMBER_OF_BLOCK_TYPES;
+
+    // Index sizes (in bits) that are used for palette indices, and the number of bytes required for each.
+    static constexpr std::array<u32, 4> PALETTE_INDEX_SIZES = {1u, 2u, 4u, 8u};
+
+    static constexpr size_t get_palette_indices_size_in_bytes(const u32 bits_per_palette_index)
+    {
+        return (NUMBER_OF_VOXELS * bits_per_palette_index + 63u) / 64u * sizeof(u64);
+    }
+
+    inline u32 get_palette_index(const DirectX::XMUINT3 index_3d) const
+    {
+        if (m_bits_per_palette_index == 0u)
+        {
+            return 0u;
+        }
+
+        const size_t bit_index = convert_to_1d<N>(index_3d) * m_bits_per_palette_index;
+        const u64 index_mask = (1ull << m_bits_per_palette_index) - 1ull;
+
+        return static_cast<u32>((m_palette_indices[bit_index / 64u] >> (bit_index % 64u)) & index_mask);
+    }
+
+    inline BlockType get_block_type(const DirectX::XMUINT3 index_3d) const
+    {
+        if (!is_voxel_active(index_3d))
+        {
+            return BlockType::Air;
+        }
+
+        return m_palette_size == 0u ? DEFAULT_BLOCK_TYPE : m_palette[get_palette_index(index_3d)];
+    }
+
+    // Setting a block type also makes the voxel active (or inactive, for air).
+    void set_block_type(const DirectX::XMUINT3 index_3d, const BlockType block_type);
+
+    // Returns the one voxel thick layer of this chunk on the side given by face direction, in the layout described in
+    // ChunkNeighborApron.
+    std::array<u64, N> get_boundary_slab(const FaceDirection face_direction) const;
+
+    // Chunks cannot be copied implicitly, as it is expensive. Use this function when a copy is really required.
+    BasicChunk clone() const;
+
+    // Number of bytes used to store the voxel data of this chunk.
+    static constexpr size_t OCCUPANCY_SIZE_IN_BYTES = sizeof(OccupancyRow) * NUMBER_OF_ROWS;
+
+    // Occupancy (if not uniform) and block type storage owned by this chunk.
+    size_t get_voxel_data_size_in_bytes() const;
+
+    // The occupancy of mixed chunks and the palette indices are allocated from block pools (one per chunk dimension and
+    // allocation size) rather than the heap, as chunks are created and destroyed all the time while streaming.
+    static BlockPool &get_occupancy_pool();
+    static BlockPool &get_palette_indices_pool(const u32 bits_per_palette_index);
+
+    // Combined statistics of all voxel data pools of this chunk dimension.
+    static BlockPool::Statistics get_voxel_data_pool_statistics();
+
+    // A flattened 2d array of occupancy rows. For uniform chunks, this points to read only storage shared by all chunks
+    // with the same occupancy state, so the accessors do not have to special case them.
+    OccupancyRow *m_occupancy{};
+    OccupancyState m_occupancy_state{OccupancyState::Empty};
+
+    std::array<BlockType, MAX_PALETTE_SIZE> m_palette{};
+    u32 m_palette_size{};
+
+    // Null if the bits per palette index is 0.
+    u64 *m_palette_indices{};
+    u32 m_bits_per_palette_index{};
+
+    size_t m_chunk_index{};
+
+    // Bit i is set if the neighbor in face direction i was available when this chunk was last meshed. If a neighbor
+    // that was not available is loaded later, faces on that border may have to be re-resolved.
+    u8 m_meshed_neighbors_mask{};
+};
+
+// The one voxel thick layers of the 6 neighboring chunks that touch a chunk. Used while meshing, so that faces on the
+// chunk border that are hidden by a voxel in the neighboring chunk are not emitted.
+// The layout of each slab matches the face masks of the binary greedy mesher :
+// (i) Left / Right : row = z, bits along y.
+// (ii) Top / Bottom : row = z, bits along x.
+// (iii) Front / Back : row = y, bits along x.
+// If a neighbor is not available, its slab is empty, so the faces towards it are emitted.
+template <u32 N>
+struct BasicChunkNeighborApron
+{
+    inline bool is_voxel_active(const FaceDirection face_direction, const u32 row, const u32 bit) const
+    {
+        return (m_slabs[static_cast<u32>(face_direction)][row] >> bit) & 1ull;
+    }
+
+    std::array<std::array<u64, N>, NUMBER_OF_FACE_DIRECTIONS> m_slabs{};
+
+    // Bit i is set if the neighbor in face direction i was available when the apron was captured.
+    u8 m_available_neighbors_mask{};
+};
+
+// Chunk dimension used by the engine. Set with the VX_CHUNK_DIMENSION CMake option (see src/CMakeLists.txt).
+#ifndef VX_CHUNK_DIMENSION
+#define VX_CHUNK_DIMENSION 8
+#endif
+
+static constexpr u32 CHUNK_DIMENSION = VX_CHUNK_DIMENSION;
+
+using Chunk = BasicChunk<CHUNK_DIMENSION>;
+using ChunkNeighborApron = BasicChunkNeighborApron<CHUNK_DIMENSION>;
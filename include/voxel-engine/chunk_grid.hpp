@@ -0,0 +1,159 @@
+#pragma once
+
+#include "voxel-engine/chunk.hpp"
+
+// A toroidal (ring buffer) 3D grid of slots around the player, i.e a clipmap.
+// The chunk at chunk index (x, y, z) can only live in slot (x % S, y % S, z % S), where S is the number of slots per
+// dimension, so a lookup is a modulo and a compare rather than a hash. Chunks that are less than S chunks apart along
+// every axis never map to the same slot : as the player moves, the slots of the chunks that are left behind are reused
+// by the chunks ahead.
+// The world grid (of NUMBER_OF_CHUNKS_PER_DIMENSION chunks per dimension) is what chunk indices are relative to.
+template <typename T, u32 NUMBER_OF_SLOTS_PER_DIMENSION, u32 NUMBER_OF_CHUNKS_PER_DIMENSION>
+struct ChunkGrid
+{
+    static constexpr size_t EMPTY_SLOT = std::numeric_limits<size_t>::max();
+
+    static constexpr size_t NUMBER_OF_SLOTS =
+        NUMBER_OF_SLOTS_PER_DIMENSION * NUMBER_OF_SLOTS_PER_DIMENSION * NUMBER_OF_SLOTS_PER_DIMENSION;
+
+    struct Slot
+    {
+        // Index of the chunk that lives in this slot, or EMPTY_SLOT.
+        size_t m_chunk_index{EMPTY_SLOT};
+        T m_value{};
+    };
+
+    ChunkGrid() : m_slots(NUMBER_OF_SLOTS)
+    {
+    }
+
+    static inline DirectX::XMUINT3 get_slot_index_3d(const DirectX::XMUINT3 chunk_index_3d)
+    {
+        return {
+            chunk_index_3d.x % NUMBER_OF_SLOTS_PER_DIMENSION,
+            chunk_index_3d.y % NUMBER_OF_SLOTS_PER_DIMENSION,
+            chunk_index_3d.z % NUMBER_OF_SLOTS_PER_DIMENSION,
+        };
+    }
+
+    static inline size_t get_slot_index(const DirectX::XMUINT3 slot_index_3d)
+    {
+        return slot_index_3d.x + slot_index_3d.y * NUMBER_OF_SLOTS_PER_DIMENSION +
+               static_cast<size_t>(slot_index_3d.z) * NUMBER_OF_SLOTS_PER_DIMENSION * NUMBER_OF_SLOTS_PER_DIMENSION;
+    }
+
+    // The slot the chunk maps to, whichever chunk (if any) lives in it.
+    Slot &get_slot(const size_t chunk_index)
+    {
+        return m_slots[get_slot_index(get_slot_index_3d(convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index)))];
+    }
+
+    const Slot &get_slot(const size_t chunk_index) const
+    {
+        return m_slots[get_slot_index(get_slot_index_3d(convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index)))];
+    }
+
+    // Returns nullptr if the chunk is not in the grid.
+    T *find(const size_t chunk_index)
+    {
+        Slot &slot = get_slot(chunk_index);
+        return slot.m_chunk_index == chunk_index ? &slot.m_value : nullptr;
+    }
+
+    const T *find(const size_t chunk_index) const
+    {
+        const Slot &slot = get_slot(chunk_index);
+        return slot.m_chunk_index == chunk_index ? &slot.m_value : nullptr;
+    }
+
+    bool contains(const size_t chunk_index) const
+    {
+        return get_slot(chunk_index).m_chunk_index == chunk_index;
+    }
+
+    // Returns the neighbor of the chunk in the given direction, or nullptr if it is not in the grid (or outside of the
+    // world). The neighboring slot is one stride away from the slot of the chunk, wrapping around at the grid border.
+    const T *find_neighbor(const size_t chunk_index, const FaceDirection face_direction) const
+    {
+        const DirectX::XMUINT3 chunk_index_3d = convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+        const DirectX::XMINT3 offset = FACE_DIRECTION_OFFSETS[static_cast<u32>(face_direction)];
+
+        const DirectX::XMUINT3 neighbor_index_3d = {
+            chunk_index_3d.x + offset.x,
+            chunk_index_3d.y + offset.y,
+            chunk_index_3d.z + offset.z,
+        };
+
+        // Going below zero wraps around to a very large value, so a single comparison per axis is enough.
+        if (neighbor_index_3d.x >= NUMBER_OF_CHUNKS_PER_DIMENSION ||
+            neighbor_index_3d.y >= NUMBER_OF_CHUNKS_PER_DIMENSION ||
+            neighbor_index_3d.z >= NUMBER_OF_CHUNKS_PER_DIMENSION)
+        {
+            return nullptr;
+        }
+
+        const DirectX::XMUINT3 slot_index_3d = get_slot_index_3d(chunk_index_3d);
+        const DirectX::XMUINT3 neighbor_slot_index_3d = {
+            (slot_index_3d.x + NUMBER_OF_SLOTS_PER_DIMENSION + offset.x) % NUMBER_OF_SLOTS_PER_DIMENSION,
+            (slot_index_3d.y + NUMBER_OF_SLOTS_PER_DIMENSION + offset.y) % NUMBER_OF_SLOTS_PER_DIMENSION,
+            (slot_index_3d.z + NUMBER_OF_SLOTS_PER_DIMENSION + offset.z) % NUMBER_OF_SLOTS_PER_DIMENSION,
+        };
+
+        const Slot &neighbor_slot = m_slots[get_slot_index(neighbor_slot_index_3d)];
+        return neighbor_slot.m_chunk_index == convert_to_1d<NUMBER_OF_CHUNKS_PER_DIMENSION>(neighbor_index_3d)
+                   ? &neighbor_slot.m_value
+                   : nullptr;
+    }
+
+    T *find_neighbor(const size_t chunk_index, const FaceDirection face_direction)
+    {
+        return const_cast<T *>(static_cast<const ChunkGrid &>(*this).find_neighbor(chunk_index, face_direction));
+    }
+
+    // The slot of the chunk must be empty (see get_slot) : the chunk that lives in it has to be erased first.
+    T &insert(const size_t chunk_index)
+    {
+        Slot &slot = get_slot(chunk_index);
+
+        slot.m_chunk_index = chunk_index;
+        ++m_size;
+
+        return slot.m_value;
+    }
+
+    // The value is reset, which releases whatever it owns.
+    void erase(const size_t chunk_index)
+    {
+        Slot &slot = get_slot(chunk_index);
+        if (slot.m_chunk_index != chunk_index)
+        {
+            return;
+        }
+
+        slot.m_chunk_index = EMPTY_SLOT;
+        slot.m_value = T{};
+        --m_size;
+    }
+
+    // Number of chunks in the grid.
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    // Function is called with the chunk index and value of each chunk in the grid, in slot order.
+    template <typename Function>
+    void for_each(Function &&function) const
+    {
+        for (const Slot &slot : m_slots)
+        {
+            if (slot.m_chunk_index != EMPTY_SLOT)
+            {
+                function(slot.m_chunk_index, slot.m_value);
+            }
+        }
+    }
+
+    std::vector<Slot> m_slots{};
+    size_t m_size{};
+};
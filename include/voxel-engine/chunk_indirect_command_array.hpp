@@ -0,0 +1,127 @@
+#pragma once
+
+#include "voxel-engine/gpu_backend.hpp"
+
+// Indirect command of a chunk (or of a run of chunks of a region, see ChunkRegions) : the render resources root
+// constants, the index buffer view and the draw arguments. The layout matches GPUIndirectCommand (see
+// render_resources.hlsli) and the command signature of the renderer.
+// The scene constant buffer index is the same for all chunks, and is filled in by the culling shader. So is the first
+// face index of chunk commands, as the culling shader splits them into one draw per range of visible face directions.
+struct ChunkIndirectCommand
+{
+    u32 scene_constant_buffer_index{};
+    u32 region_constant_buffer_index{};
+    u32 first_face_index{};
+
+    // Slot of the chunk in its region, or ChunkRegions::NUMBER_OF_CHUNKS_PER_REGION for region commands.
+    u32 region_chunk_slot{};
+
+    IndexBufferView index_buffer_view{};
+
+    // Same layout as D3D12_DRAW_INDEXED_ARGUMENTS.
+    u32 index_count_per_instance{};
+    u32 instance_count{1u};
+    u32 start_index_location{};
+    i32 base_vertex_location{};
+    u32 start_instance_location{};
+
+    u32 padding{};
+
+    // The run of loaded chunk meshes of a page that a region command draws (see ChunkRegions).
+    struct RegionRun
+    {
+        u32 page_index;
+        u32 first_loaded_chunk_mesh;
+        u32 number_of_loaded_chunk_meshes;
+
+        // List of loaded chunk meshes of the page that the run is in.
+        u32 loaded_chunk_mesh_list;
+    };
+
+    // Only read by the culling shader, which is why they come after the draw arguments. Chunk commands have the number
+    // of indices of each face direction of the chunk mesh, in face direction order, and region commands their run.
+    union {
+        std::array<u32, 6u> face_direction_index_counts{};
+        RegionRun region_run;
+    };
+};
+
+static_assert(sizeof(ChunkIndirectCommand) == 80u, "ChunkIndirectCommand must match the GPU indirect command layout");
+
+// A dense array of indirect commands (of the chunks that have a mesh, or of the runs of the regions), which is kept in
+// sync with the GPU copy rather than being rebuilt every frame.
+// Commands are appended when their owner (the chunk, or the region) is loaded, and swap-removed (the last command is
+// moved into the hole) when it is unloaded. The index of a command is its handle : the owner of the command that was
+// moved is returned by remove, so that its handle can be updated.
+// The commands that changed since the last upload are tracked, so that only they have to be uploaded.
+// The minimum corners of the bounds of the owners are kept alongside the commands, as a structure of arrays (see
+// FrustumCulling).
+struct ChunkIndirectCommandArray
+{
+    static constexpr u32 INVALID_HANDLE = std::numeric_limits<u32>::max();
+
+    // Returns the handle of the command. Owner is the index of the chunk (or the key of the region) of the command,
+    // and bounds min the minimum corner of its AABB, in world space.
+    u32 add(const size_t owner, const ChunkIndirectCommand &command, const DirectX::XMFLOAT3 bounds_min);
+
+    // Returns the owner whose command was moved into handle, if any.
+    std::optional<size_t> remove(const u32 handle);
+
+    // Overwrites the command of handle, which keeps its owner and bounds. It is only uploaded again if it changed.
+    void set(const u32 handle, const ChunkIndirectCommand &command);
+
+    // Function is called with the index of the first command, the number of commands and a pointer to them, for each
+    // range of consecutive commands that changed since the last call. Commands that were removed from the end of the
+    // array are not uploaded, as only the first size() commands are read by the GPU.
+    template <typename Function>
+    void upload_dirty_ranges(Function &&function)
+    {
+        std::sort(m_dirty_command_indices.begin(), m_dirty_command_indices.end());
+
+        size_t i = 0u;
+        while (i < m_dirty_command_indices.size() && m_dirty_command_indices[i] < m_commands.size())
+        {
+            const u32 first_command_index = m_dirty_command_indices[i];
+
+            u32 number_of_commands = 0u;
+            while (i < m_dirty_command_indices.size() &&
+                   m_dirty_command_indices[i] == first_command_index + number_of_commands &&
+                   m_dirty_command_indices[i] < m_commands.size())
+            {
+                ++number_of_commands;
+                ++i;
+            }
+
+            function(first_command_index, number_of_commands, &m_commands[first_command_index]);
+            m_number_of_uploaded_commands += number_of_commands;
+        }
+
+        for (const u32 command_index : m_dirty_command_indices)
+        {
+            m_is_command_dirty[command_index] = false;
+        }
+        m_dirty_command_indices.clear();
+    }
+
+    size_t size() const;
+
+    void mark_dirty(const u32 command_index);
+
+    // For when the uploaded commands were overwritten.
+    void mark_all_dirty();
+
+    std::vector<ChunkIndirectCommand> m_commands{};
+
+    // Owner of each command.
+    std::vector<size_t> m_owners{};
+
+    std::vector<float> m_bounds_min_x{};
+    std::vector<float> m_bounds_min_y{};
+    std::vector<float> m_bounds_min_z{};
+
+    // Each command is only in the dirty command indices once.
+    std::vector<u32> m_dirty_command_indices{};
+    std::vector<bool> m_is_command_dirty{};
+
+    u64 m_number_of_uploaded_commands{};
+};
@@ -0,0 +1,90 @@
+#pragma once
+
+// Decides the order in which chunks that are waiting to be setup are submitted.
+// Chunks are scored by their distance to the camera, and chunks that are in view (and in front of the camera) are
+// favored. As the camera moves, the pending chunks are re-scored, so the chunks that are submitted first are always the
+// ones that matter most for the current view.
+// The number of pending chunks is bounded : each time the view is set, the chunks with the lowest priority that do not
+// fit are dropped. Chunks that are still required will be added again once the camera gets closer to them.
+struct ChunkLoadScheduler
+{
+    // All positions and distances are in chunks (i.e world space divided by the chunk length).
+    struct View
+    {
+        DirectX::XMFLOAT3 m_position{};
+
+        // Must be normalized.
+        DirectX::XMFLOAT3 m_front{0.0f, 0.0f, 1.0f};
+
+        // Half angle of the cone that bounds the view frustum.
+        float m_cos_half_fov{};
+        float m_sin_half_fov{};
+
+        // The frustum cone is bounded by the vertical and horizontal field of view.
+        static View create(const DirectX::XMFLOAT3 position, const DirectX::XMFLOAT3 front, const float vertical_fov,
+                           const float aspect_ratio);
+    };
+
+    explicit ChunkLoadScheduler(const size_t max_number_of_pending_chunks);
+
+    void add(const size_t chunk_index, const DirectX::XMUINT3 chunk_index_3d);
+
+    // Returns the pending chunk with the highest priority.
+    std::optional<size_t> pop();
+
+    // Re-scores all pending chunks for the new view. If there are more pending chunks than the scheduler can hold, the
+    // ones with the lowest priority are dropped and returned.
+    std::vector<size_t> set_view(const View &view);
+
+    // Removes the pending chunks for which predicate (called with the chunk index) returns true, and returns them.
+    template <typename Predicate>
+    std::vector<size_t> remove_if(Predicate &&predicate)
+    {
+        const auto first_removed_chunk =
+            std::partition(m_pending_chunks.begin(), m_pending_chunks.end(),
+                           [&](const PendingChunk &pending_chunk) { return !predicate(pending_chunk.m_chunk_index); });
+
+        std::vector<size_t> removed_chunk_indices{};
+        for (auto pending_chunk = first_removed_chunk; pending_chunk != m_pending_chunks.end(); ++pending_chunk)
+        {
+            removed_chunk_indices.push_back(pending_chunk->m_chunk_index);
+        }
+
+        m_pending_chunks.erase(first_removed_chunk, m_pending_chunks.end());
+        std::make_heap(m_pending_chunks.begin(), m_pending_chunks.end(), has_higher_score);
+
+        return removed_chunk_indices;
+    }
+
+    size_t get_number_of_pending_chunks() const;
+
+    // A lower score means a higher priority.
+    float get_score(const DirectX::XMUINT3 chunk_index_3d) const;
+
+    // Chunks this close to the camera are prioritized by distance alone, as the camera can turn towards them at any
+    // time.
+    static constexpr float NEARBY_CHUNK_DISTANCE = 2.0f;
+
+    // Score multiplier for chunks that are not in view.
+    static constexpr float OUT_OF_VIEW_SCORE_MULTIPLIER = 4.0f;
+
+    struct PendingChunk
+    {
+        float m_score{};
+        size_t m_chunk_index{};
+        DirectX::XMUINT3 m_chunk_index_3d{};
+    };
+
+    // Heap comparator : the pending chunk with the lowest score is at the front of the heap.
+    static bool has_higher_score(const PendingChunk &a, const PendingChunk &b)
+    {
+        return a.m_score > b.m_score;
+    }
+
+    size_t m_max_number_of_pending_chunks{};
+
+    // Min heap on the score.
+    std::vector<PendingChunk> m_pending_chunks{};
+
+    View m_view{};
+};
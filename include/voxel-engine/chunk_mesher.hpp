@@ -0,0 +1,120 @@
+#pragma once
+
+#include "voxel-engine/chunk.hpp"
+
+// Algorithm used to convert the voxel data of a chunk into index and color data.
+enum class MeshingMode : u8
+{
+    Naive,
+    BinaryGreedy,
+};
+
+// The shared chunk position buffer has one vertex per voxel corner, i.e per lattice point of the chunk (see
+// ChunkManager), so 16 bit indices can address chunks of upto 39^3 voxels. Larger chunks use 32 bit indices.
+template <u32 N>
+static constexpr u32 NUMBER_OF_SHARED_VERTICES = (N + 1u) * (N + 1u) * (N + 1u);
+
+template <u32 N>
+using mesh_index_t = std::conditional_t<NUMBER_OF_SHARED_VERTICES<N> <= 65536u, u16, u32>;
+
+// Range of the indices of the faces of one direction in a chunk mesh.
+struct FaceDirectionIndexRange
+{
+    u32 m_first_index{};
+    u32 m_number_of_indices{};
+};
+
+using FaceDirectionIndexRanges = std::array<FaceDirectionIndexRange, NUMBER_OF_FACE_DIRECTIONS>;
+
+// Output of a meshing pass. The indices 'index' into the shared chunk position buffer (see ChunkManager), and there is
+// one color per emitted face (i.e per 2 triangles), which is the color of the block type of the face.
+// Faces are grouped by direction (in FaceDirection order), so that the faces of the directions that point away from
+// the camera can be skipped as a whole when drawing (see get_visible_face_directions_mask).
+template <u32 N>
+struct BasicChunkMesh
+{
+    using Index = mesh_index_t<N>;
+
+    std::vector<Index> m_indices{};
+    std::vector<DirectX::XMFLOAT3> m_colors{};
+
+    FaceDirectionIndexRanges m_face_direction_index_ranges{};
+
+    // All faces emitted from now on, until the next call, have the given direction.
+    inline void begin_face_direction(const FaceDirection face_direction)
+    {
+        m_face_direction_index_ranges[static_cast<u32>(face_direction)].m_first_index =
+            static_cast<u32>(m_indices.size());
+    }
+
+    inline void end_face_direction(const FaceDirection face_direction)
+    {
+        FaceDirectionIndexRange &index_range = m_face_direction_index_ranges[static_cast<u32>(face_direction)];
+        index_range.m_number_of_indices = static_cast<u32>(m_indices.size()) - index_range.m_first_index;
+    }
+
+    inline size_t get_triangle_count() const
+    {
+        return m_indices.size() / 3u;
+    }
+
+    inline size_t get_capacity_in_bytes() const
+    {
+        return m_indices.capacity() * sizeof(Index) + m_colors.capacity() * sizeof(DirectX::XMFLOAT3);
+    }
+
+    inline void clear()
+    {
+        m_indices.clear();
+        m_colors.clear();
+        m_face_direction_index_ranges = {};
+    }
+};
+
+using ChunkMesh = BasicChunkMesh<CHUNK_DIMENSION>;
+
+// Chunks further from the camera are meshed at a lower level of detail (see ChunkMesher::downsampled_greedy_mesh) : at
+// level l, the chunk is meshed as cells of 2^l voxels per dimension. Level 0 is the full resolution mesh.
+static constexpr u32 NUMBER_OF_CHUNK_LODS = 4u;
+static_assert((1u << (NUMBER_OF_CHUNK_LODS - 1u)) <= 8u,
+              "A cell of the lowest level of detail must fit in the smallest supported chunk dimension");
+
+// The naming convention of namespaces is being broken here, mostly because this "namespace" is a smart way of
+// simulating static class behaviour.
+namespace ChunkMesher
+{
+// Both meshers use the neighbor apron to decide if faces on the chunk border are covered.
+// All functions are explicitly instantiated (in chunk_mesher.cpp) for the same chunk dimensions as BasicChunk.
+
+// Returns false if the chunk cannot have any visible face : the chunk is uniformly empty, or it is uniformly full and
+// all of its neighbors are available and have a full boundary slab towards it.
+template <u32 N>
+bool is_mesh_required(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron);
+
+// For each active voxel, test all 6 neighbors and emit a face (6 indices) for each side that is not covered.
+template <u32 N>
+void naive_mesh(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron, BasicChunkMesh<N> &mesh);
+
+// Compute visible face masks for all 6 directions using shifts and ANDs over occupancy rows, then greedily merge the
+// coplanar faces of each slice (that have the same block type) into maximal quads.
+template <u32 N>
+void binary_greedy_mesh(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron, BasicChunkMesh<N> &mesh);
+
+// Binary greedy meshing over the chunk downsampled to cells of 2^lod voxels per dimension (lod must be less than
+// NUMBER_OF_CHUNK_LODS). A cell is active if any of its voxels is, and has the block type of its highest active voxel.
+// The vertices of the cells are voxel corners, so the mesh uses the same shared position buffer as the full resolution
+// mesh.
+template <u32 N>
+void downsampled_greedy_mesh(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron, const u32 lod,
+                             BasicChunkMesh<N> &mesh);
+
+// Each thread has its own (cleared) scratch mesh, which keeps its capacity from one chunk to the next. Meshing into it
+// rather than a new mesh avoids growing fresh vectors for every chunk : once the scratch mesh has grown to fit the
+// largest chunk mesh, meshing does not allocate.
+template <u32 N>
+BasicChunkMesh<N> &get_scratch_mesh();
+
+template <u32 N>
+void mesh(const MeshingMode meshing_mode, const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron,
+          BasicChunkMesh<N> &mesh);
+} // namespace ChunkMesher
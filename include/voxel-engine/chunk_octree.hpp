@@ -0,0 +1,189 @@
+#pragma once
+
+#include "voxel-engine/frustum_culling.hpp"
+
+// A sparse octree over the loaded chunks, so that per chunk queries (frustum culling, eviction, occluder gathering, ray
+// casts) visit whole groups of chunks at once rather than every loaded chunk.
+// A node at level l is a cube of 2^l chunks per dimension, aligned to the world chunk grid. Leaves (level 0) are
+// chunks, and the roots are at ROOT_LEVEL. Only the nodes that contain at least one chunk exist.
+// Each node aggregates the flags of the chunks below it (the flags any of them has, and the flags all of them have),
+// how many chunks there are, and the bounds of the chunks that have a mesh. Setting or removing a chunk recomputes its
+// ancestors from their children, so updates cost O(depth), and a query costs O(nodes visited) : the nodes whose
+// aggregates cannot match the query are skipped along with all of their chunks.
+// Nodes live in a pool (and are referred to by index), which recycles the nodes of removed chunks.
+struct ChunkOctree
+{
+    // Chunk flags.
+    static constexpr u8 FLAG_EMPTY = 1u << 0u;
+    static constexpr u8 FLAG_FULL = 1u << 1u;
+
+    // The chunk has an indirect command.
+    static constexpr u8 FLAG_HAS_MESH = 1u << 2u;
+
+    // The chunk is waiting to be (or is being) re-meshed.
+    static constexpr u8 FLAG_DIRTY = 1u << 3u;
+
+    static constexpr u32 ROOT_LEVEL = 5u;
+    static constexpr u32 INVALID_NODE = std::numeric_limits<u32>::max();
+
+    struct Node
+    {
+        // Minimum corner of the node, in chunks.
+        DirectX::XMUINT3 m_origin{};
+        u32 m_level{};
+
+        u32 m_parent{INVALID_NODE};
+
+        // Children are indexed by (x | y << 1 | z << 2), where x, y and z are bit (level - 1) of the chunk index of
+        // the child along each axis.
+        std::array<u32, 8u> m_children{};
+
+        // Only set for leaves.
+        size_t m_chunk_index{};
+
+        u32 m_number_of_chunks{};
+        u8 m_any_flags{};
+        u8 m_all_flags{};
+
+        // Inclusive bounds (in chunks) of the chunks that have a mesh. Only valid if m_any_flags has FLAG_HAS_MESH.
+        DirectX::XMUINT3 m_mesh_bounds_min{};
+        DirectX::XMUINT3 m_mesh_bounds_max{};
+
+        inline u32 get_edge_length() const
+        {
+            return 1u << m_level;
+        }
+    };
+
+    // Adds the chunk, or updates its flags if it is already in the octree.
+    void set_chunk(const size_t chunk_index, const DirectX::XMUINT3 chunk_index_3d, const u8 flags);
+
+    // Does nothing if the chunk is not in the octree.
+    void remove_chunk(const DirectX::XMUINT3 chunk_index_3d);
+
+    // Returns INVALID_NODE if the chunk is not in the octree.
+    u32 find_leaf(const DirectX::XMUINT3 chunk_index_3d) const;
+
+    // Function is called with the chunk index of each chunk that has all of the given flags.
+    template <typename Function>
+    void for_each_chunk(const u8 flags, Function &&function) const
+    {
+        traverse([&](const Node &node) { return (node.m_any_flags & flags) == flags; },
+                 [&](const Node &leaf) {
+                     if ((leaf.m_all_flags & flags) == flags)
+                     {
+                         function(leaf.m_chunk_index);
+                     }
+                 });
+    }
+
+    // Function is called with the chunk index of each chunk that is further than distance from center (in chunks,
+    // along the axis where it is largest). Nodes that are entirely within distance are skipped.
+    template <typename Function>
+    void for_each_chunk_further_than(const DirectX::XMINT3 center, const u32 distance, Function &&function) const
+    {
+        const auto is_within_distance = [&](const DirectX::XMUINT3 min, const u32 edge_length) {
+            const auto is_axis_within_distance = [&](const u32 axis_min, const i32 axis_center) {
+                return static_cast<i64>(axis_min) >= static_cast<i64>(axis_center) - distance &&
+                       static_cast<i64>(axis_min) + edge_length - 1 <= static_cast<i64>(axis_center) + distance;
+            };
+
+            return is_axis_within_distance(min.x, center.x) && is_axis_within_distance(min.y, center.y) &&
+                   is_axis_within_distance(min.z, center.z);
+        };
+
+        traverse([&](const Node &node) { return !is_within_distance(node.m_origin, node.get_edge_length()); },
+                 [&](const Node &leaf) { function(leaf.m_chunk_index); });
+    }
+
+    // Appends the chunk indices of the chunks with a mesh that are (possibly) inside of the frustum. Nodes that are
+    // entirely inside (or outside) of the frustum are accepted (or rejected) as a whole. The chunks of the lowest
+    // level nodes that intersect the frustum are tested with FrustumCulling::cull_chunks, so the result is the same
+    // as testing every chunk with it.
+    void cull_chunks(const FrustumCulling::Frustum &frustum, const float chunk_length,
+                     std::vector<size_t> &visible_chunk_indices);
+
+    struct RayHit
+    {
+        size_t m_chunk_index{};
+
+        // Distance along the (normalized) direction at which the ray enters the chunk. Zero if the origin is inside of
+        // the chunk.
+        float m_distance{};
+    };
+
+    // Returns the nearest chunk that has all of the given flags and that the ray enters within max distance. The
+    // children of a node are visited nearest first, and the nodes the ray enters past the nearest hit so far are
+    // skipped.
+    std::optional<RayHit> raycast(const DirectX::XMFLOAT3 origin, const DirectX::XMFLOAT3 direction,
+                                  const float max_distance, const float chunk_length, const u8 flags) const;
+
+    size_t get_number_of_nodes() const;
+
+    // Should visit node is called for every node (including leaves), and on leaf for each leaf that is visited. The
+    // subtree of a node is skipped if should visit node returns false.
+    template <typename ShouldVisitNode, typename OnLeaf>
+    void traverse(ShouldVisitNode &&should_visit_node, OnLeaf &&on_leaf) const
+    {
+        for (const u32 root : m_roots)
+        {
+            traverse_subtree(root, should_visit_node, on_leaf);
+        }
+    }
+
+    // Same as traverse, starting from the given node rather than from the roots.
+    template <typename ShouldVisitNode, typename OnLeaf>
+    void traverse_subtree(const u32 node_index, ShouldVisitNode &&should_visit_node, OnLeaf &&on_leaf) const
+    {
+        // Each level pushes at most 8 nodes, and pops one.
+        std::array<u32, 8u * (ROOT_LEVEL + 1u)> stack{};
+
+        u32 stack_size = 0u;
+        stack[stack_size++] = node_index;
+
+        while (stack_size != 0u)
+        {
+            const Node &node = m_nodes[stack[--stack_size]];
+            if (!should_visit_node(node))
+            {
+                continue;
+            }
+
+            if (node.m_level == 0u)
+            {
+                on_leaf(node);
+                continue;
+            }
+
+            for (const u32 child : node.m_children)
+            {
+                if (child != INVALID_NODE)
+                {
+                    stack[stack_size++] = child;
+                }
+            }
+        }
+    }
+
+    u32 allocate_node(const DirectX::XMUINT3 origin, const u32 level, const u32 parent);
+    void free_node(const u32 node_index);
+
+    // Recomputes the aggregates of the node from its children.
+    void refresh_node(const u32 node_index);
+
+    std::vector<Node> m_nodes{};
+    std::vector<u32> m_free_nodes{};
+
+    // There are few roots (a root spans more chunks than the unload distance), so they are searched linearly.
+    std::vector<u32> m_roots{};
+
+    // Scratch buffers of cull_chunks : the chunks of the nodes that intersect the frustum, as a structure of arrays.
+    std::vector<size_t> m_candidate_chunk_indices{};
+    std::vector<float> m_candidate_chunk_min_x{};
+    std::vector<float> m_candidate_chunk_min_y{};
+    std::vector<float> m_candidate_chunk_min_z{};
+    std::vector<u32> m_visible_candidate_indices{};
+
+    // Number of chunks whose flags were set (or that were removed), which is how many times ancestors were refreshed.
+    u64 m_number_of_updates{};
+};
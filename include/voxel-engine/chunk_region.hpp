@@ -0,0 +1,236 @@
+#pragma once
+
+#include "voxel-engine/chunk.hpp"
+#include "voxel-engine/chunk_indirect_command_array.hpp"
+#include "voxel-engine/chunk_mesher.hpp"
+#include "voxel-engine/gpu_backend.hpp"
+
+// A range of faces of a page of a region (see ChunkRegions). Chunks with no visible faces have no range (i.e the number
+// of faces is zero).
+struct ChunkRegionAllocation
+{
+    u64 m_region_key{};
+    u32 m_page_index{};
+    u32 m_first_face{};
+    u32 m_number_of_faces{};
+
+    inline bool is_valid() const
+    {
+        return m_number_of_faces != 0u;
+    }
+};
+
+// The meshes of the chunks of a region (a cube of NUMBER_OF_CHUNKS_PER_REGION_DIMENSION chunks per dimension, aligned
+// to the world chunk grid) are packed into the same buffers, so that a region costs a handful of buffers rather than
+// three per chunk, and so that the chunks of a region can be drawn together.
+// The buffers of a region are split into pages : each page is an index buffer, a color buffer and a constant buffer,
+// which are sub-allocated in ranges of faces (6 indices and a color each). When a chunk is (re-)meshed, only its own
+// range is uploaded, into a range that no frame in flight can be reading (see allocate). Pages are never resized : if
+// none of the pages of a region has room, a larger page is created, and pages are released once they are empty.
+// The indices of a region are the indices of the chunk mesh (into the shared position buffer) with the slot of the
+// chunk in the region in the bits above REGION_CHUNK_SLOT_SHIFT, so that 16 bit indices can still be used. The vertex
+// shader finds the translation of the chunk of the vertex from its slot (see RegionConstantBuffer).
+// The regions also keep one indirect command per run of adjacent loaded meshes of a page, so that the loaded chunks of
+// a region can be drawn with a few commands. The loaded meshes of each page (and the number of faces of each of their
+// face directions) are in the constant buffer of the page, so that the culling shader can still cull the chunks of a
+// run, and their face directions, one by one (see gpu_culling_shader.hlsl). The frames in flight may still read the
+// list of loaded meshes a page had when they were recorded, so a page that changes in a later frame writes the next of
+// its lists instead, and its commands point at it.
+struct ChunkRegions
+{
+    static constexpr u32 NUMBER_OF_CHUNKS_PER_REGION_DIMENSION = 4u;
+    static constexpr u32 NUMBER_OF_CHUNKS_PER_REGION = NUMBER_OF_CHUNKS_PER_REGION_DIMENSION *
+                                                       NUMBER_OF_CHUNKS_PER_REGION_DIMENSION *
+                                                       NUMBER_OF_CHUNKS_PER_REGION_DIMENSION;
+
+    static constexpr u32 REGION_CHUNK_SLOT_SHIFT =
+        static_cast<u32>(std::bit_width(NUMBER_OF_SHARED_VERTICES<CHUNK_DIMENSION> - 1u));
+
+    using Index = std::conditional_t<REGION_CHUNK_SLOT_SHIFT + std::bit_width(NUMBER_OF_CHUNKS_PER_REGION - 1u) <= 16u,
+                                     u16, u32>;
+
+    // Room for a flat layer of faces across 2 chunks. Most regions are mostly empty (or full), and pages grow
+    // geometrically for the ones that are not (see create_page).
+    static constexpr u32 MIN_PAGE_CAPACITY_IN_FACES = CHUNK_DIMENSION * CHUNK_DIMENSION * 2u;
+
+    // A chunk mesh has at most half as many faces of a direction as the chunk has voxels, as the neighbor of a voxel
+    // with a face in that direction is empty.
+    static constexpr u32 FACE_COUNT_BITS =
+        static_cast<u32>(std::bit_width(CHUNK_DIMENSION * CHUNK_DIMENSION * CHUNK_DIMENSION / 2u));
+
+    // A page switches to a new list of loaded chunk meshes at most once per frame, so one more list than frames in
+    // flight is never read while it is written (see Page).
+    static constexpr u32 NUMBER_OF_LOADED_CHUNK_MESH_LISTS = 4u;
+
+    // Region chunk slot of the commands that draw a run of chunk meshes of a region.
+    static constexpr u32 REGION_COMMAND_CHUNK_SLOT = NUMBER_OF_CHUNKS_PER_REGION;
+
+    // A free range of faces of a page.
+    struct FaceRange
+    {
+        u32 m_first_face{};
+        u32 m_number_of_faces{};
+    };
+
+    // A page whose resources are null has been released, and its slot can be re-used.
+    struct Page
+    {
+        IndexBuffer m_index_buffer{};
+        StructuredBuffer m_color_buffer{};
+        ConstantBuffer m_constant_buffer{};
+
+        u32 m_capacity_in_faces{};
+
+        // Sorted by first face, and never adjacent to each other.
+        std::vector<FaceRange> m_free_face_ranges{};
+
+        // Slots of the chunks whose loaded mesh is in the page, in the order of their faces, which is the order of the
+        // loaded chunk meshes of the constant buffer. Both have room for every chunk of the region, so that they are
+        // updated in place as meshes are loaded.
+        std::vector<u32> m_loaded_chunk_slots{};
+        std::vector<DirectX::XMUINT4> m_loaded_chunk_meshes{};
+
+        // List of loaded chunk meshes of the constant buffer that the commands of the page point at. The list is
+        // written in place as long as the direct queue has not signalled since it was first written, i.e no frame can
+        // have read it yet.
+        u32 m_loaded_chunk_mesh_list{};
+        std::optional<u64> m_loaded_chunk_mesh_list_direct_queue_fence_value{};
+
+        // Handles of the indirect commands of the runs of the page in m_region_indirect_commands, in run order.
+        std::vector<u32> m_indirect_command_handles{};
+
+        u32 m_number_of_allocations{};
+
+        u64 m_size_in_bytes{};
+    };
+
+    // The range of the loaded mesh of a chunk, and the number of faces of each of its face directions.
+    struct LoadedMesh
+    {
+        ChunkRegionAllocation m_allocation{};
+        std::array<u32, NUMBER_OF_FACE_DIRECTIONS> m_face_direction_face_counts{};
+    };
+
+    struct Region
+    {
+        DirectX::XMUINT3 m_region_index_3d{};
+
+        std::vector<Page> m_pages{};
+        u32 m_number_of_pages{};
+
+        // Meshes of the loaded chunks, indexed by slot.
+        std::array<LoadedMesh, NUMBER_OF_CHUNKS_PER_REGION> m_loaded_meshes{};
+    };
+
+    static u64 get_region_key(const DirectX::XMUINT3 chunk_index_3d);
+    static u32 get_region_chunk_slot(const DirectX::XMUINT3 chunk_index_3d);
+    static DirectX::XMUINT3 get_chunk_index_3d(const DirectX::XMUINT3 region_index_3d, const u32 region_chunk_slot);
+
+    // A loaded chunk mesh of the constant buffer of a page (see RegionConstantBuffer::loaded_chunk_meshes).
+    static DirectX::XMUINT4 encode_loaded_chunk_mesh(
+        const u32 region_chunk_slot, const std::array<u32, NUMBER_OF_FACE_DIRECTIONS> &face_direction_face_counts);
+
+    // Index of the region from the index of a chunk mesh.
+    static inline Index encode_index(const u32 mesh_index, const u32 region_chunk_slot)
+    {
+        return static_cast<Index>(mesh_index | (region_chunk_slot << REGION_CHUNK_SLOT_SHIFT));
+    }
+
+    // Allocates a range of faces for the mesh of a chunk, in the region of the chunk. Ranges are only re-used once they
+    // are freed, so the new mesh of a chunk that is re-meshed never overwrites the mesh that is being drawn.
+    // The position buffer is the shared chunk position buffer, which the constant buffers of new pages refer to.
+    ChunkRegionAllocation allocate(GpuBackend &gpu_backend, const DirectX::XMUINT3 chunk_index_3d,
+                                   const u32 number_of_faces, const size_t position_buffer_srv_index);
+
+    // Must only be called once the GPU is done with the range. Pages are released as soon as they are empty, and
+    // regions once they have no pages left.
+    void free(const ChunkRegionAllocation &allocation);
+
+    const Page &get_page(const ChunkRegionAllocation &allocation) const;
+
+    // The indirect command that draws the whole range. The face direction index counts are left to the caller.
+    ChunkIndirectCommand create_indirect_command(const ChunkRegionAllocation &allocation,
+                                                 const u32 region_chunk_slot) const;
+
+    // Sets the range that is drawn for the chunk by the commands of its region. Only the commands of the pages of the
+    // previous and the new range are updated (right away). An invalid allocation means the chunk is not drawn.
+    // The direct queue fence value is the last value the direct queue has signalled.
+    void set_loaded_mesh(const DirectX::XMUINT3 chunk_index_3d, const ChunkRegionAllocation &allocation,
+                         const FaceDirectionIndexRanges &face_direction_index_ranges,
+                         const u64 direct_queue_fence_value);
+
+    // Calls function with a command for each run of consecutive meshes of a region command whose chunks are visible,
+    // i.e for which is chunk visible (called with the chunk index 3d of each chunk of the run, in order) returns true.
+    // Used to cull the chunks of region commands on the CPU.
+    template <typename IsChunkVisible, typename Function>
+    void for_each_visible_run(const u64 region_key, const ChunkIndirectCommand &region_command,
+                              IsChunkVisible &&is_chunk_visible, Function &&function) const
+    {
+        const Region &region = m_regions.at(region_key);
+        const ChunkIndirectCommand::RegionRun &region_run = region_command.region_run;
+        const Page &page = region.m_pages[region_run.page_index];
+
+        const u32 end_loaded_chunk_mesh = region_run.first_loaded_chunk_mesh + region_run.number_of_loaded_chunk_meshes;
+
+        // The number of meshes of the run is the number of visible meshes so far.
+        ChunkIndirectCommand run_command = region_command;
+        u32 &number_of_run_meshes = run_command.region_run.number_of_loaded_chunk_meshes;
+        number_of_run_meshes = 0u;
+
+        for (u32 i = region_run.first_loaded_chunk_mesh; i < end_loaded_chunk_mesh; i++)
+        {
+            const u32 region_chunk_slot = page.m_loaded_chunk_slots[i];
+            if (!is_chunk_visible(get_chunk_index_3d(region.m_region_index_3d, region_chunk_slot)))
+            {
+                if (number_of_run_meshes != 0u)
+                {
+                    function(run_command);
+                    number_of_run_meshes = 0u;
+                }
+
+                continue;
+            }
+
+            const ChunkRegionAllocation &allocation = region.m_loaded_meshes[region_chunk_slot].m_allocation;
+            if (number_of_run_meshes++ == 0u)
+            {
+                run_command.region_run.first_loaded_chunk_mesh = i;
+                run_command.first_face_index = allocation.m_first_face;
+                run_command.index_count_per_instance = 0u;
+                run_command.start_index_location = allocation.m_first_face * 6u;
+            }
+
+            run_command.index_count_per_instance += allocation.m_number_of_faces * 6u;
+        }
+
+        if (number_of_run_meshes != 0u)
+        {
+            function(run_command);
+        }
+    }
+
+    // Regions with at least one page, keyed by region key.
+    std::unordered_map<u64, Region> m_regions{};
+
+    // Indirect commands of the regions. The owner of each command is the region key, and its bounds are the bounds of
+    // the region.
+    ChunkIndirectCommandArray m_region_indirect_commands{};
+
+    u64 m_number_of_pages{};
+    u64 m_number_of_pages_created{};
+
+    // Buffers of the pages that have not been released yet.
+    u64 m_pages_size_in_bytes{};
+
+  private:
+    Region &get_or_create_region(const DirectX::XMUINT3 chunk_index_3d);
+
+    // Creates a page with room for at least number of faces, in a free page slot if there is one.
+    u32 create_page(GpuBackend &gpu_backend, Region &region, const u64 region_key, const u32 number_of_faces,
+                    const size_t position_buffer_srv_index);
+
+    // Writes the loaded chunk meshes of the page into its constant buffer, and updates the indirect commands of its
+    // runs. The commands that did not change are not uploaded again.
+    void update_page_indirect_commands(const u64 region_key, Region &region, const u32 page_index,
+                                       const u64 direct_queue_fence_value);
+};
@@ -2,6 +2,7 @@
 
 #include "types.hpp"
 
+#if defined(_WIN32)
 // Helper function to print to console in debug mode if the passed Hresult has failed.
 static inline void throw_if_failed(const HRESULT hr,
                                    const std::source_location src_loc = std::source_location::current())
@@ -15,24 +16,35 @@ static inline void throw_if_failed(const HRESULT hr,
         }
     }
 }
+#endif
 
-// Helper functions to go from 1d to 3d and vice versa.
-static inline size_t convert_to_1d(const DirectX::XMUINT3 index_3d, const size_t N)
+// Helper functions to go from 1d to 3d and vice versa, for a N x N x N grid.
+// N must be a power of two, so the divisions and modulos become shifts and masks (computed at compile time).
+template <size_t N>
+static inline size_t convert_to_1d(const DirectX::XMUINT3 index_3d)
 {
-    return index_3d.x + N * (index_3d.y + (index_3d.z * N));
+    static_assert(std::has_single_bit(N), "Grid dimension must be a power of two.");
+    constexpr size_t SHIFT = std::countr_zero(N);
+
+    return index_3d.x + (static_cast<size_t>(index_3d.y) << SHIFT) + (static_cast<size_t>(index_3d.z) << (2u * SHIFT));
 }
 
-static inline DirectX::XMUINT3 convert_to_3d(const size_t index, const size_t N)
+template <size_t N>
+static inline DirectX::XMUINT3 convert_to_3d(const size_t index)
 {
+    static_assert(std::has_single_bit(N), "Grid dimension must be a power of two.");
+    constexpr size_t SHIFT = std::countr_zero(N);
+    constexpr size_t MASK = N - 1u;
+
     // For reference, index = x + y * N + z * N * N.
-    const u32 z = static_cast<u32>(index / (N * N));
-    const u32 index_2d = static_cast<u32>(index - z * N * N);
-    const u32 y = static_cast<u32>(index_2d / N);
-    const u32 x = static_cast<u32>(index_2d % N);
+    const u32 x = static_cast<u32>(index & MASK);
+    const u32 y = static_cast<u32>((index >> SHIFT) & MASK);
+    const u32 z = static_cast<u32>(index >> (2u * SHIFT));
 
     return {x, y, z};
 }
 
+#if defined(_WIN32)
 static inline void name_d3d12_object(ID3D12Object *const object, const std::wstring_view name)
 {
     if constexpr (VX_DEBUG_MODE)
@@ -40,6 +52,7 @@ static inline void name_d3d12_object(ID3D12Object *const object, const std::wstr
         object->SetName(std::wstring(name).c_str());
     }
 }
+#endif
 
 static inline size_t round_up_to_multiple(size_t a, size_t multiple)
 {
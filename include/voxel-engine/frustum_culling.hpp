@@ -0,0 +1,59 @@
+#pragma once
+
+// CPU frustum culling of chunks.
+// Chunks are tested against the six planes of the view frustum : a chunk is culled if its AABB is entirely on the
+// outer side of one of the planes. This is conservative (a chunk near a frustum corner may be kept), but never culls a
+// chunk that is visible, even if all of its corners are outside of the frustum.
+// Chunk bounds are passed as a structure of arrays (the minimum corner of each chunk, all chunks have the same edge
+// length), so that the test runs on 8 chunks at once with AVX2 (selected at compile time, see src/CMakeLists.txt).
+// The clip space test of gpu_culling_shader.hlsl is mirrored as well, so that the GPU path can be checked against the
+// plane test.
+// The naming convention of namespaces is being broken here, mostly because this "namespace" is a smart way of
+// simulating static class behaviour.
+namespace FrustumCulling
+{
+// Planes are stored as (normal, distance), with the normals pointing inwards and normalized. A point p is inside of a
+// plane if dot(normal, p) + distance >= 0.
+struct Frustum
+{
+    std::array<DirectX::XMFLOAT4, 6u> m_planes{};
+};
+
+// The view projection matrix transforms row vectors (v * M) into D3D clip space, where 0 <= z <= w.
+// The view matrix of the engine is relative to the camera (the camera is always at the origin), so the camera
+// position is folded into the planes : the frustum can then be used with world space bounds directly.
+// Planes with a null normal (e.g the far plane of an infinite projection) never cull anything.
+Frustum create_frustum(const DirectX::XMFLOAT4X4 &view_projection_matrix, const DirectX::XMFLOAT3 camera_position);
+
+// Writes the indices of the chunks that are (possibly) visible into visible_chunk_indices, which must have room for
+// number_of_chunks indices, and returns how many were written.
+size_t cull_chunks(const Frustum &frustum, const float chunk_length, const float *const chunk_min_x,
+                   const float *const chunk_min_y, const float *const chunk_min_z, const size_t number_of_chunks,
+                   u32 *const visible_chunk_indices);
+
+// Same as cull_chunks, one chunk at a time. Used as a reference for the vectorized path.
+size_t cull_chunks_scalar(const Frustum &frustum, const float chunk_length, const float *const chunk_min_x,
+                          const float *const chunk_min_y, const float *const chunk_min_z, const size_t number_of_chunks,
+                          u32 *const visible_chunk_indices);
+
+// Mirror of gpu_culling_shader.hlsl : the 8 corners of the chunk AABB are transformed into clip space (relative to the
+// camera), and the chunk is culled if all of them are outside of the same clip plane.
+bool is_chunk_visible_by_clip_space_test(const DirectX::XMFLOAT4X4 &view_projection_matrix,
+                                         const DirectX::XMFLOAT3 camera_position, const float chunk_length,
+                                         const DirectX::XMFLOAT3 chunk_min);
+
+// Where a box is with respect to the frustum : entirely outside of one of the planes, inside of all of them, or
+// neither.
+enum class BoxContainment : u8
+{
+    Outside,
+    Intersecting,
+    Inside,
+};
+
+// Unlike the culling functions, the box can have any extent (e.g a node of the chunk octree).
+BoxContainment classify_box(const Frustum &frustum, const DirectX::XMFLOAT3 box_min, const DirectX::XMFLOAT3 box_max);
+
+// Name of the instruction set used by cull_chunks.
+const char *get_simd_instruction_set_name();
+} // namespace FrustumCulling
@@ -0,0 +1,109 @@
+#pragma once
+
+// GPU resources as seen by code that only creates them and hands their descriptors to shaders (such as the chunk
+// manager). None of these depend on the graphics API, so that the chunk pipeline can also run without a GPU.
+
+// The underlying API resource. It is released when the last copy of the buffer is destroyed.
+using GpuResource = std::shared_ptr<void>;
+
+struct StructuredBuffer
+{
+    GpuResource resource{};
+    size_t srv_index{};
+    size_t size_in_bytes{};
+};
+
+struct ConstantBuffer
+{
+    GpuResource resource{};
+    size_t cbv_index{};
+    size_t size_in_bytes{};
+
+    u8 *resource_mapped_ptr{};
+
+    inline void update(const void *data) const
+    {
+        memcpy(resource_mapped_ptr, data, size_in_bytes);
+    }
+};
+
+// Same layout as D3D12_INDEX_BUFFER_VIEW, so that it can be used in indirect commands as is.
+struct IndexBufferView
+{
+    u64 buffer_location{};
+    u32 size_in_bytes{};
+    u32 format{};
+};
+
+// Values of DXGI_FORMAT_R16_UINT and DXGI_FORMAT_R32_UINT.
+static constexpr u32 INDEX_FORMAT_R16_UINT = 57u;
+static constexpr u32 INDEX_FORMAT_R32_UINT = 42u;
+
+struct IndexBuffer
+{
+    GpuResource resource{};
+    size_t indices_count{};
+    IndexBufferView index_buffer_view{};
+};
+
+// A buffer in CPU visible memory that is persistently mapped. Its data is copied into other buffers (see
+// GpuBackend::copy_buffer_region).
+struct UploadBuffer
+{
+    GpuResource resource{};
+    u8 *resource_mapped_ptr{};
+    size_t size_in_bytes{};
+};
+
+// The part of the renderer that is used to upload data to the GPU. It is implemented by the D3D12 renderer and by the
+// null backend (see null_gpu_backend.hpp).
+// Buffers are uploaded on a copy queue, which signals a monotonically increasing fence value once an upload is
+// complete. The resource creation functions can be called from multiple threads at once.
+struct GpuBackend
+{
+    virtual ~GpuBackend() = default;
+
+    // Resource creation functions.
+    // The functions return a buffer and intermediate resource (which can be discarded once the upload is complete).
+    struct IndexBufferWithIntermediateResource
+    {
+        IndexBuffer index_buffer;
+        GpuResource intermediate_resource;
+    };
+
+    // The index format is determined by the stride : 32 bit indices if stride is 4, 16 bit indices otherwise.
+    // If data is null, the buffer is not initialized (its contents are written with copy_buffer_region), and there is
+    // no intermediate resource. The same goes for structured buffers.
+    virtual IndexBufferWithIntermediateResource create_index_buffer(const void *data, const size_t stride,
+                                                                    const size_t indices_count,
+                                                                    const std::wstring_view buffer_name) = 0;
+
+    struct StucturedBufferWithIntermediateResource
+    {
+        StructuredBuffer structured_buffer;
+        GpuResource intermediate_resource;
+    };
+
+    virtual StucturedBufferWithIntermediateResource create_structured_buffer(const void *data, const size_t stride,
+                                                                             const size_t num_elements,
+                                                                             const std::wstring_view buffer_name) = 0;
+
+    // Constant buffers are persistently mapped, and do not have to be uploaded.
+    virtual ConstantBuffer create_constant_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name) = 0;
+
+    virtual UploadBuffer create_upload_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name) = 0;
+
+    // Copies a range of the upload buffer into a range of the destination buffer, on the copy queue. The range of the
+    // destination must not be in use by the GPU, but the rest of the buffer may be.
+    virtual void copy_buffer_region(const GpuResource &destination, const size_t destination_offset,
+                                    const UploadBuffer &source, const size_t source_offset,
+                                    const size_t size_in_bytes) = 0;
+
+    // The fence value that the copy queue signals once the most recent upload is complete. Once a thread has created
+    // its buffers, this is the value it has to wait for.
+    virtual u64 get_last_copy_queue_fence_value() const = 0;
+    virtual u64 get_completed_copy_queue_fence_value() const = 0;
+
+    // Blocks until all uploads are complete.
+    virtual void flush_copy_queue() = 0;
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "voxel-engine/terrain_generator.hpp"
+
+// Cache of heightmap columns, keyed by (chunk x, chunk z). All chunks that are stacked vertically share the 2D noise of
+// their column, rather than each of them evaluating it again.
+// The map itself is only accessed by the main thread : a chunk acquires a reference to its column when it is added to
+// the chunk manager, and releases it when it is unloaded. The column is evicted once no chunk references it.
+// The entries are shared with the worker threads, and the first worker that requires the heightmap of a column
+// generates it (others wait for it to finish).
+struct HeightmapColumnCache
+{
+    struct Entry
+    {
+        // Returns the heightmap column, and generates it if this is the first call. is_generated is set if this call
+        // generated the column.
+        const HeightmapColumn &get_or_generate(const TerrainSettings &terrain_settings, bool &is_generated);
+
+        u32 m_chunk_x{};
+        u32 m_chunk_z{};
+
+        std::once_flag m_once_flag{};
+        HeightmapColumn m_heightmap_column{};
+
+        // Number of chunks (that are being setup or are loaded) in this column.
+        u32 m_reference_count{};
+    };
+
+    void acquire(const u32 chunk_x, const u32 chunk_z);
+    void release(const u32 chunk_x, const u32 chunk_z);
+
+    // Returns null if the column is not in the cache.
+    std::shared_ptr<Entry> get(const u32 chunk_x, const u32 chunk_z) const;
+
+    static inline u64 get_key(const u32 chunk_x, const u32 chunk_z)
+    {
+        return static_cast<u64>(chunk_x) | (static_cast<u64>(chunk_z) << 32u);
+    }
+
+    // Entries are shared pointers, so that a column that is evicted while a worker thread is still using it stays
+    // alive until the worker is done.
+    std::unordered_map<u64, std::shared_ptr<Entry>> m_entries{};
+};
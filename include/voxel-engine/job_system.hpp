@@ -0,0 +1,132 @@
+#pragma once
+
+// Workers always run the highest priority job they can find, be it one of their own or one they steal.
+enum class JobPriority : u8
+{
+    High,
+    Normal,
+};
+
+static constexpr u32 NUMBER_OF_JOB_PRIORITIES = 2u;
+
+// Lets the thread that submitted work ask the jobs doing it to stop. Cancellation is cooperative : jobs check the token
+// at points where stopping is cheap, so a job that is past its last check runs to completion.
+// Copies share the same state.
+struct CancellationToken
+{
+    void cancel() const
+    {
+        m_is_cancelled->store(true, std::memory_order_relaxed);
+    }
+
+    bool is_cancelled() const
+    {
+        return m_is_cancelled->load(std::memory_order_relaxed);
+    }
+
+    std::shared_ptr<std::atomic<bool>> m_is_cancelled{std::make_shared<std::atomic<bool>>(false)};
+};
+
+// A work stealing job system.
+// Each worker thread has a deque of jobs per priority. Jobs that a worker queues itself (such as the dependents of the
+// job it just finished) are pushed to and popped from the back of its own deque, so the data they use is likely still
+// in its cache. Once the deques of a worker are empty, it steals jobs from the front of the deques of the other
+// workers. Jobs submitted by other threads (i.e the main thread) are distributed round robin across the workers.
+// A job can depend on other jobs, and is only queued once all of them have completed. This way, work can be split into
+// stages that are scheduled (and stolen) independently.
+struct JobSystem
+{
+    struct Job
+    {
+        std::function<void()> m_function{};
+        JobPriority m_priority{};
+
+        // The job is queued once this reaches zero. Submitting the job counts as a dependency too, so that a job that
+        // is still being setup cannot run.
+        std::atomic<u32> m_number_of_pending_dependencies{1u};
+
+        // Jobs that depend on this one. Both members are guarded by the mutex.
+        std::vector<std::shared_ptr<Job>> m_dependents{};
+        bool m_is_complete{};
+
+        std::mutex m_mutex{};
+    };
+
+    using JobHandle = std::shared_ptr<Job>;
+
+    // If the number of worker threads is zero, a worker is created for each hardware thread except one, so that the
+    // main thread is not competing with the workers for a core.
+    explicit JobSystem(const u32 number_of_worker_threads = 0u);
+
+    JobSystem(const JobSystem &other) = delete;
+    JobSystem &operator=(const JobSystem &other) = delete;
+
+    // Waits for all submitted jobs to complete.
+    ~JobSystem();
+
+    // The job is not queued until it is submitted, so that dependencies can be added in between.
+    JobHandle create_job(std::function<void()> function, const JobPriority priority = JobPriority::Normal);
+
+    // Job will not run until dependency has completed. Must be called before job is submitted.
+    static void add_dependency(const JobHandle &job, const JobHandle &dependency);
+
+    void submit(const JobHandle &job);
+
+    // Blocks until all submitted jobs (and their dependents) have completed. Must not be called from a job.
+    void wait_for_all_jobs();
+
+    u32 get_number_of_worker_threads() const;
+
+    // Jobs that have been submitted but have not completed yet, including the ones waiting for their dependencies.
+    u64 get_number_of_pending_jobs() const;
+
+    struct Statistics
+    {
+        u64 m_number_of_jobs_executed{};
+        u64 m_number_of_jobs_stolen{};
+    };
+
+    Statistics get_statistics() const;
+
+  private:
+    void worker_thread_function(const u32 worker_index);
+
+    // Pushes a job whose dependencies have all completed to a worker deque, and wakes up a worker.
+    void queue_job(JobHandle &&job);
+
+    // Returns null if there are no queued jobs.
+    JobHandle pop_or_steal_job(const u32 worker_index);
+
+    // Queues the dependents of the job that have no other pending dependencies.
+    void complete_job(const JobHandle &job);
+
+  public:
+    // The deques are guarded by a mutex rather than being lock free : a job in this engine is large (generating or
+    // meshing an entire chunk), so the deques are rarely contended.
+    // Aligned to a cache line so that workers do not invalidate each others statistics.
+    struct alignas(64) Worker
+    {
+        std::array<std::deque<JobHandle>, NUMBER_OF_JOB_PRIORITIES> m_jobs{};
+        std::mutex m_mutex{};
+
+        std::atomic<u64> m_number_of_jobs_executed{};
+        std::atomic<u64> m_number_of_jobs_stolen{};
+
+        std::thread m_thread{};
+    };
+
+    std::vector<std::unique_ptr<Worker>> m_workers{};
+
+    // Worker on which the next job submitted by a thread that is not a worker is queued.
+    std::atomic<u32> m_next_worker_index{};
+
+    // Jobs that are in the deques. Workers sleep when there are none.
+    std::atomic<u64> m_number_of_queued_jobs{};
+    std::atomic<u64> m_number_of_pending_jobs{};
+
+    std::mutex m_sleep_mutex{};
+    std::condition_variable m_sleep_condition_variable{};
+    std::condition_variable m_idle_condition_variable{};
+
+    bool m_stop{};
+};
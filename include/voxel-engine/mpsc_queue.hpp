@@ -0,0 +1,67 @@
+#pragma once
+
+// A lock free, unbounded, multiple producer single consumer queue.
+// Producers push nodes onto an intrusive stack with a compare and swap. The consumer takes the entire stack with a
+// single exchange and reverses it, so that items are popped in the order they were pushed. As the consumer never pops
+// a single node, the stack is not subject to the ABA problem.
+template <typename T>
+struct MpscQueue
+{
+    MpscQueue() = default;
+
+    MpscQueue(const MpscQueue &other) = delete;
+    MpscQueue &operator=(const MpscQueue &other) = delete;
+
+    ~MpscQueue()
+    {
+        pop_all([](T &&) {});
+    }
+
+    // Can be called from any thread.
+    void push(T &&value)
+    {
+        Node *const node = new Node{std::move(value), m_head.load(std::memory_order_relaxed)};
+        while (!m_head.compare_exchange_weak(node->m_next, node, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Must only be called by one thread at a time. Function is called with each item, oldest first. Returns the number
+    // of items popped.
+    template <typename Function>
+    size_t pop_all(Function &&function)
+    {
+        Node *node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+        Node *oldest_node = nullptr;
+        while (node)
+        {
+            Node *const next_node = node->m_next;
+            node->m_next = oldest_node;
+            oldest_node = node;
+            node = next_node;
+        }
+
+        size_t number_of_items = 0u;
+        while (oldest_node)
+        {
+            Node *const next_node = oldest_node->m_next;
+            function(std::move(oldest_node->m_value));
+            delete oldest_node;
+
+            oldest_node = next_node;
+            ++number_of_items;
+        }
+
+        return number_of_items;
+    }
+
+  private:
+    struct Node
+    {
+        T m_value;
+        Node *m_next;
+    };
+
+    std::atomic<Node *> m_head{};
+};
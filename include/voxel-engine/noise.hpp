@@ -0,0 +1,34 @@
+#pragma once
+
+// Gradient noise (improved perlin noise with hashed gradients instead of a permutation table, so that the lattice hash
+// can be vectorized).
+// Noise is evaluated one row at a time : count samples along the x axis, starting at x and spaced x_step apart, with y
+// and z fixed. This matches how chunk occupancy is stored, and lets the row kernels use SSE2 / AVX2 (selected at
+// compile time, see src/CMakeLists.txt).
+// The naming convention of namespaces is being broken here, mostly because this "namespace" is a smart way of
+// simulating static class behaviour.
+namespace Noise
+{
+// Parameters for fractal brownian motion (fbm), i.e the sum of octaves of gradient noise, where each octave has
+// lacunarity times the frequency and gain times the amplitude of the previous one.
+struct FbmSettings
+{
+    float m_frequency{1.0f / 64.0f};
+    u32 m_number_of_octaves{4u};
+    float m_lacunarity{2.0f};
+    float m_gain{0.5f};
+};
+
+// Returns a value in the range [-1, 1] (approximately).
+float gradient_noise_3d(const float x, const float y, const float z, const u32 seed);
+
+void gradient_noise_3d_row(const float x, const float x_step, const float y, const float z, const u32 seed,
+                           const size_t count, float *const output);
+
+// The result is normalized by the sum of octave amplitudes, so it is also in the range [-1, 1].
+void fbm_3d_row(const FbmSettings &fbm_settings, const float x, const float y, const float z, const u32 seed,
+                const size_t count, float *const output);
+
+// Name of the instruction set used by the row kernels.
+const char *get_simd_instruction_set_name();
+} // namespace Noise
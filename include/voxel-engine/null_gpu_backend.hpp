@@ -0,0 +1,61 @@
+#pragma once
+
+#include "voxel-engine/gpu_backend.hpp"
+
+// A GPU backend that does not need a GPU : buffers live in plain memory, and uploads complete as soon as the buffer is
+// created. It keeps track of the resources that are created and released, so that the chunk pipeline can be run and
+// profiled headless (see headless_main.cpp), and resource leaks show up in the statistics.
+// Resources created by the backend must not outlive it.
+struct NullGpuBackend final : public GpuBackend
+{
+    IndexBufferWithIntermediateResource create_index_buffer(const void *data, const size_t stride,
+                                                            const size_t indices_count,
+                                                            const std::wstring_view buffer_name) override;
+
+    StucturedBufferWithIntermediateResource create_structured_buffer(const void *data, const size_t stride,
+                                                                     const size_t num_elements,
+                                                                     const std::wstring_view buffer_name) override;
+
+    ConstantBuffer create_constant_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name) override;
+
+    UploadBuffer create_upload_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name) override;
+
+    void copy_buffer_region(const GpuResource &destination, const size_t destination_offset,
+                            const UploadBuffer &source, const size_t source_offset,
+                            const size_t size_in_bytes) override;
+
+    // There is nothing to wait for : every fence value has been reached.
+    u64 get_last_copy_queue_fence_value() const override;
+    u64 get_completed_copy_queue_fence_value() const override;
+
+    void flush_copy_queue() override;
+
+    struct Statistics
+    {
+        u64 m_number_of_index_buffers_created{};
+        u64 m_number_of_structured_buffers_created{};
+        u64 m_number_of_constant_buffers_created{};
+        u64 m_number_of_upload_buffers_created{};
+
+        // Bytes that would have been uploaded by the copy queue.
+        u64 m_uploaded_size_in_bytes{};
+
+        // Resources that have been created but not yet released, and the memory they hold.
+        u64 m_number_of_live_resources{};
+        u64 m_live_resources_size_in_bytes{};
+    };
+
+    Statistics get_statistics() const;
+
+  private:
+    // Allocates a resource, and copies the data into it (if any).
+    GpuResource create_resource(const void *data, const size_t size_in_bytes);
+
+  public:
+    Statistics m_statistics{};
+
+    // Descriptor indices are handed out the same way the descriptor heap of the renderer does.
+    size_t m_next_descriptor_index{};
+
+    mutable std::mutex m_mutex{};
+};
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "voxel-engine/job_system.hpp"
+
+// A low resolution depth buffer, that large occluders are rasterized into on the CPU, and that chunk AABBs are tested
+// against : a chunk is occluded if, over the whole screen rectangle covered by its AABB, something nearer than the
+// nearest point of the AABB has been rasterized.
+// The depth is the linear view depth (clip space w), and is conservative : each occluder face is rasterized at the
+// depth of its furthest corner. Occluders and chunks that cross the near plane are skipped (i.e never occlude, and are
+// never occluded).
+// Rasterization and testing run on 8 pixels at once with AVX2 (selected at compile time, see src/CMakeLists.txt).
+struct OcclusionBuffer
+{
+    // The width is a multiple of 8, so that rows are made of whole 8 pixel blocks.
+    static constexpr u32 WIDTH = 256u;
+    static constexpr u32 HEIGHT = 128u;
+
+    // The view projection matrix is the same as for FrustumCulling::create_frustum : relative to the camera, and
+    // transforming row vectors into D3D clip space. The buffer is cleared.
+    void set_view(const DirectX::XMFLOAT4X4 &view_projection_matrix, const DirectX::XMFLOAT3 camera_position,
+                  const float near_plane);
+
+    // Rasterizes the faces of a solid box (e.g a chunk that is entirely full) that face the camera.
+    void rasterize_box(const DirectX::XMFLOAT3 box_min, const float edge_length);
+
+    bool is_box_occluded(const DirectX::XMFLOAT3 box_min, const float edge_length) const;
+
+    // Screen position (in pixels) and clip space w of a world space point.
+    struct ProjectedPoint
+    {
+        float m_x{};
+        float m_y{};
+        float m_w{};
+    };
+
+    ProjectedPoint project(const DirectX::XMFLOAT3 position) const;
+
+    // Returns false if a corner of the box is in front of the near plane.
+    bool project_box(const DirectX::XMFLOAT3 box_min, const float edge_length,
+                     std::array<ProjectedPoint, 8u> &corners) const;
+
+    // The quad is convex, and all of its pixels are written at the given depth (unless something nearer is there).
+    void rasterize_quad(const std::array<ProjectedPoint, 4u> &corners, const float depth);
+
+    DirectX::XMFLOAT4X4 m_view_projection_matrix{};
+    DirectX::XMFLOAT3 m_camera_position{};
+    float m_near_plane{};
+
+    // Row major, cleared to infinity.
+    std::vector<float> m_depth{};
+};
+
+// Runs occlusion culling as a job, so that it runs on the worker threads alongside generation and meshing.
+// The main thread submits a frame (the view, the occluders and the chunks to test), and picks up the result once the
+// job has completed, usually on the next frame : chunks are culled with the result of the last completed frame, so a
+// chunk that is revealed by a fast camera movement may pop in one frame late.
+struct OcclusionCuller
+{
+    struct Frame
+    {
+        DirectX::XMFLOAT4X4 m_view_projection_matrix{};
+        DirectX::XMFLOAT3 m_camera_position{};
+        float m_near_plane{};
+        float m_chunk_length{};
+
+        // Minimum corners of the chunks that are rasterized as occluders.
+        std::vector<DirectX::XMFLOAT3> m_occluder_chunk_mins{};
+
+        // Chunks that are tested against the occluders.
+        std::vector<size_t> m_chunk_indices{};
+        std::vector<DirectX::XMFLOAT3> m_chunk_mins{};
+
+        // Output : Sorted, so that chunks can be looked up with a binary search.
+        std::vector<size_t> m_occluded_chunk_indices{};
+        float m_culling_time_us{};
+    };
+
+    // Returns false (and drops the frame) if the previous frame has not completed yet.
+    bool submit(JobSystem &job_system, Frame &&frame);
+
+    // Returns true if the frame in flight has completed, in which case it becomes the completed frame.
+    bool poll();
+
+    bool is_frame_in_flight() const;
+
+    bool is_chunk_occluded(const size_t chunk_index) const;
+
+    static void cull(Frame &frame);
+
+    struct FrameInFlight
+    {
+        Frame m_frame{};
+        std::atomic<bool> m_is_complete{};
+    };
+
+    // Shared with the job, so that the frame outlives it.
+    std::shared_ptr<FrameInFlight> m_frame_in_flight{};
+
+    Frame m_completed_frame{};
+    u64 m_number_of_completed_frames{};
+};
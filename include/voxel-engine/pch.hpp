@@ -6,6 +6,9 @@ constexpr bool VX_DEBUG_MODE = true;
 constexpr bool VX_DEBUG_MODE = false;
 #endif
 
+// Only the renderer and the application (window, shader compiler, ...) depend on Windows and D3D12. The chunk pipeline
+// is portable (see gpu_backend.hpp).
+#if defined(_WIN32)
 // Windows includes.
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
@@ -18,6 +21,7 @@ constexpr bool VX_DEBUG_MODE = false;
 // Shader compiler related headers.
 #include <d3d12shader.h>
 #include <dxcapi.h>
+#endif
 
 // Simd - math library.
 #include <DirectXMath.h>
@@ -27,17 +31,31 @@ constexpr bool VX_DEBUG_MODE = false;
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <functional>
 #include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <random>
 #include <set>
 #include <source_location>
+#include <span>
 #include <stack>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
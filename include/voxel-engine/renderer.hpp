@@ -1,31 +1,6 @@
 #pragma once
 
-struct StructuredBuffer
-{
-    Microsoft::WRL::ComPtr<ID3D12Resource> resource{};
-    size_t srv_index{};
-};
-
-struct ConstantBuffer
-{
-    Microsoft::WRL::ComPtr<ID3D12Resource> resource{};
-    size_t cbv_index{};
-    size_t size_in_bytes{};
-
-    u8 *resource_mapped_ptr{};
-
-    inline void update(const void *data) const
-    {
-        memcpy(resource_mapped_ptr, data, size_in_bytes);
-    }
-};
-
-struct IndexBuffer
-{
-    Microsoft::WRL::ComPtr<ID3D12Resource> resource{};
-    size_t indices_count{};
-    D3D12_INDEX_BUFFER_VIEW index_buffer_view{};
-};
+#include "voxel-engine/gpu_backend.hpp"
 
 // The command buffer is a bit different. It internally has two resources, a default and upload heap.
 // the update function is not similar to constant buffer, as here data is copied from the upload to default resource.
@@ -43,7 +18,7 @@ struct CommandBuffer
 };
 
 // A simple & straight forward high level renderer abstraction.
-struct Renderer
+struct Renderer final : public GpuBackend
 {
     // Nested struct definitions.
   private:
@@ -73,38 +48,35 @@ struct Renderer
   public:
     explicit Renderer(const HWND window_handle, const u16 window_width, const u16 window_height);
 
-    // Resource creation functions.
-    // The functions return a buffer and intermediate resource (which can be discarded once the CopyResource operation
-    // is complete).
-    struct IndexBufferWithIntermediateResource
-    {
-        IndexBuffer index_buffer;
-        Microsoft::WRL::ComPtr<ID3D12Resource> intermediate_resource;
-    };
-
+    // Resource creation functions (see GpuBackend).
     IndexBufferWithIntermediateResource create_index_buffer(const void *data, const size_t stride,
                                                             const size_t indices_count,
-                                                            const std::wstring_view buffer_name);
-
-    struct StucturedBufferWithIntermediateResource
-    {
-        StructuredBuffer structured_buffer;
-        Microsoft::WRL::ComPtr<ID3D12Resource> intermediate_resource;
-    };
+                                                            const std::wstring_view buffer_name) override;
 
     StucturedBufferWithIntermediateResource create_structured_buffer(const void *data, const size_t stride,
                                                                      const size_t num_elements,
-                                                                     const std::wstring_view buffer_name);
+                                                                     const std::wstring_view buffer_name) override;
 
     CommandBuffer create_command_buffer(const size_t stride, const size_t max_number_of_elements,
                                         const std::wstring_view buffer_name);
 
-    ConstantBuffer internal_create_constant_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name);
+    ConstantBuffer create_constant_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name) override;
 
     template <size_t T>
     std::array<ConstantBuffer, T> create_constant_buffer(const size_t size_in_bytes,
                                                          const std::wstring_view buffer_name);
 
+    UploadBuffer create_upload_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name) override;
+
+    void copy_buffer_region(const GpuResource &destination, const size_t destination_offset,
+                            const UploadBuffer &source, const size_t source_offset,
+                            const size_t size_in_bytes) override;
+
+    u64 get_last_copy_queue_fence_value() const override;
+    u64 get_completed_copy_queue_fence_value() const override;
+
+    void flush_copy_queue() override;
+
   private:
     // This function automatically offset's the current descriptor handle of descriptor heap.
     size_t create_constant_buffer_view(ID3D12Resource *const resource, size_t size);
@@ -143,7 +115,7 @@ struct Renderer
     Microsoft::WRL::ComPtr<ID3D12RootSignature> m_bindless_root_signature{};
 
     // Mutex used for resource creation.
-    std::mutex m_resource_mutex{};
+    mutable std::mutex m_resource_mutex{};
 
     // Command queue abstraction that holds the queue, allocators, command list and sync primitives.
     // Each queue type has its own struct since they operate in different ways (copy queue is async and requires thread
@@ -205,8 +177,7 @@ inline std::array<ConstantBuffer, T> Renderer::create_constant_buffer(const size
     std::array<ConstantBuffer, T> constant_buffers{};
     for (size_t i = 0; i < T; i++)
     {
-        constant_buffers[i] =
-            internal_create_constant_buffer(size_in_bytes, std::wstring(buffer_name) + std::to_wstring(i));
+        constant_buffers[i] = create_constant_buffer(size_in_bytes, std::wstring(buffer_name) + std::to_wstring(i));
     }
 
     return constant_buffers;
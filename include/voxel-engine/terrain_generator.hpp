@@ -0,0 +1,65 @@
+#pragma once
+
+#include "voxel-engine/chunk.hpp"
+#include "voxel-engine/noise.hpp"
+
+// Determines how the occupancy of a chunk is generated.
+enum class TerrainPreset : u8
+{
+    // 2D fbm noise gives the height of the terrain surface for each (x, z) column.
+    Heightmap,
+    // 3D fbm noise is added to a vertical gradient, which gives overhangs and caves around the surface.
+    Density,
+};
+
+struct TerrainSettings
+{
+    u32 m_seed{1337u};
+
+    // Height (in voxels, from the bottom of the chunk grid) around which the terrain surface lies.
+    u32 m_base_height{};
+
+    // Maximum distance (in voxels) of the terrain surface from the base height.
+    float m_height_amplitude{24.0f};
+
+    Noise::FbmSettings m_fbm_settings{};
+};
+
+// Surface height (in voxels) of each column of voxels in a column of chunks (i.e all chunks with the same chunk x and z
+// index), indexed as x + z * N. Shared by all chunks of the column, see HeightmapColumnCache.
+template <u32 N>
+struct BasicHeightmapColumn
+{
+    std::array<float, N * N> m_heights{};
+};
+
+using HeightmapColumn = BasicHeightmapColumn<CHUNK_DIMENSION>;
+
+// The naming convention of namespaces is being broken here, mostly because this "namespace" is a smart way of
+// simulating static class behaviour.
+// Noise is sampled in world voxel coordinates with the world seed, so the terrain is continuous across chunks, and the
+// generated chunk only depends on the settings and the chunk index.
+// The generators are explicitly instantiated (in terrain_generator.cpp) for the same chunk dimensions as BasicChunk.
+namespace TerrainGenerator
+{
+// Seed for anything that is random per chunk (rather than per world position).
+u32 get_chunk_seed(const u32 world_seed, const size_t chunk_index);
+
+// The 2D noise of the heightmap preset is evaluated once per column of chunks, the chunks then only compare against it.
+template <u32 N>
+void generate_heightmap_column(const TerrainSettings &terrain_settings, const u32 chunk_x, const u32 chunk_z,
+                               BasicHeightmapColumn<N> &heightmap_column);
+template <u32 N>
+void generate_heightmap(const TerrainSettings &terrain_settings, const DirectX::XMUINT3 chunk_index_3d,
+                        const BasicHeightmapColumn<N> &heightmap_column, BasicChunk<N> &chunk);
+
+template <u32 N>
+void generate_density(const TerrainSettings &terrain_settings, const DirectX::XMUINT3 chunk_index_3d,
+                      BasicChunk<N> &chunk);
+
+// If heightmap column is null, it is generated when required.
+template <u32 N>
+void generate(const TerrainPreset terrain_preset, const TerrainSettings &terrain_settings,
+              const DirectX::XMUINT3 chunk_index_3d, const BasicHeightmapColumn<N> *const heightmap_column,
+              BasicChunk<N> &chunk);
+} // namespace TerrainGenerator
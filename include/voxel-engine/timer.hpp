@@ -3,7 +3,7 @@
 class Timer
 {
   public:
-    explicit Timer();
+    explicit Timer() = default;
 
     void start();
     void stop();
@@ -11,9 +11,6 @@ class Timer
     float get_delta_time() const;
 
   private:
-    LARGE_INTEGER m_performance_frequency{};
-    float m_seconds_per_count{};
-
-    LARGE_INTEGER m_start_time{};
-    LARGE_INTEGER m_end_time{};
+    std::chrono::steady_clock::time_point m_start_time{};
+    std::chrono::steady_clock::time_point m_end_time{};
 };
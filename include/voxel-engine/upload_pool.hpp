@@ -0,0 +1,85 @@
+#pragma once
+
+#include "voxel-engine/gpu_backend.hpp"
+
+// A range of a page of an upload pool (see UploadPool). The upload buffer is the one of the whole page, so that it
+// can be copied from with the offset of the range.
+struct UploadAllocation
+{
+    UploadBuffer m_upload_buffer{};
+    u32 m_page_index{};
+    size_t m_offset{};
+    size_t m_size_in_bytes{};
+
+    inline bool is_valid() const
+    {
+        return m_size_in_bytes != 0u;
+    }
+
+    inline u8 *get_mapped_ptr() const
+    {
+        return m_upload_buffer.resource_mapped_ptr + m_offset;
+    }
+};
+
+// A thread safe pool of upload buffer memory, used for data that is written by worker threads and then copied into
+// GPU buffers on the copy queue (such as the meshes of the chunks).
+// Pages are large upload buffers that are created once and kept for the lifetime of the pool, so that a mesh costs a
+// range of a page rather than a committed resource of its own. Pages are sub-allocated in ranges just like the pages of
+// the regions (first fit, and freed ranges are merged with their neighbors), so ranges that are freed out of order
+// are re-used right away. A range must only be freed once the copy queue is done with it.
+// If none of the pages has room, a new page is created.
+struct UploadPool
+{
+    explicit UploadPool(const size_t page_size = DEFAULT_PAGE_SIZE);
+
+    UploadPool(const UploadPool &other) = delete;
+    UploadPool &operator=(const UploadPool &other) = delete;
+
+    // Ranges are aligned so that the data written into them can be read as floats (or 32 bit indices).
+    static constexpr size_t ALIGNMENT = 16u;
+
+    // Room for the meshes of a few dozen chunks that wait for their copy.
+    static constexpr size_t DEFAULT_PAGE_SIZE = 128u * 1024u;
+
+    // The contents of the returned range are undefined. Size must not be zero.
+    UploadAllocation allocate(GpuBackend &gpu_backend, const size_t size_in_bytes);
+    void free(const UploadAllocation &allocation);
+
+    struct Statistics
+    {
+        // Number of ranges handed out, and the number of pages that were created for them.
+        u64 m_number_of_allocations{};
+        u64 m_number_of_page_allocations{};
+
+        size_t m_size_in_bytes_in_use{};
+        size_t m_peak_size_in_bytes_in_use{};
+
+        size_t m_reserved_size_in_bytes{};
+    };
+
+    Statistics get_statistics() const;
+
+    // A free range of bytes of a page.
+    struct Range
+    {
+        size_t m_offset{};
+        size_t m_size_in_bytes{};
+    };
+
+    struct Page
+    {
+        UploadBuffer m_upload_buffer{};
+
+        // Sorted by offset.
+        std::vector<Range> m_free_ranges{};
+    };
+
+    size_t m_page_size{};
+
+    std::vector<Page> m_pages{};
+
+    Statistics m_statistics{};
+
+    mutable std::mutex m_mutex{};
+};
@@ -1,122 +1,455 @@
 #pragma once
 
-#include "include/BS_thread_pool.hpp"
-#include "voxel-engine/renderer.hpp"
+#include "voxel-engine/cave_culling.hpp"
+#include "voxel-engine/chunk.hpp"
+#include "voxel-engine/chunk_grid.hpp"
+#include "voxel-engine/chunk_indirect_command_array.hpp"
+#include "voxel-engine/chunk_load_scheduler.hpp"
+#include "voxel-engine/chunk_mesher.hpp"
+#include "voxel-engine/chunk_octree.hpp"
+#include "voxel-engine/chunk_region.hpp"
+#include "voxel-engine/gpu_backend.hpp"
+#include "voxel-engine/heightmap_column_cache.hpp"
+#include "voxel-engine/job_system.hpp"
+#include "voxel-engine/mpsc_queue.hpp"
+#include "voxel-engine/occlusion_culling.hpp"
+#include "voxel-engine/terrain_generator.hpp"
+#include "voxel-engine/upload_pool.hpp"
 
-// A voxel is just a value on a regular 3D grid. Think of it as the corners where the cells meet in a 3d grid.
-// For 3d visualization of voxels, A cube is rendered for each voxel where the front lower left corner is the 'voxel
-// position' and has a edge length as specified in the class below.
-struct Voxel
+// A class that contains a collection of chunks and associated data.
+// The states a chunk can be in:
+// (i) Loaded -> Ready to be rendered.
+// (ii) Setup -> Chunk mesh is ready, but its range of the region buffers may or maynot be uploaded yet. Once it is,
+// these chunks are moved into the loaded chunk grid.
+// Chunks are setup by worker threads, which push them into a completion queue once they are done. The main thread loads
+// them in the order in which they completed, so a chunk that is slow to setup does not hold back the others.
+// Setup is cancelled for chunks that the player has moved away from in the meantime (see set_view).
+// Loaded chunks are evicted once they are out of unload distance, or when the memory budget is exceeded (see
+// evict_chunks). Their range of the region buffers (see ChunkRegions) is only freed once the GPU is done with it.
+struct ChunkManager
 {
-    static constexpr u32 EDGE_LENGTH{640 * 8u};
-    bool m_active{true};
-};
+    // Constructor creates the shared position buffer.
+    // The chunk manager does not depend on the graphics API : buffers are created through the GPU backend, which is
+    // either the D3D12 renderer or the null backend (when running headless).
+    // If the number of worker threads is zero, it is determined by the job system.
+    explicit ChunkManager(GpuBackend &gpu_backend, const u32 number_of_worker_threads = 0u);
 
-struct Chunk
-{
-    explicit Chunk();
+    struct SetupChunkData
+    {
+        Chunk m_chunk{};
 
-    Chunk(const Chunk &other) = delete;
-    Chunk &operator=(Chunk &other) = delete;
+        // The worker thread writes the indices (in the index format of the regions, see ChunkRegions::encode_index)
+        // and then the colors of the mesh into a range of the mesh upload pool. The main thread allocates a range of
+        // the region buffers for the mesh once the chunk is done, and copies the mesh into it (see
+        // transfer_chunks_from_setup_to_loaded_state).
+        UploadAllocation m_mesh_upload_allocation{};
+        ChunkRegionAllocation m_region_allocation{};
 
-    Chunk(Chunk &&other) noexcept;
-    Chunk &operator=(Chunk &&other) noexcept;
+        // The mesh itself is only kept (in the scratch mesh of the worker thread) until the upload range is written.
+        u64 m_number_of_triangles{};
+        FaceDirectionIndexRanges m_face_direction_index_ranges{};
 
-    ~Chunk();
+        // Computed for every chunk, including the uniform chunks that skip meshing.
+        CaveCulling::FaceConnectivity m_face_connectivity{};
 
-    static constexpr u32 NUMBER_OF_VOXELS_PER_DIMENSION = 8u;
-    static constexpr size_t NUMBER_OF_VOXELS =
-        NUMBER_OF_VOXELS_PER_DIMENSION * NUMBER_OF_VOXELS_PER_DIMENSION * NUMBER_OF_VOXELS_PER_DIMENSION;
+        // The range of the region buffers is ready once the copy queue has reached this fence value.
+        u64 m_copy_queue_fence_value{};
 
-    static constexpr u32 CHUNK_LENGTH = Voxel::EDGE_LENGTH * Chunk::NUMBER_OF_VOXELS_PER_DIMENSION;
+        MeshingMode m_meshing_mode{};
+        float m_meshing_time_us{};
 
-    // A flattened 3d array of Voxels.
-    Voxel *m_voxels{};
-    size_t m_chunk_index{};
-};
+        // Level of detail the chunk was meshed at (see get_chunk_lod).
+        u32 m_lod{};
 
-// A class that contains a collection of chunks and associated data.
-// The states a chunk can be in:
-// (i) Loaded -> Ready to be rendered.
-// (ii) Setup -> Chunk mesh is ready, but associated buffers may or maynot be ready. Once the buffers are ready, these
-// chunks are moved into the loaded chunks hashmap.
-struct ChunkManager
-{
-    // Constructor creates the shared position buffer.
-    explicit ChunkManager(Renderer &renderer);
+        // Not set for uniform chunks that skipped meshing.
+        bool m_is_meshed{};
 
-    struct SetupChunkData
+        // Re-meshed chunks are not generated again.
+        bool m_is_generated{};
+        TerrainPreset m_terrain_preset{};
+        float m_generation_time_us{};
+        bool m_is_heightmap_column_generated{};
+    };
+
+    // Per meshing mode statistics, so that the meshers can be compared.
+    struct MeshingStatistics
+    {
+        u64 m_number_of_chunks_meshed{};
+        u64 m_number_of_triangles{};
+        float m_total_meshing_time_us{};
+    };
+
+    // Per terrain preset statistics, so that the generation throughput can be measured independently of meshing.
+    struct GenerationStatistics
+    {
+        u64 m_number_of_chunks_generated{};
+        u64 m_number_of_voxels_generated{};
+        float m_total_generation_time_us{};
+
+        // Only used by the heightmap preset. Chunks generated - columns generated is the number of times the 2D noise
+        // of a column was re-used.
+        u64 m_number_of_heightmap_columns_generated{};
+    };
+
+    // Range of the region buffers of a chunk that has been re-meshed or unloaded. It can only be freed once the direct
+    // queue has finished executing all the frames that may reference it.
+    // The range of a chunk whose setup was cancelled was never used by the direct queue, but may still be uploaded : it
+    // (and the upload range of the mesh) can only be released once the copy queue is done with it.
+    // Each retired chunk buffers only waits for one of the queues, so they are kept in one queue per fence.
+    struct RetiredChunkBuffers
+    {
+        // Value of the fence of the queue the buffers are retired on.
+        u64 m_fence_value{};
+
+        // May be invalid, if the setup of the chunk was cancelled before the range was allocated.
+        ChunkRegionAllocation m_region_allocation{};
+        UploadAllocation m_mesh_upload_allocation{};
+    };
+
+    // A loaded chunk and its range of the region buffers. Chunks with no visible faces have no range.
+    struct LoadedChunk
     {
         Chunk m_chunk{};
 
-        Renderer::IndexBufferWithIntermediateResource m_chunk_index_buffer{};
-        Renderer::StucturedBufferWithIntermediateResource m_chunk_color_buffer{};
+        ChunkRegionAllocation m_region_allocation{};
+
+        // The indices of the chunk mesh are grouped by face direction.
+        FaceDirectionIndexRanges m_face_direction_index_ranges{};
 
-        // A strange design decision, but rather than accessing the render resources via root constants, render
-        // resources will now be embedded into the chunk constant buffer.
-        // This is done to make the indirect rendering & GPU culling process simpler.
-        ConstantBuffer m_chunk_constant_buffer{};
+        // Handle of the indirect command of the chunk in m_chunk_indirect_commands, if the chunk has a range.
+        u32 m_indirect_command_handle{ChunkIndirectCommandArray::INVALID_HANDLE};
 
-        std::vector<u16> m_chunk_indices_data{};
-        std::vector<DirectX::XMFLOAT3> m_chunk_color_data{};
+        CaveCulling::FaceConnectivity m_face_connectivity{};
+
+        u32 m_lod{};
+    };
+
+    // A loaded chunk that is out of render distance, and its distance (see get_chunk_distance_to_view).
+    struct EvictionCandidate
+    {
+        u32 m_distance{};
+        size_t m_chunk_index{};
     };
 
   private:
     // internal_mt : Internal multithreaded.
-    SetupChunkData internal_mt_setup_chunk(Renderer &renderer, const size_t index);
+    // Once the cancellation token is cancelled, the remaining stages are skipped (the chunk is discarded by the main
+    // thread).
+    void internal_mt_generate_chunk(SetupChunkData &setup_chunk_data, const size_t index,
+                                    const TerrainPreset terrain_preset, const TerrainSettings &terrain_settings,
+                                    const std::shared_ptr<HeightmapColumnCache::Entry> &heightmap_column,
+                                    const CancellationToken &cancellation_token);
+    SetupChunkData internal_mt_remesh_chunk(GpuBackend &gpu_backend, Chunk &&chunk, const MeshingMode meshing_mode,
+                                            const u32 lod, const ChunkNeighborApron &apron,
+                                            const CancellationToken &cancellation_token);
+
+    // Meshes the chunk in setup chunk data (at the given level of detail) and writes the mesh into a range of the mesh
+    // upload pool.
+    // Levels of detail other than 0 always use the downsampled binary greedy mesher, whatever the meshing mode.
+    void internal_mt_mesh_chunk(GpuBackend &gpu_backend, SetupChunkData &setup_chunk_data,
+                                const MeshingMode meshing_mode, const u32 lod, const ChunkNeighborApron &apron,
+                                const CancellationToken &cancellation_token);
+
+    // Moves the range of the region buffers of a chunk (if any) into the retired chunk buffers queue.
+    void retire_chunk_buffers(const size_t chunk_index, const u64 direct_queue_fence_value);
+
+    // Moves a chunk that has been setup (and whose range of the region buffers is ready) into the loaded chunks.
+    void load_setup_chunk(SetupChunkData &&setup_chunk_data, const u64 direct_queue_fence_value);
+
+    // The chunk is no longer being setup. If it is not loaded, the reference to its heightmap column is released too.
+    void remove_chunk_from_setup(const size_t chunk_index);
+
+    // Returns false if the chunk is too far from the player for its setup to be worth completing.
+    bool is_chunk_in_setup_range(const size_t chunk_index) const;
+
+    // Distance (in chunks, along the axis where it is largest) between the chunk and the chunk the player is in. Must
+    // only be called once the view has been set.
+    u32 get_chunk_distance_to_view(const size_t chunk_index) const;
+
+    static u32 get_chunk_distance(const size_t chunk_index, const DirectX::XMINT3 center_chunk_index_3d);
+
+    // Level of detail a chunk should be meshed at, from its distance to center (see CHUNK_LOD_DISTANCES).
+    static u32 get_chunk_lod(const size_t chunk_index, const DirectX::XMINT3 center_chunk_index_3d);
+
+    // Level of detail from the chunk the player is in. Full resolution until the view has been set.
+    u32 get_chunk_lod_from_view(const size_t chunk_index) const;
+
+    // Adds a loaded chunk to the re-mesh queue. The chunk keeps its current mesh until the new one is loaded.
+    void add_chunk_to_remesh_queue(const size_t chunk_index);
+
+    // Re-meshes a loaded chunk if it was meshed at another level of detail than the one it should have from center.
+    // Chunks that are already waiting for a re-mesh are checked again once it is loaded.
+    void remesh_chunk_if_lod_changed(const size_t chunk_index, const DirectX::XMINT3 center_chunk_index_3d);
+
+    // Adds the loaded chunks that are out of render distance from center to the eviction candidates. Only required when
+    // the chunks that left render distance are not known, i.e when chunks are added around the player for the first
+    // time.
+    void gather_eviction_candidates(const DirectX::XMINT3 center);
+
+    // Updates the flags of a loaded chunk in the chunk octree, from its occupancy state, whether it has an indirect
+    // command and whether it is being re-meshed. Should be called whenever any of these changes.
+    void update_chunk_octree_flags(const size_t chunk_index);
+
+    // Capture the boundary slabs of all loaded neighbors of a chunk.
+    ChunkNeighborApron capture_neighbor_apron(const size_t chunk_index) const;
+
+    // When a chunk is loaded, border faces of the chunk and its loaded neighbors that were meshed without knowing about
+    // each other have to be re-resolved. Chunks for which this changes the mesh are added to the re-mesh queue.
+    void resolve_neighbor_borders(const size_t chunk_index);
 
   public:
-    void add_chunk_to_setup_stack(const size_t chunk_index);
-    void create_chunks_from_setup_stack(Renderer &renderer);
+    // The chunk is setup once the chunk load scheduler decides it is its turn.
+    void add_chunk_to_setup_queue(const size_t chunk_index);
+
+    // Adds the chunks within render distance of the player to the setup queue. The required chunks are only recomputed
+    // when the player moves to another chunk, and then only the slab of chunks that entered render distance is added.
+    // Loaded chunks in the slab that left render distance become eviction candidates, and the chunks waiting to be
+    // setup that are now out of setup range are dropped. Likewise, only the loaded chunks in the slabs that crossed one
+    // of the level of detail distances are re-meshed.
+    // Should be called each frame, before set_view. Reset m_player_chunk_index_3d if it was not called for a while, so
+    // that every chunk around the player is added again.
+    void add_chunks_around_player_to_setup_queue(const DirectX::XMUINT3 player_chunk_index_3d);
+
+    // Re-prioritizes the chunks waiting to be setup, and drops the ones that do not fit in the chunk load scheduler.
+    // The setup of chunks that are out of setup range from the new view is cancelled.
+    // Should be called each frame, before chunks are created.
+    void set_view(const ChunkLoadScheduler::View &view);
+
+    // Unloads a loaded chunk. The buffers of the chunk are retired, just like the buffers replaced by a re-mesh.
+    // Returns false if the chunk is being setup (or re-meshed), in which case it cannot be unloaded yet.
+    bool unload_chunk(const size_t chunk_index, const u64 direct_queue_fence_value);
+    void create_chunks_from_setup_queue(GpuBackend &gpu_backend);
+
+    // The meshes of the chunks that are done are copied into the region buffers, and the chunks are loaded once the
+    // copy is complete.
+    // The direct queue fence value is the last value the direct queue has signalled. Ranges replaced by a re-mesh are
+    // retired with this value.
+    void transfer_chunks_from_setup_to_loaded_state(GpuBackend &gpu_backend, const u64 current_copy_queue_fence_value,
+                                                    const u64 direct_queue_fence_value);
+
+    // Unloads up to CHUNKS_TO_UNLOAD_PER_FRAME chunks, furthest first : all chunks that are out of unload distance,
+    // and, while the memory budget is exceeded, chunks that are out of render distance. Returns the number of chunks
+    // that were unloaded.
+    // Chunks within render distance are never evicted, so the budget must be large enough for them.
+    size_t evict_chunks(const u64 direct_queue_fence_value);
+
+    // Releases up to NUMBER_OF_RETIRED_CHUNK_BUFFERS_TO_RELEASE_PER_FRAME retired ranges, as releasing API resources
+    // (the pages of the regions once they are empty) is slow enough to cause frame spikes when many chunks are
+    // unloaded at once. Ranges that wait for the copy queue are not held back by the ranges that wait
+    // for the direct queue, and the other way around.
+    void release_retired_chunk_buffers(const u64 completed_copy_queue_fence_value,
+                                       const u64 completed_direct_queue_fence_value);
+
+    // Voxel data of the loaded chunks, and the GPU buffers that have not been released yet (the GPU memory used by
+    // the meshes, i.e the pages of the regions and of the mesh upload pool).
+    u64 get_memory_usage_in_bytes() const;
+
+    // Picks up the result of the last occlusion culling frame if it has completed, and submits a new one otherwise
+    // (see OcclusionCuller) : the chunks with an indirect command are tested against the loaded chunks that are
+    // entirely full, nearest to the camera first. Should be called each frame, with the same view projection matrix as
+    // frustum culling (see FrustumCulling::create_frustum).
+    void update_occlusion_culling(const DirectX::XMFLOAT4X4 &view_projection_matrix,
+                                  const DirectX::XMFLOAT3 camera_position, const float near_plane);
+
+    // Searches the chunks that can be seen from the chunk the camera is in (see CaveCulling::PotentiallyVisibleSet),
+    // within unload distance. The search only runs again once the camera has moved to another chunk, or chunks with
+    // different face connectivity have been loaded (or unloaded), e.g after a re-mesh. Should be called each frame.
+    void update_cave_culling(const DirectX::XMUINT3 camera_chunk_index_3d);
+
+    // Chunks that are not loaded are all connected, as their voxels are not known.
+    CaveCulling::FaceConnectivity get_face_connectivity(const size_t chunk_index) const;
+
+    bool is_chunk_potentially_visible(const size_t chunk_index) const;
+
+    // Writes the indices (into m_chunk_indirect_commands) of the commands whose chunk is (possibly) inside of the
+    // frustum into visible_command_indices, which must have room for m_chunk_indirect_commands.size() indices, and
+    // returns how many were written. Same result as FrustumCulling::cull_chunks over all of the commands, but whole
+    // nodes of the chunk octree are accepted or rejected at once.
+    size_t cull_chunks_hierarchical(const FrustumCulling::Frustum &frustum, u32 *const visible_command_indices);
 
-    void transfer_chunks_from_setup_to_loaded_state(const u64 current_copy_queue_fence_value);
+    // Returns the index of the neighboring chunk in the given direction, if it is inside the chunk grid.
+    static std::optional<size_t> get_neighbor_chunk_index(const size_t chunk_index,
+                                                          const FaceDirection face_direction);
 
     static constexpr u32 NUMBER_OF_CHUNKS_PER_DIMENSION = 2048u;
     static constexpr size_t NUMBER_OF_CHUNKS =
         NUMBER_OF_CHUNKS_PER_DIMENSION * NUMBER_OF_CHUNKS_PER_DIMENSION * NUMBER_OF_CHUNKS_PER_DIMENSION;
 
     // Determines how many chunks are loaded around the player.
-    static constexpr u32 CHUNKS_LOADED_AROUND_PLAYER = 6u;
+    static constexpr u32 CHUNKS_LOADED_AROUND_PLAYER = 10u;
 
     // Determines how many chunks are deleted per frame.
     static constexpr u32 CHUNKS_TO_UNLOAD_PER_FRAME = 64u * 4u;
 
+    static constexpr u32 NUMBER_OF_RETIRED_CHUNK_BUFFERS_TO_RELEASE_PER_FRAME = 64u;
+
     // Determine how many chunks can be loaded at once. If a chunk is to be loaded and loaded chunks is already at the
     // limit, re-use of memory happens.
     static constexpr u32 CHUNK_RENDER_DISTANCE = CHUNKS_LOADED_AROUND_PLAYER;
 
+    // Chunks further than this (in chunks, along any axis) from the player are not setup. The margin past the render
+    // distance avoids cancelling chunks back and forth while the player moves along a chunk border.
+    static constexpr u32 CHUNK_SETUP_CANCELLATION_DISTANCE = CHUNK_RENDER_DISTANCE + 1u;
+
+    // Chunks further than CHUNK_LOD_DISTANCES[l] (in chunks, along the axis where the distance is largest) from the
+    // player are meshed at level of detail l + 1, or coarser if they are also further than the next distances.
+    static constexpr std::array<u32, NUMBER_OF_CHUNK_LODS - 1u> CHUNK_LOD_DISTANCES = {2u, 4u, 8u};
+
+    // Loaded chunks further than this from the player are unloaded. Chunks between the render and unload distance stay
+    // loaded (unless the memory budget is exceeded), so that moving back and forth does not reload them.
+    static constexpr u32 CHUNK_UNLOAD_DISTANCE = CHUNK_RENDER_DISTANCE + 2u;
+    static_assert(CHUNK_UNLOAD_DISTANCE >= CHUNK_SETUP_CANCELLATION_DISTANCE,
+                  "Chunks that are setup must not be unloaded as soon as they are loaded");
+
+    // Loaded chunks live in a toroidal grid around the player that spans the unload distance on both sides. A chunk
+    // that is loaded into a slot still held by a chunk the player has moved away from evicts it.
+    static constexpr u32 NUMBER_OF_LOADED_CHUNK_SLOTS_PER_DIMENSION = 2u * CHUNK_UNLOAD_DISTANCE + 1u;
+    using LoadedChunkGrid =
+        ChunkGrid<LoadedChunk, NUMBER_OF_LOADED_CHUNK_SLOTS_PER_DIMENSION, NUMBER_OF_CHUNKS_PER_DIMENSION>;
+
+    static constexpr u64 DEFAULT_MEMORY_BUDGET_IN_BYTES = 1024ull * 1024ull * 1024ull;
+
+    // Occluders further than the nearest ones rarely cover anything that the nearest ones do not.
+    static constexpr u32 MAX_NUMBER_OF_OCCLUDERS = 1024u;
+
     // Chunks to create per frame : How many chunks are setup (i.e the meshing processes occurs).
     static constexpr u32 NUMBER_OF_CHUNKS_TO_CREATE_PER_FRAME = 16u;
 
-    // Chunks to load per frame : How many setup chunks are moved into the loaded chunk hash map.
+    // Bound of the chunk load scheduler, enough for the chunks in render distance twice over.
+    static constexpr u32 MAX_NUMBER_OF_CHUNKS_WAITING_FOR_SETUP =
+        2u * (2u * CHUNK_RENDER_DISTANCE + 1u) * (2u * CHUNK_RENDER_DISTANCE + 1u) * (2u * CHUNK_RENDER_DISTANCE + 1u);
+
+    // Chunks are only added once, when they enter render distance, so the scheduler must never drop chunks that are
+    // still required. Chunks out of setup range are removed from it as soon as the player moves, so it holds at most
+    // the chunks in setup range.
+    static_assert(MAX_NUMBER_OF_CHUNKS_WAITING_FOR_SETUP >= (2u * CHUNK_SETUP_CANCELLATION_DISTANCE + 1u) *
+                                                                (2u * CHUNK_SETUP_CANCELLATION_DISTANCE + 1u) *
+                                                                (2u * CHUNK_SETUP_CANCELLATION_DISTANCE + 1u),
+                  "The chunk load scheduler must be able to hold all chunks in setup range");
+
+    // Chunks to load per frame : How many setup chunks are moved into the loaded chunk grid.
     static constexpr u32 NUMBER_OF_CHUNKS_TO_LOAD_PER_FRAME = 64u;
 
-    std::unordered_map<size_t, Chunk> m_loaded_chunks{};
+    // Meshing mode used for chunks that are setup from now on. Chunks that are already loaded are not re-meshed, unless
+    // a neighbor requires it.
+    MeshingMode m_meshing_mode{MeshingMode::BinaryGreedy};
+
+    std::array<MeshingStatistics, 2u> m_meshing_statistics{};
+
+    // Terrain preset and settings used for chunks that are setup from now on.
+    TerrainPreset m_terrain_preset{TerrainPreset::Heightmap};
+    TerrainSettings m_terrain_settings{
+        .m_base_height = NUMBER_OF_CHUNKS_PER_DIMENSION * Chunk::NUMBER_OF_VOXELS_PER_DIMENSION / 2u,
+    };
+
+    std::array<GenerationStatistics, 2u> m_generation_statistics{};
+
+    // Each chunk that is being setup or is loaded holds a reference to its heightmap column.
+    // note : The cached columns are not invalidated if the terrain settings change.
+    HeightmapColumnCache m_heightmap_column_cache{};
+
+    // Total number of triangles across all loaded chunks.
+    u64 m_number_of_loaded_triangles{};
+
+    // Re-meshes of loaded chunks whose level of detail changed as the player moved.
+    u64 m_number_of_lod_remeshes{};
+
+    // Indexed by OccupancyState.
+    std::array<u64, NUMBER_OF_OCCUPANCY_STATES> m_number_of_loaded_chunks_per_occupancy_state{};
+
+    // Occupancy and block type data owned by the loaded chunks.
+    u64 m_loaded_voxel_data_size_in_bytes{};
+
+    // Upload ranges of the meshes that wait for their copy (or of the cancelled chunks that wait for the copy queue).
+    // Worker threads allocate from it, and the main thread frees the ranges once the copy queue is done with them.
+    UploadPool m_mesh_upload_pool{};
+
+    // See get_memory_usage_in_bytes.
+    u64 m_memory_budget_in_bytes{DEFAULT_MEMORY_BUDGET_IN_BYTES};
+
+    // Number of times the scratch mesh of a worker thread had to grow. Together with the voxel data pool statistics
+    // (see Chunk::get_voxel_data_pool_statistics), this stops increasing once streaming reaches a steady state.
+    std::atomic<u64> m_number_of_scratch_mesh_allocations{};
+
+    // Chunks (and re-meshes) whose setup was cancelled, be it before or after they were submitted.
+    u64 m_number_of_cancelled_setup_chunks{};
+
+    // Chunks unloaded by evict_chunks, or evicted from their slot by a chunk that is loaded into it.
+    u64 m_number_of_unloaded_chunks{};
+
+    LoadedChunkGrid m_loaded_chunks{};
 
     // NOTE : Chunks are considered to be setup when :
-    // (i) The result of async call (i.e the future) is ready,
-    // (ii) The fence value is < the current copy queue fence value.
-    // The setup chunks future stack consist of pairs of fence values , futures.
-    std::queue<std::pair<u64, std::future<SetupChunkData>>> m_setup_chunk_futures_queue{};
+    // (i) The worker thread has pushed the chunk into the completion queue,
+    // (ii) The fence value of the copy of its mesh into the region buffers is <= the current copy queue fence value.
+    // Worker threads push into the completion queue, and each frame the main thread moves its contents into the
+    // completed setup chunks, where chunks wait for their buffers.
+    MpscQueue<SetupChunkData> m_setup_chunk_completion_queue{};
+    std::deque<SetupChunkData> m_completed_setup_chunks{};
 
-    // Why is there also a stack?
-    // Use the stack to store chunk indices that at any given point in time are close to the player.
-    // Then, each from from this stack, add elements into the queue.
-    std::stack<size_t> m_chunks_to_setup_stack{};
+    // Chunks that are close to the player and are waiting to be setup. Each frame, the chunks with the highest priority
+    // are submitted to the job system.
+    ChunkLoadScheduler m_chunk_load_scheduler{MAX_NUMBER_OF_CHUNKS_WAITING_FOR_SETUP};
 
     // A unordered set to keep track of chunks that are currently in process of being setup.
     // This is required in case create_chunk is called for a chunk that is being setup but not loaded. We do not want to
     // load this chunk again.
+    // Loaded chunks that are waiting to be (or are being) re-meshed are also part of this set.
     std::unordered_set<size_t> m_chunk_indices_that_are_being_setup{};
 
-    std::unordered_map<size_t, IndexBuffer> m_chunk_index_buffers{};
-    std::unordered_map<size_t, StructuredBuffer> m_chunk_color_buffers{};
-    std::unordered_map<size_t, ConstantBuffer> m_chunk_constant_buffers{};
+    // Tokens of the chunks (and re-meshes) that have been submitted to the job system, until they are loaded or
+    // discarded.
+    std::unordered_map<size_t, CancellationToken> m_setup_chunk_cancellation_tokens{};
+
+    // Chunk the player is in, as of the last call to set_view. Until then, no setup is cancelled.
+    std::optional<DirectX::XMINT3> m_view_chunk_index_3d{};
+
+    // Chunk the player is in, as of the last call to add_chunks_around_player_to_setup_queue.
+    std::optional<DirectX::XMUINT3> m_player_chunk_index_3d{};
+
+    // Loaded chunks whose border faces have to be re-resolved because a neighbor was loaded after they were meshed.
+    std::queue<size_t> m_chunks_to_remesh_queue{};
+
+    // Retired chunk buffers that wait for the copy queue, and for the direct queue.
+    std::queue<RetiredChunkBuffers> m_copy_queue_retired_chunk_buffers{};
+    std::queue<RetiredChunkBuffers> m_direct_queue_retired_chunk_buffers{};
+
+    // Loaded chunks that are out of render distance, sorted by distance (furthest last). Chunks are added as they leave
+    // render distance (or are loaded out of it), and the candidates are re-sorted each time the player moves to another
+    // chunk. Candidates that are back in render distance (or were unloaded by other means) are dropped then.
+    std::vector<EvictionCandidate> m_eviction_candidates{};
+
+    // Reset whenever candidates are added, so that they are sorted again.
+    std::optional<DirectX::XMINT3> m_eviction_candidates_view_chunk_index_3d{};
+
+    // Indirect commands of the loaded chunks that have a range of the region buffers. The renderer uploads the commands
+    // that changed each frame.
+    ChunkIndirectCommandArray m_chunk_indirect_commands{};
+
+    // Buffers (and indirect commands) of the regions, which the meshes of the chunks are sub-allocated from.
+    ChunkRegions m_chunk_regions{};
+
+    // See update_occlusion_culling.
+    OcclusionCuller m_occlusion_culler{};
+
+    // See update_cave_culling. The version is incremented each time the face connectivity of the loaded chunks
+    // changes, and the potentially visible chunks remember the version they were searched with.
+    CaveCulling::PotentiallyVisibleSet m_potentially_visible_chunks{};
+    u64 m_face_connectivity_version{};
+    u64 m_potentially_visible_chunks_version{};
+    u64 m_number_of_cave_culling_searches{};
+
+    // Every loaded chunk, with its flags (see update_chunk_octree_flags).
+    ChunkOctree m_chunk_octree{};
+
+    // Scratch buffer of cull_chunks_hierarchical.
+    std::vector<size_t> m_visible_chunk_indices{};
 
-    // All chunks only have a index buffer with them. The indices 'index' into this common shared chunk constant buffer.
-    // The data in this buffer is ordered vertex wise, voxel wise.
+    // The meshes of all chunks 'index' into this common shared chunk position buffer, which has one position per point
+    // of the voxel lattice of a chunk, ordered along x, then y, then z (see NUMBER_OF_SHARED_VERTICES).
     StructuredBuffer m_shared_chunk_position_buffer{};
 
-    // Threadpool from which std::futures are obtained.
-    BS::thread_pool m_thread_pool;
+    // Runs the generation and meshing jobs of the chunks. Declared last, so that it waits for the jobs in flight
+    // before the rest of the chunk manager is destroyed.
+    JobSystem m_job_system;
 };
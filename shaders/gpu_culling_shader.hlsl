@@ -2,6 +2,55 @@
 
 ConstantBuffer<GPUCullRenderResources> render_resources : register(b0);
 
+// Returns the clip planes that all of the corners of the box are outside of, which culls the box if there is any.
+// Culling a box when most of its corners are outside of the frustum would cull boxes that straddle the frustum (or that
+// the camera is in). Box min is relative to the camera.
+uint get_outside_clip_planes_mask(const float4x4 view_projection_matrix, const float3 box_min, const float box_length)
+{
+    uint outside_clip_planes_mask = 0x3f;
+    for (uint i = 0u; i < 8u; i++)
+    {
+        const float3 corner_offset = float3(i & 1u, (i >> 1u) & 1u, (i >> 2u) & 1u) * box_length;
+        const float4 clip_space_coords = mul(float4(box_min + corner_offset, 1.0f), view_projection_matrix);
+
+        outside_clip_planes_mask &=
+            (clip_space_coords.x < -clip_space_coords.w ? 1u : 0u) |
+            (clip_space_coords.x > clip_space_coords.w ? 2u : 0u) |
+            (clip_space_coords.y < -clip_space_coords.w ? 4u : 0u) |
+            (clip_space_coords.y > clip_space_coords.w ? 8u : 0u) | (clip_space_coords.z < 0.0f ? 16u : 0u) |
+            (clip_space_coords.z > clip_space_coords.w ? 32u : 0u);
+    }
+
+    return outside_clip_planes_mask;
+}
+
+// Returns the value of the number of bits (at most 32) of bits that start at first bit.
+uint get_bits(const uint4 bits, const uint first_bit, const uint number_of_bits)
+{
+    const uint word = first_bit / 32u;
+    const uint shift = first_bit % 32u;
+
+    uint value = bits[word] >> shift;
+    if (shift + number_of_bits > 32u)
+    {
+        value |= bits[word + 1u] << (32u - shift);
+    }
+
+    return number_of_bits < 32u ? value & ((1u << number_of_bits) - 1u) : value;
+}
+
+// HLSL has no unions, so the region run of a region command is read from the start of its culling arguments.
+RegionRun get_region_run(const GPUIndirectCommand command)
+{
+    RegionRun region_run;
+    region_run.page_index = command.culling_arguments[0];
+    region_run.first_loaded_chunk_mesh = command.culling_arguments[1];
+    region_run.number_of_loaded_chunk_meshes = command.culling_arguments[2];
+    region_run.loaded_chunk_mesh_list = command.culling_arguments[3];
+
+    return region_run;
+}
+
 [numthreads(32, 1, 1)] void cs_main(uint dispatch_thread_id
                                     : SV_DispatchThreadID) {
     if (dispatch_thread_id < render_resources.number_of_chunks)
@@ -15,38 +64,139 @@ ConstantBuffer<GPUCullRenderResources> render_resources : register(b0);
         ConstantBuffer<SceneConstantBuffer> scene_constant_buffer =
             ResourceDescriptorHeap[render_resources.scene_constant_buffer_index];
 
-        ConstantBuffer<ChunkConstantBuffer> chunk_constant_buffer =
-            ResourceDescriptorHeap[indirect_command[dispatch_thread_id]
-                                       .voxel_render_resources.chunk_constant_buffer_index];
+        const GPUIndirectCommand input_command = indirect_command[dispatch_thread_id];
+
+        ConstantBuffer<RegionConstantBuffer> region_constant_buffer =
+            ResourceDescriptorHeap[input_command.voxel_render_resources.region_constant_buffer_index];
+
+        const float4x4 view_projection_matrix =
+            mul(scene_constant_buffer.view_matrix, scene_constant_buffer.projection_matrix);
+
+        // The opposite corner of the chunk AABB is its maximum.
+        const float edge_length = scene_constant_buffer.aabb_vertices[6].x;
 
-        // For each vertex, find the clip space coord and check if AABB vertex is culled.
-        uint culled_vertices = 0;
-        for (int i = 0; i < 8; i++)
+        // A region command draws a run of the chunk meshes of a region, so it is first culled with the bounds of the
+        // region, whose origin is the translation of its first chunk. Then, each chunk of the run is culled on its own.
+        const uint region_chunk_slot = input_command.voxel_render_resources.region_chunk_slot;
+        const bool is_region_command = region_chunk_slot == NUMBER_OF_CHUNKS_PER_REGION;
+
+        if (is_region_command &&
+            get_outside_clip_planes_mask(view_projection_matrix,
+                                         float3(region_constant_buffer.chunk_translation_vectors[0].xyz) -
+                                             scene_constant_buffer.camera_position.xyz,
+                                         edge_length * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION) != 0u)
         {
-            float4 clip_space_coords =
-                mul(mul(scene_constant_buffer.aabb_vertices[i] + chunk_constant_buffer.translation_vector -
-                            float4(scene_constant_buffer.camera_position.xyz, 0.0f),
-                        scene_constant_buffer.view_matrix),
-                    scene_constant_buffer.projection_matrix);
-
-            clip_space_coords.x /= clip_space_coords.w;
-            clip_space_coords.y /= clip_space_coords.w;
-            clip_space_coords.z /= clip_space_coords.w;
-
-            bool is_visible =
-                (-clip_space_coords.w <= clip_space_coords.x) && (clip_space_coords.x <= clip_space_coords.w) &&
-                (-clip_space_coords.w <= clip_space_coords.y) && (clip_space_coords.y <= clip_space_coords.w) &&
-                (0 <= clip_space_coords.z) && (clip_space_coords.z <= clip_space_coords.w);
-
-            if (!is_visible)
+            return;
+        }
+
+        // The scene constant buffer is the same for all chunks, so it is not stored in the input commands.
+        GPUIndirectCommand output_command = input_command;
+        output_command.voxel_render_resources.scene_constant_buffer_index =
+            render_resources.scene_constant_buffer_index;
+
+        // Whole face directions that point away from the camera are skipped (see get_visible_face_directions_mask in
+        // chunk.hpp). The faces of a chunk mesh are grouped by direction, so each run of consecutive visible directions
+        // is one draw. The meshes of the run of a region command are next to each other, so a run of visible
+        // directions can go on from one chunk to the next.
+        uint first_index = 0u;
+        uint number_of_indices = 0u;
+
+        // The loaded chunk meshes of a region command are in the list of the page it was recorded with, which is not
+        // written again while the frame is in flight (see ChunkRegions).
+        const RegionRun region_run = get_region_run(input_command);
+        const uint first_loaded_chunk_mesh =
+            is_region_command ? region_run.loaded_chunk_mesh_list * NUMBER_OF_CHUNKS_PER_REGION +
+                                    region_run.first_loaded_chunk_mesh
+                              : 0u;
+        const uint number_of_chunk_meshes = is_region_command ? region_run.number_of_loaded_chunk_meshes : 1u;
+
+        uint next_index = input_command.draw_arguments_1.z;
+
+        // A run never draws past the range of its command, even if the loaded chunk meshes do not match it.
+        const uint end_index = input_command.draw_arguments_1.z + input_command.draw_arguments_1.x;
+
+        for (uint chunk_mesh = 0u; chunk_mesh < number_of_chunk_meshes; chunk_mesh++)
+        {
+            uint chunk_slot = region_chunk_slot;
+            uint face_direction_index_counts[6] = input_command.culling_arguments;
+
+            if (is_region_command)
+            {
+                const uint4 loaded_chunk_mesh =
+                    region_constant_buffer.loaded_chunk_meshes[first_loaded_chunk_mesh + chunk_mesh];
+
+                const uint face_count_bits = region_constant_buffer.face_count_bits;
+
+                chunk_slot = get_bits(loaded_chunk_mesh, 0u, REGION_CHUNK_SLOT_BITS);
+                for (uint face = 0u; face < 6u; face++)
+                {
+                    face_direction_index_counts[face] =
+                        get_bits(loaded_chunk_mesh, REGION_CHUNK_SLOT_BITS + face * face_count_bits, face_count_bits) *
+                        6u;
+                }
+
+                const uint chunk_mesh_index_count = face_direction_index_counts[0] + face_direction_index_counts[1] +
+                                                    face_direction_index_counts[2] + face_direction_index_counts[3] +
+                                                    face_direction_index_counts[4] + face_direction_index_counts[5];
+                if (next_index + chunk_mesh_index_count > end_index)
+                {
+                    break;
+                }
+            }
+
+            const float3 camera_position = scene_constant_buffer.camera_position.xyz -
+                                           float3(region_constant_buffer.chunk_translation_vectors[chunk_slot].xyz);
+
+            if (get_outside_clip_planes_mask(view_projection_matrix, -camera_position, edge_length) != 0u)
+            {
+                for (uint face = 0u; face < 6u; face++)
+                {
+                    next_index += face_direction_index_counts[face];
+                }
+
+                continue;
+            }
+
+            const bool is_face_direction_visible[6] = {
+                camera_position.z < edge_length, camera_position.z > 0.0f, camera_position.x < edge_length,
+                camera_position.x > 0.0f,        camera_position.y > 0.0f, camera_position.y < edge_length,
+            };
+
+            for (uint face = 0u; face < 6u; face++)
             {
-                ++culled_vertices;
+                const uint face_direction_index_count = face_direction_index_counts[face];
+
+                if (is_face_direction_visible[face] && face_direction_index_count != 0u)
+                {
+                    // A direction that is not adjacent to the current run starts a new draw.
+                    if (number_of_indices != 0u && first_index + number_of_indices != next_index)
+                    {
+                        output_command.voxel_render_resources.first_face_index = first_index / 6u;
+                        output_command.draw_arguments_1.x = number_of_indices;
+                        output_command.draw_arguments_1.z = first_index;
+                        output_commands.Append(output_command);
+
+                        number_of_indices = 0u;
+                    }
+
+                    if (number_of_indices == 0u)
+                    {
+                        first_index = next_index;
+                    }
+
+                    number_of_indices += face_direction_index_count;
+                }
+
+                next_index += face_direction_index_count;
             }
         }
 
-        if (culled_vertices < 7)
+        if (number_of_indices != 0u)
         {
-            output_commands.Append(indirect_command[dispatch_thread_id]);
+            output_command.voxel_render_resources.first_face_index = first_index / 6u;
+            output_command.draw_arguments_1.x = number_of_indices;
+            output_command.draw_arguments_1.z = first_index;
+            output_commands.Append(output_command);
         }
     }
 }
@@ -25,10 +25,27 @@ struct TriangleRenderResources
     uint color_buffer_index;
 };
 
+// The meshes of the chunks of a region (a cube of NUMBER_OF_CHUNKS_PER_REGION_DIMENSION chunks per dimension) are
+// packed into the same buffers (see ChunkRegions).
+static const uint NUMBER_OF_CHUNKS_PER_REGION_DIMENSION = 4;
+static const uint NUMBER_OF_CHUNKS_PER_REGION = 64;
+static const uint REGION_CHUNK_SLOT_BITS = 6;
+
+// Lists of loaded chunk meshes of each page (see RegionConstantBuffer). The frames that are still in flight keep
+// reading the list they were recorded with, so there is one more list than backbuffers.
+static const uint NUMBER_OF_LOADED_CHUNK_MESH_LISTS = 4;
+
+// A chunk is drawn with one draw per range of visible face directions : first face index is the index of the first
+// face of the draw in the buffers of the region, so that the per face colors can be indexed with the primitive id of
+// the draw.
+// Region chunk slot is the slot of the chunk in its region, or NUMBER_OF_CHUNKS_PER_REGION if the command draws a run
+// of chunk meshes of the region at once.
 struct VoxelRenderResources
 {
     uint scene_constant_buffer_index;
-    uint chunk_constant_buffer_index;
+    uint region_constant_buffer_index;
+    uint first_face_index;
+    uint region_chunk_slot;
 };
 
 ConstantBufferStruct
@@ -43,16 +60,46 @@ SceneConstantBuffer
 };
 
 ConstantBufferStruct
-ChunkConstantBuffer
+RegionConstantBuffer
 {
-    uint4 translation_vector;
+    // Translation of each chunk of the region, indexed by the slot of the chunk. The chunk in the first slot is at the
+    // origin of the region.
+    uint4 chunk_translation_vectors[NUMBER_OF_CHUNKS_PER_REGION];
+
+    // Lists of the meshes of the loaded chunks of the page, in the order of their faces. A region command draws a run
+    // of the meshes of one of the lists, which the culling shader splits into ranges of visible face directions, chunk
+    // by chunk. A list is never written while a frame in flight may read it : a new list is used instead.
+    // Each mesh is the slot of its chunk (in the lowest REGION_CHUNK_SLOT_BITS bits), followed by the number of faces
+    // of each face direction (in FaceDirection order, face count bits each). The meshes of a run are next to each
+    // other, so the first face of a mesh is the end of the previous one.
+    uint4 loaded_chunk_meshes[NUMBER_OF_LOADED_CHUNK_MESH_LISTS * NUMBER_OF_CHUNKS_PER_REGION];
 
     uint position_buffer_index;
 
     uint color_buffer_index;
+
+    // The indices of a region are the index of the vertex in the shared position buffer, with the slot of the chunk of
+    // the vertex in the bits from this shift upwards.
+    uint region_chunk_slot_shift;
+
+    uint face_count_bits;
+};
+
+// The run of loaded chunk meshes of a page (see RegionConstantBuffer) that a region command draws, i.e the index of the
+// page, the first and number of loaded chunk meshes of the run, and the list of loaded chunk meshes it is in.
+struct RegionRun
+{
+    uint page_index;
+    uint first_loaded_chunk_mesh;
+    uint number_of_loaded_chunk_meshes;
+    uint loaded_chunk_mesh_list;
 };
 
 // D3D12_DRAW_INDEXED_ARGUMENTS has 5 32 bit members, which is why draw arguments is split into a uint4 and uint.
+// Culling arguments are not part of the command signature. For chunk commands, they are the number of indices of each
+// face direction, in FaceDirection order (front, back, left, right and top, bottom), as the faces of a chunk mesh are
+// grouped by direction. For region commands, they start with the region run of the command (see
+// ChunkIndirectCommand, where they are a union).
 struct GPUIndirectCommand
 {
     VoxelRenderResources voxel_render_resources;
@@ -60,6 +107,7 @@ struct GPUIndirectCommand
     uint4 draw_arguments_1;
     uint draw_arguments_2;
     uint padding;
+    uint culling_arguments[6];
 };
 
 struct GPUCullRenderResources
@@ -9,16 +9,20 @@ ConstantBuffer<VoxelRenderResources> render_resources : register(b0);
 
 VSOutput vs_main(uint vertex_id : SV_VertexID)
 {
-    ConstantBuffer<ChunkConstantBuffer> chunk_constant_buffer =
-        ResourceDescriptorHeap[render_resources.chunk_constant_buffer_index];
+    ConstantBuffer<RegionConstantBuffer> region_constant_buffer =
+        ResourceDescriptorHeap[render_resources.region_constant_buffer_index];
 
     ConstantBuffer<SceneConstantBuffer> scene_buffer =
         ResourceDescriptorHeap[render_resources.scene_constant_buffer_index];
 
-    StructuredBuffer<float3> position_buffer = ResourceDescriptorHeap[chunk_constant_buffer.position_buffer_index];
+    StructuredBuffer<float3> position_buffer = ResourceDescriptorHeap[region_constant_buffer.position_buffer_index];
 
-    const float3 position =
-        position_buffer[vertex_id] + -scene_buffer.camera_position.xyz + chunk_constant_buffer.translation_vector.xyz;
+    // The chunks of a draw may be any of the chunks of the region, so the chunk of the vertex is read from its index.
+    const uint region_chunk_slot = vertex_id >> region_constant_buffer.region_chunk_slot_shift;
+    const uint position_index = vertex_id & ((1u << region_constant_buffer.region_chunk_slot_shift) - 1u);
+
+    const float3 position = position_buffer[position_index] + -scene_buffer.camera_position.xyz +
+                            region_constant_buffer.chunk_translation_vectors[region_chunk_slot].xyz;
 
     VSOutput output;
     output.position = mul(mul(float4(position, 1.0f), scene_buffer.view_matrix), scene_buffer.projection_matrix);
@@ -28,9 +32,11 @@ VSOutput vs_main(uint vertex_id : SV_VertexID)
 
 float4 ps_main(VSOutput input, uint primitive_id : SV_PrimitiveID) : SV_Target
 {
-    ConstantBuffer<ChunkConstantBuffer> chunk_constant_buffer =
-        ResourceDescriptorHeap[render_resources.chunk_constant_buffer_index];
+    ConstantBuffer<RegionConstantBuffer> region_constant_buffer =
+        ResourceDescriptorHeap[render_resources.region_constant_buffer_index];
 
-    StructuredBuffer<float3> color_buffer = ResourceDescriptorHeap[chunk_constant_buffer.color_buffer_index];
-    return float4(color_buffer[primitive_id], 1.0f);
+    // There is one color per face, and each face is made up of 2 triangles. The primitive id starts from 0 for each
+    // draw (one per range of visible face directions of a chunk, or per run of chunks of a region).
+    StructuredBuffer<float3> color_buffer = ResourceDescriptorHeap[region_constant_buffer.color_buffer_index];
+    return float4(color_buffer[render_resources.first_face_index + primitive_id / 2], 1.0f);
 }
@@ -0,0 +1,127 @@
+#include "voxel-engine/block_pool.hpp"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+static void *allocate_page(const size_t page_size)
+{
+#if defined(_WIN32)
+    return VirtualAlloc(nullptr, page_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#elif defined(__linux__)
+    void *const page = mmap(nullptr, page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (page == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+#if defined(VX_ENABLE_HUGE_PAGES) && defined(MADV_HUGEPAGE)
+    // Only a hint : if transparent huge pages are disabled, regular pages are used.
+    madvise(page, page_size, MADV_HUGEPAGE);
+#endif
+
+    return page;
+#else
+    return ::operator new(page_size, std::align_val_t{BlockPool::BLOCK_ALIGNMENT}, std::nothrow);
+#endif
+}
+
+static void free_page(void *const page, const size_t page_size)
+{
+#if defined(_WIN32)
+    (void)page_size;
+    VirtualFree(page, 0u, MEM_RELEASE);
+#elif defined(__linux__)
+    munmap(page, page_size);
+#else
+    (void)page_size;
+    ::operator delete(page, std::align_val_t{BlockPool::BLOCK_ALIGNMENT});
+#endif
+}
+
+BlockPool::BlockPool(const size_t block_size, const size_t page_size)
+    : m_block_size(round_up_to_multiple(std::max(block_size, sizeof(void *)), BLOCK_ALIGNMENT)),
+      m_page_size(round_up_to_multiple(std::max(page_size, m_block_size), DEFAULT_PAGE_SIZE))
+{
+}
+
+BlockPool::~BlockPool()
+{
+    for (void *const page : m_pages)
+    {
+        free_page(page, m_page_size);
+    }
+}
+
+void *BlockPool::allocate()
+{
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    m_statistics.m_number_of_allocations++;
+    m_statistics.m_number_of_blocks_in_use++;
+    m_statistics.m_peak_number_of_blocks_in_use =
+        std::max(m_statistics.m_peak_number_of_blocks_in_use, m_statistics.m_number_of_blocks_in_use);
+
+    if (m_free_list)
+    {
+        void *const block = m_free_list;
+        m_free_list = *static_cast<void **>(block);
+
+        return block;
+    }
+
+    if (m_page_cursor == m_page_end)
+    {
+        u8 *const page = static_cast<u8 *>(allocate_page(m_page_size));
+        if (!page)
+        {
+            throw std::bad_alloc{};
+        }
+
+        m_pages.push_back(page);
+
+        m_page_cursor = page;
+        m_page_end = page + (m_page_size / m_block_size) * m_block_size;
+
+        m_statistics.m_number_of_page_allocations++;
+        m_statistics.m_reserved_size_in_bytes += m_page_size;
+    }
+
+    void *const block = m_page_cursor;
+    m_page_cursor += m_block_size;
+
+    return block;
+}
+
+void BlockPool::deallocate(void *const block)
+{
+    if (!block)
+    {
+        return;
+    }
+
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    *static_cast<void **>(block) = m_free_list;
+    m_free_list = block;
+
+    m_statistics.m_number_of_blocks_in_use--;
+}
+
+BlockPool::Statistics BlockPool::get_statistics() const
+{
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    return m_statistics;
+}
+
+BlockPool::Statistics &BlockPool::Statistics::operator+=(const Statistics &other)
+{
+    m_number_of_allocations += other.m_number_of_allocations;
+    m_number_of_page_allocations += other.m_number_of_page_allocations;
+    m_number_of_blocks_in_use += other.m_number_of_blocks_in_use;
+    m_peak_number_of_blocks_in_use += other.m_peak_number_of_blocks_in_use;
+    m_reserved_size_in_bytes += other.m_reserved_size_in_bytes;
+
+    return *this;
+}
@@ -0,0 +1,184 @@
+#include "voxel-engine/cave_culling.hpp"
+
+namespace CaveCulling
+{
+template <u32 N>
+FaceConnectivity compute_face_connectivity(const BasicChunk<N> &chunk)
+{
+    if (chunk.m_occupancy_state == OccupancyState::Empty)
+    {
+        return FaceConnectivity::all_connected();
+    }
+
+    FaceConnectivity face_connectivity{};
+    if (chunk.m_occupancy_state == OccupancyState::Full)
+    {
+        return face_connectivity;
+    }
+
+    using Chunk = BasicChunk<N>;
+
+    // Active voxels are never visited, so the visited rows start out as the occupancy rows.
+    std::array<u64, Chunk::NUMBER_OF_ROWS> visited_rows{};
+    for (u32 z = 0u; z < N; z++)
+    {
+        for (u32 y = 0u; y < N; y++)
+        {
+            visited_rows[y + z * N] = chunk.get_row(y, z);
+        }
+    }
+
+    const auto is_visited = [&](const u32 x, const u32 y, const u32 z) {
+        return (visited_rows[y + z * N] >> x) & 1ull;
+    };
+
+    const auto visit = [&](const u32 x, const u32 y, const u32 z) { visited_rows[y + z * N] |= 1ull << x; };
+
+    // Voxels are packed as x + y * N + z * N * N, which fits in 32 bits for every supported chunk dimension.
+    thread_local std::vector<u32> voxels_to_visit{};
+
+    const auto flood_fill = [&](const u32 seed_x, const u32 seed_y, const u32 seed_z) {
+        u8 touched_faces_mask = 0u;
+
+        visit(seed_x, seed_y, seed_z);
+        voxels_to_visit.clear();
+        voxels_to_visit.push_back(seed_x + seed_y * N + seed_z * N * N);
+
+        while (!voxels_to_visit.empty())
+        {
+            const u32 voxel = voxels_to_visit.back();
+            voxels_to_visit.pop_back();
+
+            const u32 x = voxel % N;
+            const u32 y = voxel / N % N;
+            const u32 z = voxel / (N * N);
+
+            const auto touch = [&](const bool is_on_face, const FaceDirection face_direction) {
+                touched_faces_mask |= static_cast<u8>(static_cast<u8>(is_on_face) << static_cast<u8>(face_direction));
+            };
+
+            touch(z == 0u, FaceDirection::Front);
+            touch(z == N - 1u, FaceDirection::Back);
+            touch(x == 0u, FaceDirection::Left);
+            touch(x == N - 1u, FaceDirection::Right);
+            touch(y == N - 1u, FaceDirection::Top);
+            touch(y == 0u, FaceDirection::Bottom);
+
+            const auto visit_neighbor = [&](const u32 neighbor_x, const u32 neighbor_y, const u32 neighbor_z) {
+                if (!is_visited(neighbor_x, neighbor_y, neighbor_z))
+                {
+                    visit(neighbor_x, neighbor_y, neighbor_z);
+                    voxels_to_visit.push_back(neighbor_x + neighbor_y * N + neighbor_z * N * N);
+                }
+            };
+
+            if (x > 0u)
+            {
+                visit_neighbor(x - 1u, y, z);
+            }
+            if (x < N - 1u)
+            {
+                visit_neighbor(x + 1u, y, z);
+            }
+            if (y > 0u)
+            {
+                visit_neighbor(x, y - 1u, z);
+            }
+            if (y < N - 1u)
+            {
+                visit_neighbor(x, y + 1u, z);
+            }
+            if (z > 0u)
+            {
+                visit_neighbor(x, y, z - 1u);
+            }
+            if (z < N - 1u)
+            {
+                visit_neighbor(x, y, z + 1u);
+            }
+        }
+
+        return touched_faces_mask;
+    };
+
+    // Each empty region that touches the border of the chunk connects all of the faces it touches. Regions that do not
+    // touch the border cannot be seen from outside of the chunk, so only border voxels are used as seeds.
+    for (u32 z = 0u; z < N; z++)
+    {
+        for (u32 y = 0u; y < N; y++)
+        {
+            const bool is_border_row = y == 0u || y == N - 1u || z == 0u || z == N - 1u;
+            const u64 border_mask = is_border_row ? Chunk::FULL_ROW_MASK : (1ull | (1ull << (N - 1u)));
+
+            u64 seeds = ~visited_rows[y + z * N] & border_mask;
+            while (seeds != 0ull)
+            {
+                const u32 x = static_cast<u32>(std::countr_zero(seeds));
+
+                // A previous region may have reached this voxel in the meantime.
+                if (!is_visited(x, y, z))
+                {
+                    const u8 touched_faces_mask = flood_fill(x, y, z);
+                    for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+                    {
+                        if ((touched_faces_mask >> face) & 1u)
+                        {
+                            face_connectivity.m_connected_faces_masks[face] |= touched_faces_mask;
+                        }
+                    }
+
+                    // Nothing more can be learned once every face is connected to every other face.
+                    if (face_connectivity == FaceConnectivity::all_connected())
+                    {
+                        return face_connectivity;
+                    }
+                }
+
+                seeds &= seeds - 1ull;
+            }
+        }
+    }
+
+    return face_connectivity;
+}
+
+bool PotentiallyVisibleSet::contains(const DirectX::XMUINT3 chunk_index_3d) const
+{
+    if (!m_is_valid)
+    {
+        return true;
+    }
+
+    const std::optional<size_t> cube_index = get_cube_index({
+        static_cast<i32>(chunk_index_3d.x),
+        static_cast<i32>(chunk_index_3d.y),
+        static_cast<i32>(chunk_index_3d.z),
+    });
+
+    return !cube_index.has_value() || m_entered_faces_masks[*cube_index] != 0u;
+}
+
+std::optional<size_t> PotentiallyVisibleSet::get_cube_index(const DirectX::XMINT3 chunk_index_3d) const
+{
+    const i32 radius = static_cast<i32>(m_radius);
+    const i32 cube_length = 2 * radius + 1;
+
+    const i32 x = chunk_index_3d.x - m_camera_chunk_index_3d.x + radius;
+    const i32 y = chunk_index_3d.y - m_camera_chunk_index_3d.y + radius;
+    const i32 z = chunk_index_3d.z - m_camera_chunk_index_3d.z + radius;
+
+    if (x < 0 || x >= cube_length || y < 0 || y >= cube_length || z < 0 || z >= cube_length)
+    {
+        return std::nullopt;
+    }
+
+    return static_cast<size_t>(x) + static_cast<size_t>(y) * cube_length +
+           static_cast<size_t>(z) * cube_length * cube_length;
+}
+
+// Chunk dimensions that are supported (see chunk.cpp).
+template FaceConnectivity compute_face_connectivity<8u>(const BasicChunk<8u> &);
+template FaceConnectivity compute_face_connectivity<16u>(const BasicChunk<16u> &);
+template FaceConnectivity compute_face_connectivity<32u>(const BasicChunk<32u> &);
+template FaceConnectivity compute_face_connectivity<64u>(const BasicChunk<64u> &);
+} // namespace CaveCulling
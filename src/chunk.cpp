@@ -0,0 +1,417 @@
+#include "voxel-engine/chunk.hpp"
+
+// Read only voxel data shared by all uniform chunks (of the same dimension). The setters give a chunk its own voxel
+// data before writing, so these are never written to.
+template <u32 N>
+static std::array<typename BasicChunk<N>::OccupancyRow, BasicChunk<N>::NUMBER_OF_ROWS> EMPTY_OCCUPANCY{};
+
+template <u32 N>
+static std::array<typename BasicChunk<N>::OccupancyRow, BasicChunk<N>::NUMBER_OF_ROWS> create_full_occupancy()
+{
+    std::array<typename BasicChunk<N>::OccupancyRow, BasicChunk<N>::NUMBER_OF_ROWS> occupancy{};
+    occupancy.fill(static_cast<typename BasicChunk<N>::OccupancyRow>(BasicChunk<N>::FULL_ROW_MASK));
+    return occupancy;
+}
+
+template <u32 N>
+static std::array<typename BasicChunk<N>::OccupancyRow, BasicChunk<N>::NUMBER_OF_ROWS> FULL_OCCUPANCY =
+    create_full_occupancy<N>();
+
+template <u32 N>
+static inline typename BasicChunk<N>::OccupancyRow *get_uniform_occupancy(const OccupancyState occupancy_state)
+{
+    return occupancy_state == OccupancyState::Full ? FULL_OCCUPANCY<N>.data() : EMPTY_OCCUPANCY<N>.data();
+}
+
+template <u32 N>
+BlockPool &BasicChunk<N>::get_occupancy_pool()
+{
+    static BlockPool occupancy_pool(OCCUPANCY_SIZE_IN_BYTES);
+    return occupancy_pool;
+}
+
+template <u32 N>
+BlockPool &BasicChunk<N>::get_palette_indices_pool(const u32 bits_per_palette_index)
+{
+    static std::array<BlockPool, PALETTE_INDEX_SIZES.size()> palette_indices_pools = {
+        BlockPool(get_palette_indices_size_in_bytes(PALETTE_INDEX_SIZES[0])),
+        BlockPool(get_palette_indices_size_in_bytes(PALETTE_INDEX_SIZES[1])),
+        BlockPool(get_palette_indices_size_in_bytes(PALETTE_INDEX_SIZES[2])),
+        BlockPool(get_palette_indices_size_in_bytes(PALETTE_INDEX_SIZES[3])),
+    };
+
+    // Index sizes are powers of two, starting at 1.
+    return palette_indices_pools[std::countr_zero(bits_per_palette_index)];
+}
+
+template <u32 N>
+BlockPool::Statistics BasicChunk<N>::get_voxel_data_pool_statistics()
+{
+    BlockPool::Statistics statistics = get_occupancy_pool().get_statistics();
+    for (const u32 bits_per_palette_index : PALETTE_INDEX_SIZES)
+    {
+        statistics += get_palette_indices_pool(bits_per_palette_index).get_statistics();
+    }
+
+    return statistics;
+}
+
+template <u32 N>
+static inline void free_palette_indices(BasicChunk<N> &chunk)
+{
+    if (chunk.m_bits_per_palette_index != 0u)
+    {
+        BasicChunk<N>::get_palette_indices_pool(chunk.m_bits_per_palette_index).deallocate(chunk.m_palette_indices);
+    }
+
+    chunk.m_palette_indices = nullptr;
+    chunk.m_bits_per_palette_index = 0u;
+}
+
+template <u32 N>
+BasicChunk<N>::BasicChunk()
+{
+    // Chunks start out empty, the occupancy is filled in by the terrain generator.
+    m_occupancy = get_uniform_occupancy<N>(OccupancyState::Empty);
+}
+
+template <u32 N>
+BasicChunk<N>::BasicChunk(BasicChunk &&other) noexcept
+    : m_occupancy(std::move(other.m_occupancy)), m_occupancy_state(other.m_occupancy_state),
+      m_palette(other.m_palette), m_palette_size(other.m_palette_size), m_palette_indices(other.m_palette_indices),
+      m_bits_per_palette_index(other.m_bits_per_palette_index), m_chunk_index(other.m_chunk_index),
+      m_meshed_neighbors_mask(other.m_meshed_neighbors_mask)
+{
+    other.m_occupancy = get_uniform_occupancy<N>(OccupancyState::Empty);
+    other.m_occupancy_state = OccupancyState::Empty;
+    other.m_palette_size = 0u;
+    other.m_palette_indices = nullptr;
+    other.m_bits_per_palette_index = 0u;
+}
+
+template <u32 N>
+BasicChunk<N> &BasicChunk<N>::operator=(BasicChunk &&other) noexcept
+{
+    if (this != &other)
+    {
+        if (m_occupancy_state == OccupancyState::Mixed)
+        {
+            get_occupancy_pool().deallocate(m_occupancy);
+        }
+        free_palette_indices(*this);
+
+        this->m_occupancy = std::move(other.m_occupancy);
+        this->m_occupancy_state = other.m_occupancy_state;
+        this->m_palette = other.m_palette;
+        this->m_palette_size = other.m_palette_size;
+        this->m_palette_indices = other.m_palette_indices;
+        this->m_bits_per_palette_index = other.m_bits_per_palette_index;
+        this->m_chunk_index = other.m_chunk_index;
+        this->m_meshed_neighbors_mask = other.m_meshed_neighbors_mask;
+
+        other.m_occupancy = get_uniform_occupancy<N>(OccupancyState::Empty);
+        other.m_occupancy_state = OccupancyState::Empty;
+        other.m_palette_size = 0u;
+        other.m_palette_indices = nullptr;
+        other.m_bits_per_palette_index = 0u;
+    }
+
+    return *this;
+}
+
+template <u32 N>
+BasicChunk<N>::~BasicChunk()
+{
+    if (m_occupancy_state == OccupancyState::Mixed)
+    {
+        get_occupancy_pool().deallocate(m_occupancy);
+    }
+    free_palette_indices(*this);
+}
+
+template <u32 N>
+void BasicChunk<N>::set_uniform(const OccupancyState occupancy_state, const BlockType block_type)
+{
+    set_uniform_occupancy(occupancy_state);
+
+    m_palette_size = 0u;
+    free_palette_indices(*this);
+
+    if (occupancy_state == OccupancyState::Full)
+    {
+        m_palette[m_palette_size++] = block_type;
+    }
+}
+
+template <u32 N>
+void BasicChunk<N>::set_uniform_occupancy(const OccupancyState occupancy_state)
+{
+    if (m_occupancy_state == OccupancyState::Mixed)
+    {
+        get_occupancy_pool().deallocate(m_occupancy);
+    }
+
+    m_occupancy = get_uniform_occupancy<N>(occupancy_state);
+    m_occupancy_state = occupancy_state;
+}
+
+template <u32 N>
+void BasicChunk<N>::make_mixed()
+{
+    if (m_occupancy_state == OccupancyState::Mixed)
+    {
+        return;
+    }
+
+    OccupancyRow *const occupancy = static_cast<OccupancyRow *>(get_occupancy_pool().allocate());
+    std::copy_n(m_occupancy, NUMBER_OF_ROWS, occupancy);
+
+    m_occupancy = occupancy;
+    m_occupancy_state = OccupancyState::Mixed;
+}
+
+template <u32 N>
+void BasicChunk<N>::update_occupancy_state()
+{
+    if (m_occupancy_state != OccupancyState::Mixed)
+    {
+        return;
+    }
+
+    // Full chunks may still have more than one block type, so only the occupancy is released for them.
+    if (is_empty())
+    {
+        set_uniform(OccupancyState::Empty);
+    }
+    else if (is_full())
+    {
+        set_uniform_occupancy(OccupancyState::Full);
+    }
+}
+
+template <u32 N>
+void BasicChunk<N>::set_block_type(const DirectX::XMUINT3 index_3d, const BlockType block_type)
+{
+    if (block_type == BlockType::Air)
+    {
+        set_voxel_active(index_3d, false);
+        return;
+    }
+
+    if (!is_voxel_active(index_3d))
+    {
+        set_voxel_active(index_3d, true);
+    }
+
+    // Active voxels of a chunk with no palette are the default block type, so it becomes the first palette entry.
+    if (m_palette_size == 0u)
+    {
+        m_palette[m_palette_size++] = DEFAULT_BLOCK_TYPE;
+    }
+
+    const u32 palette_index =
+        static_cast<u32>(std::find(m_palette.begin(), m_palette.begin() + m_palette_size, block_type) -
+                         m_palette.begin());
+    if (palette_index == m_palette_size)
+    {
+        m_palette[m_palette_size++] = block_type;
+    }
+
+    // Repack the indices if the palette no longer fits in the current index size.
+    if (m_palette_size > (1ull << m_bits_per_palette_index))
+    {
+        const u32 bits_per_palette_index = m_palette_size <= 2u   ? 1u
+                                           : m_palette_size <= 4u  ? 2u
+                                           : m_palette_size <= 16u ? 4u
+                                                                   : 8u;
+
+        const size_t palette_indices_size_in_bytes = get_palette_indices_size_in_bytes(bits_per_palette_index);
+
+        u64 *const palette_indices =
+            static_cast<u64 *>(get_palette_indices_pool(bits_per_palette_index).allocate());
+        std::fill_n(palette_indices, palette_indices_size_in_bytes / sizeof(u64), 0ull);
+
+        for (size_t i = 0; i < NUMBER_OF_VOXELS && m_bits_per_palette_index != 0u; i++)
+        {
+            const u64 index = get_palette_index(convert_to_3d<N>(i));
+
+            const size_t bit_index = i * bits_per_palette_index;
+            palette_indices[bit_index / 64u] |= index << (bit_index % 64u);
+        }
+
+        free_palette_indices(*this);
+
+        m_palette_indices = palette_indices;
+        m_bits_per_palette_index = bits_per_palette_index;
+    }
+
+    if (m_bits_per_palette_index != 0u)
+    {
+        const size_t bit_index = convert_to_1d<N>(index_3d) * m_bits_per_palette_index;
+        const u64 index_mask = (1ull << m_bits_per_palette_index) - 1ull;
+
+        u64 &word = m_palette_indices[bit_index / 64u];
+        word = (word & ~(index_mask << (bit_index % 64u))) | (static_cast<u64>(palette_index) << (bit_index % 64u));
+    }
+}
+
+template <u32 N>
+size_t BasicChunk<N>::get_voxel_data_size_in_bytes() const
+{
+    const size_t occupancy_size_in_bytes = m_occupancy_state == OccupancyState::Mixed ? OCCUPANCY_SIZE_IN_BYTES : 0u;
+
+    const size_t palette_indices_size_in_bytes =
+        m_bits_per_palette_index != 0u ? get_palette_indices_size_in_bytes(m_bits_per_palette_index) : 0u;
+
+    return occupancy_size_in_bytes + palette_indices_size_in_bytes;
+}
+
+template <u32 N>
+bool BasicChunk<N>::is_slab_empty(const u32 z) const
+{
+    u64 combined_rows = 0ull;
+    for (const OccupancyRow row : get_slab(z))
+    {
+        combined_rows |= row;
+    }
+
+    return combined_rows == 0ull;
+}
+
+template <u32 N>
+bool BasicChunk<N>::is_slab_full(const u32 z) const
+{
+    u64 combined_rows = FULL_ROW_MASK;
+    for (const OccupancyRow row : get_slab(z))
+    {
+        combined_rows &= row;
+    }
+
+    return combined_rows == FULL_ROW_MASK;
+}
+
+template <u32 N>
+bool BasicChunk<N>::is_empty() const
+{
+    if (m_occupancy_state != OccupancyState::Mixed)
+    {
+        return m_occupancy_state == OccupancyState::Empty;
+    }
+
+    for (u32 z = 0; z < NUMBER_OF_VOXELS_PER_DIMENSION; z++)
+    {
+        if (!is_slab_empty(z))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <u32 N>
+bool BasicChunk<N>::is_full() const
+{
+    if (m_occupancy_state != OccupancyState::Mixed)
+    {
+        return m_occupancy_state == OccupancyState::Full;
+    }
+
+    for (u32 z = 0; z < NUMBER_OF_VOXELS_PER_DIMENSION; z++)
+    {
+        if (!is_slab_full(z))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <u32 N>
+std::array<u64, N> BasicChunk<N>::get_boundary_slab(const FaceDirection face_direction) const
+{
+    std::array<u64, N> slab{};
+
+    if (m_occupancy_state != OccupancyState::Mixed)
+    {
+        slab.fill(m_occupancy_state == OccupancyState::Full ? FULL_ROW_MASK : 0ull);
+        return slab;
+    }
+
+    switch (face_direction)
+    {
+    case FaceDirection::Left:
+    case FaceDirection::Right: {
+        const u32 x = face_direction == FaceDirection::Left ? 0u : N - 1u;
+        for (u32 z = 0; z < N; z++)
+        {
+            for (u32 y = 0; y < N; y++)
+            {
+                slab[z] |= ((get_row(y, z) >> x) & 1ull) << y;
+            }
+        }
+    }
+    break;
+
+    case FaceDirection::Top:
+    case FaceDirection::Bottom: {
+        const u32 y = face_direction == FaceDirection::Bottom ? 0u : N - 1u;
+        for (u32 z = 0; z < N; z++)
+        {
+            slab[z] = get_row(y, z);
+        }
+    }
+    break;
+
+    case FaceDirection::Front:
+    case FaceDirection::Back: {
+        const u32 z = face_direction == FaceDirection::Front ? 0u : N - 1u;
+        for (u32 y = 0; y < N; y++)
+        {
+            slab[y] = get_row(y, z);
+        }
+    }
+    break;
+    }
+
+    return slab;
+}
+
+template <u32 N>
+BasicChunk<N> BasicChunk<N>::clone() const
+{
+    BasicChunk chunk{};
+    if (m_occupancy_state == OccupancyState::Mixed)
+    {
+        chunk.make_mixed();
+        std::copy_n(m_occupancy, NUMBER_OF_ROWS, chunk.m_occupancy);
+    }
+    else
+    {
+        chunk.set_uniform_occupancy(m_occupancy_state);
+    }
+
+    chunk.m_palette = m_palette;
+    chunk.m_palette_size = m_palette_size;
+
+    if (m_bits_per_palette_index != 0u)
+    {
+        chunk.m_palette_indices = static_cast<u64 *>(get_palette_indices_pool(m_bits_per_palette_index).allocate());
+        chunk.m_bits_per_palette_index = m_bits_per_palette_index;
+
+        std::copy_n(m_palette_indices, get_palette_indices_size_in_bytes(m_bits_per_palette_index) / sizeof(u64),
+                    chunk.m_palette_indices);
+    }
+
+    chunk.m_chunk_index = m_chunk_index;
+    chunk.m_meshed_neighbors_mask = m_meshed_neighbors_mask;
+
+    return chunk;
+}
+
+// Chunk dimensions that are supported (see VX_CHUNK_DIMENSION in src/CMakeLists.txt).
+template struct BasicChunk<8u>;
+template struct BasicChunk<16u>;
+template struct BasicChunk<32u>;
+template struct BasicChunk<64u>;
@@ -0,0 +1,83 @@
+#include "voxel-engine/chunk_indirect_command_array.hpp"
+
+u32 ChunkIndirectCommandArray::add(const size_t owner, const ChunkIndirectCommand &command,
+                                   const DirectX::XMFLOAT3 bounds_min)
+{
+    const u32 handle = static_cast<u32>(m_commands.size());
+
+    m_commands.push_back(command);
+    m_owners.push_back(owner);
+
+    m_bounds_min_x.push_back(bounds_min.x);
+    m_bounds_min_y.push_back(bounds_min.y);
+    m_bounds_min_z.push_back(bounds_min.z);
+
+    mark_dirty(handle);
+
+    return handle;
+}
+
+std::optional<size_t> ChunkIndirectCommandArray::remove(const u32 handle)
+{
+    const u32 last_handle = static_cast<u32>(m_commands.size() - 1u);
+
+    std::optional<size_t> moved_owner{};
+    if (handle != last_handle)
+    {
+        m_commands[handle] = m_commands[last_handle];
+        m_owners[handle] = m_owners[last_handle];
+
+        m_bounds_min_x[handle] = m_bounds_min_x[last_handle];
+        m_bounds_min_y[handle] = m_bounds_min_y[last_handle];
+        m_bounds_min_z[handle] = m_bounds_min_z[last_handle];
+
+        moved_owner = m_owners[handle];
+
+        mark_dirty(handle);
+    }
+
+    m_commands.pop_back();
+    m_owners.pop_back();
+
+    m_bounds_min_x.pop_back();
+    m_bounds_min_y.pop_back();
+    m_bounds_min_z.pop_back();
+
+    return moved_owner;
+}
+
+void ChunkIndirectCommandArray::set(const u32 handle, const ChunkIndirectCommand &command)
+{
+    if (memcmp(&m_commands[handle], &command, sizeof(ChunkIndirectCommand)) != 0)
+    {
+        m_commands[handle] = command;
+        mark_dirty(handle);
+    }
+}
+
+size_t ChunkIndirectCommandArray::size() const
+{
+    return m_commands.size();
+}
+
+void ChunkIndirectCommandArray::mark_dirty(const u32 command_index)
+{
+    if (command_index >= m_is_command_dirty.size())
+    {
+        m_is_command_dirty.resize(command_index + 1u, false);
+    }
+
+    if (!m_is_command_dirty[command_index])
+    {
+        m_is_command_dirty[command_index] = true;
+        m_dirty_command_indices.push_back(command_index);
+    }
+}
+
+void ChunkIndirectCommandArray::mark_all_dirty()
+{
+    for (u32 command_index = 0u; command_index < static_cast<u32>(m_commands.size()); command_index++)
+    {
+        mark_dirty(command_index);
+    }
+}
@@ -0,0 +1,118 @@
+#include "voxel-engine/chunk_load_scheduler.hpp"
+
+ChunkLoadScheduler::View ChunkLoadScheduler::View::create(const DirectX::XMFLOAT3 position,
+                                                          const DirectX::XMFLOAT3 front, const float vertical_fov,
+                                                          const float aspect_ratio)
+{
+    const float tan_half_vertical_fov = std::tan(vertical_fov * 0.5f);
+    const float tan_half_horizontal_fov = tan_half_vertical_fov * aspect_ratio;
+
+    const float half_fov = std::atan(std::sqrt(tan_half_vertical_fov * tan_half_vertical_fov +
+                                               tan_half_horizontal_fov * tan_half_horizontal_fov));
+
+    return View{
+        .m_position = position,
+        .m_front = front,
+        .m_cos_half_fov = std::cos(half_fov),
+        .m_sin_half_fov = std::sin(half_fov),
+    };
+}
+
+ChunkLoadScheduler::ChunkLoadScheduler(const size_t max_number_of_pending_chunks)
+    : m_max_number_of_pending_chunks(max_number_of_pending_chunks)
+{
+    m_pending_chunks.reserve(max_number_of_pending_chunks);
+}
+
+void ChunkLoadScheduler::add(const size_t chunk_index, const DirectX::XMUINT3 chunk_index_3d)
+{
+    m_pending_chunks.push_back(PendingChunk{
+        .m_score = get_score(chunk_index_3d),
+        .m_chunk_index = chunk_index,
+        .m_chunk_index_3d = chunk_index_3d,
+    });
+    std::push_heap(m_pending_chunks.begin(), m_pending_chunks.end(), has_higher_score);
+}
+
+std::optional<size_t> ChunkLoadScheduler::pop()
+{
+    if (m_pending_chunks.empty())
+    {
+        return std::nullopt;
+    }
+
+    std::pop_heap(m_pending_chunks.begin(), m_pending_chunks.end(), has_higher_score);
+
+    const size_t chunk_index = m_pending_chunks.back().m_chunk_index;
+    m_pending_chunks.pop_back();
+
+    return chunk_index;
+}
+
+std::vector<size_t> ChunkLoadScheduler::set_view(const View &view)
+{
+    m_view = view;
+
+    for (PendingChunk &pending_chunk : m_pending_chunks)
+    {
+        pending_chunk.m_score = get_score(pending_chunk.m_chunk_index_3d);
+    }
+
+    // Trimming is done here rather than in add, so that it costs a single partition per frame.
+    std::vector<size_t> dropped_chunk_indices{};
+    if (m_pending_chunks.size() > m_max_number_of_pending_chunks)
+    {
+        const auto first_dropped_chunk = m_pending_chunks.begin() + m_max_number_of_pending_chunks;
+        std::nth_element(m_pending_chunks.begin(), first_dropped_chunk, m_pending_chunks.end(),
+                         [](const PendingChunk &a, const PendingChunk &b) { return a.m_score < b.m_score; });
+
+        for (auto pending_chunk = first_dropped_chunk; pending_chunk != m_pending_chunks.end(); ++pending_chunk)
+        {
+            dropped_chunk_indices.push_back(pending_chunk->m_chunk_index);
+        }
+
+        m_pending_chunks.erase(first_dropped_chunk, m_pending_chunks.end());
+    }
+
+    std::make_heap(m_pending_chunks.begin(), m_pending_chunks.end(), has_higher_score);
+
+    return dropped_chunk_indices;
+}
+
+size_t ChunkLoadScheduler::get_number_of_pending_chunks() const
+{
+    return m_pending_chunks.size();
+}
+
+float ChunkLoadScheduler::get_score(const DirectX::XMUINT3 chunk_index_3d) const
+{
+    const DirectX::XMFLOAT3 to_chunk = {
+        static_cast<float>(chunk_index_3d.x) + 0.5f - m_view.m_position.x,
+        static_cast<float>(chunk_index_3d.y) + 0.5f - m_view.m_position.y,
+        static_cast<float>(chunk_index_3d.z) + 0.5f - m_view.m_position.z,
+    };
+
+    const float distance = std::sqrt(to_chunk.x * to_chunk.x + to_chunk.y * to_chunk.y + to_chunk.z * to_chunk.z);
+    if (distance < NEARBY_CHUNK_DISTANCE)
+    {
+        return distance;
+    }
+
+    // Cosine of the angle between the camera front and the direction towards the chunk center.
+    const float alignment =
+        (to_chunk.x * m_view.m_front.x + to_chunk.y * m_view.m_front.y + to_chunk.z * m_view.m_front.z) / distance;
+
+    // The chunk is in view if its bounding sphere intersects the frustum cone, i.e if the angle towards the chunk is
+    // at most the half fov plus the angle subtended by the sphere. Both angles are below 90 degrees (the chunk is not
+    // nearby), so the test is done on their cosines : cos(a + b) = cos(a) * cos(b) - sin(a) * sin(b).
+    static constexpr float CHUNK_BOUNDING_SPHERE_RADIUS = 0.8660254f;
+    const float sin_sphere_angle = CHUNK_BOUNDING_SPHERE_RADIUS / distance;
+    const float cos_sphere_angle = std::sqrt(1.0f - sin_sphere_angle * sin_sphere_angle);
+    const bool is_in_view =
+        alignment >= m_view.m_cos_half_fov * cos_sphere_angle - m_view.m_sin_half_fov * sin_sphere_angle;
+
+    // Among chunks in view, the ones in the center of the view are loaded first.
+    const float score = distance * (2.0f - alignment);
+
+    return is_in_view ? score : score * OUT_OF_VIEW_SCORE_MULTIPLIER;
+}
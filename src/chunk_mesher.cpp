@@ -0,0 +1,724 @@
+#include "voxel-engine/chunk_mesher.hpp"
+
+namespace ChunkMesher
+{
+// Offsets (from the voxel position) of the 8 corners of a voxel, in the order used by NAIVE_FACE_VERTEX_INDICES.
+static constexpr std::array<DirectX::XMUINT3, 8> VOXEL_CORNER_OFFSETS = {{
+    {0u, 0u, 0u},
+    {0u, 1u, 0u},
+    {1u, 1u, 0u},
+    {1u, 0u, 0u},
+    {0u, 0u, 1u},
+    {0u, 1u, 1u},
+    {1u, 1u, 1u},
+    {1u, 0u, 1u},
+}};
+
+// Corners (in unit cube coordinates) of a face, in the order A, B, C, D. Each face is emitted as the triangles ABC and
+// ACD, which matches the winding used by the naive mesher.
+static constexpr std::array<std::array<DirectX::XMUINT3, 4>, NUMBER_OF_FACE_DIRECTIONS> FACE_CORNERS = {{
+    {{{0u, 0u, 0u}, {0u, 1u, 0u}, {1u, 1u, 0u}, {1u, 0u, 0u}}},
+    {{{0u, 0u, 1u}, {1u, 0u, 1u}, {1u, 1u, 1u}, {0u, 1u, 1u}}},
+    {{{0u, 0u, 1u}, {0u, 1u, 1u}, {0u, 1u, 0u}, {0u, 0u, 0u}}},
+    {{{1u, 0u, 0u}, {1u, 1u, 0u}, {1u, 1u, 1u}, {1u, 0u, 1u}}},
+    {{{0u, 1u, 0u}, {0u, 1u, 1u}, {1u, 1u, 1u}, {1u, 1u, 0u}}},
+    {{{0u, 0u, 1u}, {0u, 0u, 0u}, {1u, 0u, 0u}, {1u, 0u, 1u}}},
+}};
+
+// A lattice point is a voxel corner, with coordinates in the range [0, N]. Return the index of its vertex in the shared
+// position buffer.
+template <u32 N>
+static inline mesh_index_t<N> get_shared_vertex_index(const DirectX::XMUINT3 lattice_point)
+{
+    return static_cast<mesh_index_t<N>>(lattice_point.x + lattice_point.y * (N + 1u) +
+                                        lattice_point.z * (N + 1u) * (N + 1u));
+}
+
+// Emit a (possibly merged) quad. min and max are lattice points : the extent of the quad along the face normal is
+// always one voxel (or one cell of a downsampled mesh).
+template <u32 N>
+static inline void emit_quad(const FaceDirection face_direction, const DirectX::XMUINT3 min,
+                             const DirectX::XMUINT3 max, const DirectX::XMFLOAT3 color, BasicChunkMesh<N> &mesh)
+{
+    std::array<mesh_index_t<N>, 4> corner_indices{};
+    for (u32 i = 0; i < 4u; i++)
+    {
+        const DirectX::XMUINT3 &corner = FACE_CORNERS[static_cast<u32>(face_direction)][i];
+        corner_indices[i] = get_shared_vertex_index<N>({
+            corner.x ? max.x : min.x,
+            corner.y ? max.y : min.y,
+            corner.z ? max.z : min.z,
+        });
+    }
+
+    mesh.m_colors.emplace_back(color);
+    for (const auto &corner : {0u, 1u, 2u, 0u, 2u, 3u})
+    {
+        mesh.m_indices.push_back(corner_indices[corner]);
+    }
+}
+
+// Greedy merge : For each row, take the first run of set bits, and extend it over the following rows for as long as
+// they contain the entire run. The merged bits are cleared so they are not emitted again.
+// Slices, rows and bits are cells of scale voxels per dimension (see downsampled_greedy_mesh).
+template <u32 N>
+static void greedy_merge_slice(const FaceDirection face_direction, const u32 slice, std::array<u64, N> &rows,
+                               const DirectX::XMFLOAT3 color, const u32 scale, BasicChunkMesh<N> &mesh)
+{
+    for (u32 row_index = 0; row_index < N; row_index++)
+    {
+        while (rows[row_index])
+        {
+            const u32 bit_start = static_cast<u32>(std::countr_zero(rows[row_index]));
+            const u32 bit_count = static_cast<u32>(std::countr_one(rows[row_index] >> bit_start));
+
+            const u64 run_mask = (bit_count == 64u ? ~0ull : ((1ull << bit_count) - 1ull)) << bit_start;
+
+            u32 row_count = 1u;
+            while (row_index + row_count < N && (rows[row_index + row_count] & run_mask) == run_mask)
+            {
+                rows[row_index + row_count] &= ~run_mask;
+                ++row_count;
+            }
+            rows[row_index] &= ~run_mask;
+
+            // Convert (slice, rows, bits) back into lattice points.
+            const u32 slice_min = slice * scale;
+            const u32 slice_max = (slice + 1u) * scale;
+            const u32 bit_min = bit_start * scale;
+            const u32 bit_max = (bit_start + bit_count) * scale;
+            const u32 row_min = row_index * scale;
+            const u32 row_max = (row_index + row_count) * scale;
+
+            switch (face_direction)
+            {
+            case FaceDirection::Left:
+            case FaceDirection::Right: {
+                emit_quad(face_direction, {slice_min, bit_min, row_min}, {slice_max, bit_max, row_max}, color, mesh);
+            }
+            break;
+
+            case FaceDirection::Top:
+            case FaceDirection::Bottom: {
+                emit_quad(face_direction, {bit_min, slice_min, row_min}, {bit_max, slice_max, row_max}, color, mesh);
+            }
+            break;
+
+            case FaceDirection::Front:
+            case FaceDirection::Back: {
+                emit_quad(face_direction, {bit_min, row_min, slice_min}, {bit_max, row_max, slice_max}, color, mesh);
+            }
+            break;
+            }
+        }
+    }
+}
+
+// Corners (see VOXEL_CORNER_OFFSETS) of the 2 triangles of each face of the naive mesher, in FaceDirection order.
+static constexpr std::array<std::array<u32, 6>, NUMBER_OF_FACE_DIRECTIONS> NAIVE_FACE_VERTEX_INDICES = {{
+    {0u, 1u, 2u, 0u, 2u, 3u},
+    {4u, 6u, 5u, 4u, 7u, 6u},
+    {4u, 5u, 1u, 4u, 1u, 0u},
+    {3u, 2u, 6u, 3u, 6u, 7u},
+    {1u, 5u, 6u, 1u, 6u, 2u},
+    {4u, 0u, 3u, 4u, 3u, 7u},
+}};
+
+// Check if there is a voxel that blocks the face of the voxel in the given direction. Voxels outside the chunk are read
+// from the neighbor apron.
+template <u32 N>
+static inline bool is_face_covered(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron,
+                                   const DirectX::XMUINT3 index_3d, const FaceDirection face_direction)
+{
+    const DirectX::XMINT3 offset = FACE_DIRECTION_OFFSETS[static_cast<u32>(face_direction)];
+    const DirectX::XMUINT3 neighbor_index_3d = {
+        index_3d.x + offset.x,
+        index_3d.y + offset.y,
+        index_3d.z + offset.z,
+    };
+
+    // Going below zero wraps around to a very large value, so a single comparison per axis is enough.
+    if (neighbor_index_3d.x < N && neighbor_index_3d.y < N && neighbor_index_3d.z < N)
+    {
+        return chunk.is_voxel_active(neighbor_index_3d);
+    }
+
+    switch (face_direction)
+    {
+    case FaceDirection::Front:
+    case FaceDirection::Back: {
+        return apron.is_voxel_active(face_direction, index_3d.y, index_3d.x);
+    }
+    break;
+
+    case FaceDirection::Left:
+    case FaceDirection::Right: {
+        return apron.is_voxel_active(face_direction, index_3d.z, index_3d.y);
+    }
+    break;
+
+    case FaceDirection::Top:
+    case FaceDirection::Bottom: {
+        return apron.is_voxel_active(face_direction, index_3d.z, index_3d.x);
+    }
+    break;
+    }
+
+    return false;
+}
+
+template <u32 N>
+void naive_mesh(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron, BasicChunkMesh<N> &mesh)
+{
+    // The faces are emitted into one mesh per direction, which are then appended to the mesh, so that the faces are
+    // grouped by direction with a single pass over the voxels. The meshes are kept per thread, like the scratch mesh.
+    thread_local std::array<BasicChunkMesh<N>, NUMBER_OF_FACE_DIRECTIONS> face_direction_meshes{};
+    for (BasicChunkMesh<N> &face_direction_mesh : face_direction_meshes)
+    {
+        face_direction_mesh.clear();
+    }
+
+    // Only the active voxels are visited, from the occupancy rows.
+    for (u32 z = 0; z < N; z++)
+    {
+        for (u32 y = 0; y < N; y++)
+        {
+            u64 row = chunk.get_row(y, z);
+            while (row)
+            {
+                const DirectX::XMUINT3 index_3d = {static_cast<u32>(std::countr_zero(row)), y, z};
+                row &= row - 1ull;
+
+                const auto voxel_color = BLOCK_TYPE_COLORS[static_cast<u32>(chunk.get_block_type(index_3d))];
+
+                for (u32 face = 0; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+                {
+                    if (is_face_covered(chunk, apron, index_3d, static_cast<FaceDirection>(face)))
+                    {
+                        continue;
+                    }
+
+                    BasicChunkMesh<N> &face_direction_mesh = face_direction_meshes[face];
+
+                    face_direction_mesh.m_colors.emplace_back(voxel_color);
+                    for (const u32 vertex_index : NAIVE_FACE_VERTEX_INDICES[face])
+                    {
+                        const DirectX::XMUINT3 &corner_offset = VOXEL_CORNER_OFFSETS[vertex_index];
+                        face_direction_mesh.m_indices.push_back(get_shared_vertex_index<N>({
+                            index_3d.x + corner_offset.x,
+                            index_3d.y + corner_offset.y,
+                            index_3d.z + corner_offset.z,
+                        }));
+                    }
+                }
+            }
+        }
+    }
+
+    for (u32 face = 0; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+    {
+        const FaceDirection face_direction = static_cast<FaceDirection>(face);
+        const BasicChunkMesh<N> &face_direction_mesh = face_direction_meshes[face];
+
+        mesh.begin_face_direction(face_direction);
+        mesh.m_indices.insert(mesh.m_indices.end(), face_direction_mesh.m_indices.begin(),
+                              face_direction_mesh.m_indices.end());
+        mesh.m_colors.insert(mesh.m_colors.end(), face_direction_mesh.m_colors.begin(),
+                             face_direction_mesh.m_colors.end());
+        mesh.end_face_direction(face_direction);
+    }
+}
+
+template <u32 N>
+void binary_greedy_mesh(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron, BasicChunkMesh<N> &mesh)
+{
+    // Visible face masks, indexed as [face direction][slice][row]. A slice is a plane perpendicular to the face normal,
+    // and the bits of each row run along one of the axes of that plane :
+    // (i) Left / Right : slice = x, row = z, bits along y.
+    // (ii) Top / Bottom : slice = y, row = z, bits along x.
+    // (iii) Front / Back : slice = z, row = y, bits along x.
+    std::array<std::array<std::array<u64, N>, N>, NUMBER_OF_FACE_DIRECTIONS> face_masks{};
+
+    auto &front_masks = face_masks[static_cast<u32>(FaceDirection::Front)];
+    auto &back_masks = face_masks[static_cast<u32>(FaceDirection::Back)];
+    auto &left_masks = face_masks[static_cast<u32>(FaceDirection::Left)];
+    auto &right_masks = face_masks[static_cast<u32>(FaceDirection::Right)];
+    auto &top_masks = face_masks[static_cast<u32>(FaceDirection::Top)];
+    auto &bottom_masks = face_masks[static_cast<u32>(FaceDirection::Bottom)];
+
+    for (u32 z = 0; z < N; z++)
+    {
+        for (u32 y = 0; y < N; y++)
+        {
+            const u64 row = chunk.get_row(y, z);
+            if (row == 0ull)
+            {
+                continue;
+            }
+
+            // A voxel has a visible face in some direction if the neighboring voxel in that direction is empty.
+            // Voxels outside the chunk are read from the neighbor apron.
+            const auto &apron_slabs = apron.m_slabs;
+
+            const u64 front_row =
+                z != 0u ? chunk.get_row(y, z - 1u) : apron_slabs[static_cast<u32>(FaceDirection::Front)][y];
+            const u64 back_row =
+                z != N - 1u ? chunk.get_row(y, z + 1u) : apron_slabs[static_cast<u32>(FaceDirection::Back)][y];
+            const u64 bottom_row =
+                y != 0u ? chunk.get_row(y - 1u, z) : apron_slabs[static_cast<u32>(FaceDirection::Bottom)][z];
+            const u64 top_row =
+                y != N - 1u ? chunk.get_row(y + 1u, z) : apron_slabs[static_cast<u32>(FaceDirection::Top)][z];
+
+            front_masks[z][y] = row & ~front_row;
+            back_masks[z][y] = row & ~back_row;
+            bottom_masks[y][z] = row & ~bottom_row;
+            top_masks[y][z] = row & ~top_row;
+
+            // For the x axis, the neighbors are in the same row, so shift the row instead. The bit shifted in at the
+            // chunk border comes from the apron.
+            // Left / Right face masks are transposed so that the bits run along y.
+            const u64 left_apron_bit = (apron_slabs[static_cast<u32>(FaceDirection::Left)][z] >> y) & 1ull;
+            const u64 right_apron_bit = (apron_slabs[static_cast<u32>(FaceDirection::Right)][z] >> y) & 1ull;
+
+            u64 left_faces = row & ~((row << 1u) | left_apron_bit);
+            u64 right_faces = row & ~((row >> 1u) | (right_apron_bit << (N - 1u)));
+
+            while (left_faces)
+            {
+                const u32 x = static_cast<u32>(std::countr_zero(left_faces));
+                left_masks[x][z] |= 1ull << y;
+                left_faces &= left_faces - 1ull;
+            }
+
+            while (right_faces)
+            {
+                const u32 x = static_cast<u32>(std::countr_zero(right_faces));
+                right_masks[x][z] |= 1ull << y;
+                right_faces &= right_faces - 1ull;
+            }
+        }
+    }
+
+    // Only faces of the same block type can be merged. If the chunk has more than one block type, split the voxels of
+    // each palette entry into their own masks, in two layouts : bits along x (row = y + z * N), and bits along y
+    // (row = x + z * N) for the left / right faces.
+    // The masks are kept per thread, so their storage is re-used across chunks.
+    const size_t palette_size = chunk.m_palette_size;
+
+    thread_local std::vector<u64> palette_masks_along_x{};
+    thread_local std::vector<u64> palette_masks_along_y{};
+
+    if (palette_size > 1u)
+    {
+        palette_masks_along_x.assign(palette_size * BasicChunk<N>::NUMBER_OF_ROWS, 0ull);
+        palette_masks_along_y.assign(palette_size * BasicChunk<N>::NUMBER_OF_ROWS, 0ull);
+
+        for (u32 z = 0; z < N; z++)
+        {
+            for (u32 y = 0; y < N; y++)
+            {
+                u64 row = chunk.get_row(y, z);
+                while (row)
+                {
+                    const u32 x = static_cast<u32>(std::countr_zero(row));
+                    const size_t palette_offset = chunk.get_palette_index({x, y, z}) * BasicChunk<N>::NUMBER_OF_ROWS;
+
+                    palette_masks_along_x[palette_offset + y + z * N] |= 1ull << x;
+                    palette_masks_along_y[palette_offset + x + z * N] |= 1ull << y;
+
+                    row &= row - 1ull;
+                }
+            }
+        }
+    }
+
+    for (u32 face = 0; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+    {
+        const FaceDirection face_direction = static_cast<FaceDirection>(face);
+        mesh.begin_face_direction(face_direction);
+
+        for (u32 slice = 0; slice < N; slice++)
+        {
+            auto &rows = face_masks[face][slice];
+
+            if (palette_size <= 1u)
+            {
+                const BlockType block_type =
+                    palette_size == 0u ? BasicChunk<N>::DEFAULT_BLOCK_TYPE : chunk.m_palette[0];
+                greedy_merge_slice<N>(face_direction, slice, rows, BLOCK_TYPE_COLORS[static_cast<u32>(block_type)],
+                                      1u, mesh);
+
+                continue;
+            }
+
+            for (size_t palette_index = 0; palette_index < palette_size; palette_index++)
+            {
+                const size_t palette_offset = palette_index * BasicChunk<N>::NUMBER_OF_ROWS;
+
+                std::array<u64, N> block_type_rows{};
+                u64 combined_rows = 0ull;
+
+                for (u32 row_index = 0; row_index < N; row_index++)
+                {
+                    switch (face_direction)
+                    {
+                    case FaceDirection::Left:
+                    case FaceDirection::Right: {
+                        block_type_rows[row_index] =
+                            rows[row_index] & palette_masks_along_y[palette_offset + slice + row_index * N];
+                    }
+                    break;
+
+                    case FaceDirection::Top:
+                    case FaceDirection::Bottom: {
+                        block_type_rows[row_index] =
+                            rows[row_index] & palette_masks_along_x[palette_offset + slice + row_index * N];
+                    }
+                    break;
+
+                    case FaceDirection::Front:
+                    case FaceDirection::Back: {
+                        block_type_rows[row_index] =
+                            rows[row_index] & palette_masks_along_x[palette_offset + row_index + slice * N];
+                    }
+                    break;
+                    }
+
+                    combined_rows |= block_type_rows[row_index];
+                }
+
+                if (combined_rows != 0ull)
+                {
+                    greedy_merge_slice<N>(face_direction, slice, block_type_rows,
+                                          BLOCK_TYPE_COLORS[static_cast<u32>(chunk.m_palette[palette_index])], 1u,
+                                          mesh);
+                }
+            }
+        }
+
+        mesh.end_face_direction(face_direction);
+    }
+}
+
+// Reduces each run of scale bits of the row (i.e each cell) to a single bit, which is set if any (or all) of the bits
+// of the run are set.
+static u64 downsample_row(const u64 row, const u32 scale, const u32 number_of_cells, const bool require_all_bits)
+{
+    const u64 cell_mask = (1ull << scale) - 1ull;
+
+    u64 cells = 0ull;
+    for (u32 cell = 0u; cell < number_of_cells; cell++)
+    {
+        const u64 bits = (row >> (cell * scale)) & cell_mask;
+        const bool is_cell_set = require_all_bits ? bits == cell_mask : bits != 0ull;
+        cells |= static_cast<u64>(is_cell_set) << cell;
+    }
+
+    return cells;
+}
+
+template <u32 N>
+void downsampled_greedy_mesh(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron, const u32 lod,
+                             BasicChunkMesh<N> &mesh)
+{
+    const u32 scale = 1u << lod;
+    const u32 number_of_cells_per_dimension = N >> lod;
+    const u32 number_of_cell_rows = number_of_cells_per_dimension * number_of_cells_per_dimension;
+    const u32 cell_row_length = number_of_cells_per_dimension;
+
+    // Cell occupancy rows, indexed by (y + z * number of cells per dimension), with the bits along x. A cell is active
+    // if any of its voxels is, so the downsampled volume contains the voxels of the chunk and never opens holes.
+    thread_local std::vector<u64> cell_rows{};
+    cell_rows.assign(number_of_cell_rows, 0ull);
+
+    for (u32 cell_z = 0u; cell_z < number_of_cells_per_dimension; cell_z++)
+    {
+        for (u32 cell_y = 0u; cell_y < number_of_cells_per_dimension; cell_y++)
+        {
+            u64 row = 0ull;
+            for (u32 z = cell_z * scale; z < (cell_z + 1u) * scale; z++)
+            {
+                for (u32 y = cell_y * scale; y < (cell_y + 1u) * scale; y++)
+                {
+                    row |= chunk.get_row(y, z);
+                }
+            }
+
+            cell_rows[cell_y + cell_z * cell_row_length] = downsample_row(row, scale, cell_row_length, false);
+        }
+    }
+
+    // A face on the border of the chunk is only covered if the neighbor voxels in front of the entire face of the cell
+    // are active. Neighbors are usually meshed at another level of detail (or not at all), so this is conservative :
+    // wherever the downsampled surface of the chunk does not meet the one of the neighbor, border faces close the gap.
+    BasicChunkNeighborApron<N> cell_apron{};
+    for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+    {
+        for (u32 cell_row = 0u; cell_row < number_of_cells_per_dimension; cell_row++)
+        {
+            u64 row = ~0ull;
+            for (u32 apron_row = cell_row * scale; apron_row < (cell_row + 1u) * scale; apron_row++)
+            {
+                row &= apron.m_slabs[face][apron_row];
+            }
+
+            cell_apron.m_slabs[face][cell_row] = downsample_row(row, scale, cell_row_length, true);
+        }
+    }
+
+    // The block type of a cell is the one of its highest active voxel, i.e the surface seen from above.
+    const auto get_cell_block_type = [&](const u32 cell_x, const u32 cell_y, const u32 cell_z) {
+        const u64 cell_mask = ((1ull << scale) - 1ull) << (cell_x * scale);
+        for (u32 y = (cell_y + 1u) * scale; y-- > cell_y * scale;)
+        {
+            for (u32 z = cell_z * scale; z < (cell_z + 1u) * scale; z++)
+            {
+                const u64 bits = chunk.get_row(y, z) & cell_mask;
+                if (bits != 0ull)
+                {
+                    return chunk.get_block_type({static_cast<u32>(std::countr_zero(bits)), y, z});
+                }
+            }
+        }
+
+        return BasicChunk<N>::DEFAULT_BLOCK_TYPE;
+    };
+
+    // Cells of each block type, in the same two layouts as the palette masks of binary_greedy_mesh.
+    thread_local std::vector<u64> block_type_masks_along_x{};
+    thread_local std::vector<u64> block_type_masks_along_y{};
+    block_type_masks_along_x.assign(NUMBER_OF_BLOCK_TYPES * number_of_cell_rows, 0ull);
+    block_type_masks_along_y.assign(NUMBER_OF_BLOCK_TYPES * number_of_cell_rows, 0ull);
+
+    u32 block_types_mask = 0u;
+    for (u32 cell_z = 0u; cell_z < number_of_cells_per_dimension; cell_z++)
+    {
+        for (u32 cell_y = 0u; cell_y < number_of_cells_per_dimension; cell_y++)
+        {
+            u64 row = cell_rows[cell_y + cell_z * cell_row_length];
+            while (row)
+            {
+                const u32 cell_x = static_cast<u32>(std::countr_zero(row));
+                const u32 block_type = static_cast<u32>(get_cell_block_type(cell_x, cell_y, cell_z));
+                const size_t block_type_offset = static_cast<size_t>(block_type) * number_of_cell_rows;
+
+                block_types_mask |= 1u << block_type;
+                block_type_masks_along_x[block_type_offset + cell_y + cell_z * cell_row_length] |= 1ull << cell_x;
+                block_type_masks_along_y[block_type_offset + cell_x + cell_z * cell_row_length] |= 1ull << cell_y;
+
+                row &= row - 1ull;
+            }
+        }
+    }
+
+    // Same layout as in binary_greedy_mesh, over cells rather than voxels.
+    std::array<std::array<std::array<u64, N>, N>, NUMBER_OF_FACE_DIRECTIONS> face_masks{};
+
+    auto &front_masks = face_masks[static_cast<u32>(FaceDirection::Front)];
+    auto &back_masks = face_masks[static_cast<u32>(FaceDirection::Back)];
+    auto &left_masks = face_masks[static_cast<u32>(FaceDirection::Left)];
+    auto &right_masks = face_masks[static_cast<u32>(FaceDirection::Right)];
+    auto &top_masks = face_masks[static_cast<u32>(FaceDirection::Top)];
+    auto &bottom_masks = face_masks[static_cast<u32>(FaceDirection::Bottom)];
+
+    const u32 last_cell = number_of_cells_per_dimension - 1u;
+    const auto &apron_slabs = cell_apron.m_slabs;
+
+    for (u32 z = 0; z < number_of_cells_per_dimension; z++)
+    {
+        for (u32 y = 0; y < number_of_cells_per_dimension; y++)
+        {
+            const u64 row = cell_rows[y + z * cell_row_length];
+            if (row == 0ull)
+            {
+                continue;
+            }
+
+            const u64 front_row = z != 0u ? cell_rows[y + (z - 1u) * cell_row_length]
+                                          : apron_slabs[static_cast<u32>(FaceDirection::Front)][y];
+            const u64 back_row = z != last_cell ? cell_rows[y + (z + 1u) * cell_row_length]
+                                                : apron_slabs[static_cast<u32>(FaceDirection::Back)][y];
+            const u64 bottom_row = y != 0u ? cell_rows[y - 1u + z * cell_row_length]
+                                           : apron_slabs[static_cast<u32>(FaceDirection::Bottom)][z];
+            const u64 top_row = y != last_cell ? cell_rows[y + 1u + z * cell_row_length]
+                                               : apron_slabs[static_cast<u32>(FaceDirection::Top)][z];
+
+            front_masks[z][y] = row & ~front_row;
+            back_masks[z][y] = row & ~back_row;
+            bottom_masks[y][z] = row & ~bottom_row;
+            top_masks[y][z] = row & ~top_row;
+
+            const u64 left_apron_bit = (apron_slabs[static_cast<u32>(FaceDirection::Left)][z] >> y) & 1ull;
+            const u64 right_apron_bit = (apron_slabs[static_cast<u32>(FaceDirection::Right)][z] >> y) & 1ull;
+
+            u64 left_faces = row & ~((row << 1u) | left_apron_bit);
+            u64 right_faces = row & ~((row >> 1u) | (right_apron_bit << last_cell));
+
+            while (left_faces)
+            {
+                const u32 x = static_cast<u32>(std::countr_zero(left_faces));
+                left_masks[x][z] |= 1ull << y;
+                left_faces &= left_faces - 1ull;
+            }
+
+            while (right_faces)
+            {
+                const u32 x = static_cast<u32>(std::countr_zero(right_faces));
+                right_masks[x][z] |= 1ull << y;
+                right_faces &= right_faces - 1ull;
+            }
+        }
+    }
+
+    for (u32 face = 0; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+    {
+        const FaceDirection face_direction = static_cast<FaceDirection>(face);
+        mesh.begin_face_direction(face_direction);
+
+        for (u32 slice = 0; slice < number_of_cells_per_dimension; slice++)
+        {
+            const auto &rows = face_masks[face][slice];
+
+            for (u32 block_type = 0u; block_type < NUMBER_OF_BLOCK_TYPES; block_type++)
+            {
+                if (!((block_types_mask >> block_type) & 1u))
+                {
+                    continue;
+                }
+
+                const size_t block_type_offset = static_cast<size_t>(block_type) * number_of_cell_rows;
+
+                std::array<u64, N> block_type_rows{};
+                u64 combined_rows = 0ull;
+
+                for (u32 row_index = 0; row_index < number_of_cells_per_dimension; row_index++)
+                {
+                    switch (face_direction)
+                    {
+                    case FaceDirection::Left:
+                    case FaceDirection::Right: {
+                        block_type_rows[row_index] =
+                            rows[row_index] &
+                            block_type_masks_along_y[block_type_offset + slice + row_index * cell_row_length];
+                    }
+                    break;
+
+                    case FaceDirection::Top:
+                    case FaceDirection::Bottom: {
+                        block_type_rows[row_index] =
+                            rows[row_index] &
+                            block_type_masks_along_x[block_type_offset + slice + row_index * cell_row_length];
+                    }
+                    break;
+
+                    case FaceDirection::Front:
+                    case FaceDirection::Back: {
+                        block_type_rows[row_index] =
+                            rows[row_index] &
+                            block_type_masks_along_x[block_type_offset + row_index + slice * cell_row_length];
+                    }
+                    break;
+                    }
+
+                    combined_rows |= block_type_rows[row_index];
+                }
+
+                if (combined_rows != 0ull)
+                {
+                    greedy_merge_slice<N>(face_direction, slice, block_type_rows, BLOCK_TYPE_COLORS[block_type], scale,
+                                          mesh);
+                }
+            }
+        }
+
+        mesh.end_face_direction(face_direction);
+    }
+}
+
+template <u32 N>
+bool is_mesh_required(const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron)
+{
+    switch (chunk.m_occupancy_state)
+    {
+    case OccupancyState::Empty: {
+        return false;
+    }
+    break;
+
+    case OccupancyState::Full: {
+        static constexpr u8 ALL_NEIGHBORS_MASK = (1u << NUMBER_OF_FACE_DIRECTIONS) - 1u;
+        if (apron.m_available_neighbors_mask != ALL_NEIGHBORS_MASK)
+        {
+            return true;
+        }
+
+        for (const auto &slab : apron.m_slabs)
+        {
+            for (const u64 row : slab)
+            {
+                if (row != BasicChunk<N>::FULL_ROW_MASK)
+                {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+    break;
+
+    case OccupancyState::Mixed: {
+        return true;
+    }
+    break;
+    }
+
+    return true;
+}
+
+template <u32 N>
+void mesh(const MeshingMode meshing_mode, const BasicChunk<N> &chunk, const BasicChunkNeighborApron<N> &apron,
+          BasicChunkMesh<N> &mesh)
+{
+    switch (meshing_mode)
+    {
+    case MeshingMode::Naive: {
+        naive_mesh(chunk, apron, mesh);
+    }
+    break;
+
+    case MeshingMode::BinaryGreedy: {
+        binary_greedy_mesh(chunk, apron, mesh);
+    }
+    break;
+    }
+}
+
+template <u32 N>
+BasicChunkMesh<N> &get_scratch_mesh()
+{
+    thread_local BasicChunkMesh<N> scratch_mesh{};
+    scratch_mesh.clear();
+
+    return scratch_mesh;
+}
+
+// Chunk dimensions that are supported (see chunk.cpp).
+#define VX_INSTANTIATE_CHUNK_MESHER(N)                                                                                 \
+    template bool is_mesh_required<N>(const BasicChunk<N> &, const BasicChunkNeighborApron<N> &);                      \
+    template void naive_mesh<N>(const BasicChunk<N> &, const BasicChunkNeighborApron<N> &, BasicChunkMesh<N> &);       \
+    template void binary_greedy_mesh<N>(const BasicChunk<N> &, const BasicChunkNeighborApron<N> &,                     \
+                                        BasicChunkMesh<N> &);                                                          \
+    template void downsampled_greedy_mesh<N>(const BasicChunk<N> &, const BasicChunkNeighborApron<N> &, const u32,     \
+                                             BasicChunkMesh<N> &);                                                     \
+    template void mesh<N>(const MeshingMode, const BasicChunk<N> &, const BasicChunkNeighborApron<N> &,                \
+                          BasicChunkMesh<N> &);                                                                        \
+    template BasicChunkMesh<N> &get_scratch_mesh<N>();
+
+VX_INSTANTIATE_CHUNK_MESHER(8u)
+VX_INSTANTIATE_CHUNK_MESHER(16u)
+VX_INSTANTIATE_CHUNK_MESHER(32u)
+VX_INSTANTIATE_CHUNK_MESHER(64u)
+
+#undef VX_INSTANTIATE_CHUNK_MESHER
+} // namespace ChunkMesher
@@ -0,0 +1,428 @@
+#include "voxel-engine/chunk_octree.hpp"
+
+static u32 get_child_slot(const DirectX::XMUINT3 chunk_index_3d, const u32 child_level)
+{
+    return ((chunk_index_3d.x >> child_level) & 1u) | (((chunk_index_3d.y >> child_level) & 1u) << 1u) |
+           (((chunk_index_3d.z >> child_level) & 1u) << 2u);
+}
+
+static DirectX::XMUINT3 get_node_origin(const DirectX::XMUINT3 chunk_index_3d, const u32 level)
+{
+    const u32 mask = ~((1u << level) - 1u);
+    return {chunk_index_3d.x & mask, chunk_index_3d.y & mask, chunk_index_3d.z & mask};
+}
+
+u32 ChunkOctree::allocate_node(const DirectX::XMUINT3 origin, const u32 level, const u32 parent)
+{
+    Node node{
+        .m_origin = origin,
+        .m_level = level,
+        .m_parent = parent,
+    };
+    node.m_children.fill(INVALID_NODE);
+
+    if (!m_free_nodes.empty())
+    {
+        const u32 node_index = m_free_nodes.back();
+        m_free_nodes.pop_back();
+
+        m_nodes[node_index] = node;
+        return node_index;
+    }
+
+    m_nodes.push_back(node);
+    return static_cast<u32>(m_nodes.size() - 1u);
+}
+
+void ChunkOctree::free_node(const u32 node_index)
+{
+    m_nodes[node_index].m_number_of_chunks = 0u;
+    m_free_nodes.push_back(node_index);
+}
+
+u32 ChunkOctree::find_leaf(const DirectX::XMUINT3 chunk_index_3d) const
+{
+    const DirectX::XMUINT3 root_origin = get_node_origin(chunk_index_3d, ROOT_LEVEL);
+    const auto root = std::find_if(m_roots.begin(), m_roots.end(), [&](const u32 node_index) {
+        const DirectX::XMUINT3 origin = m_nodes[node_index].m_origin;
+        return origin.x == root_origin.x && origin.y == root_origin.y && origin.z == root_origin.z;
+    });
+
+    if (root == m_roots.end())
+    {
+        return INVALID_NODE;
+    }
+
+    u32 node_index = *root;
+    for (u32 level = ROOT_LEVEL; level > 0u && node_index != INVALID_NODE; level--)
+    {
+        node_index = m_nodes[node_index].m_children[get_child_slot(chunk_index_3d, level - 1u)];
+    }
+
+    return node_index;
+}
+
+void ChunkOctree::refresh_node(const u32 node_index)
+{
+    Node &node = m_nodes[node_index];
+
+    node.m_number_of_chunks = 0u;
+    node.m_any_flags = 0u;
+    node.m_all_flags = std::numeric_limits<u8>::max();
+    node.m_mesh_bounds_min = {std::numeric_limits<u32>::max(), std::numeric_limits<u32>::max(),
+                              std::numeric_limits<u32>::max()};
+    node.m_mesh_bounds_max = {};
+
+    for (const u32 child_index : node.m_children)
+    {
+        if (child_index == INVALID_NODE)
+        {
+            continue;
+        }
+
+        const Node &child = m_nodes[child_index];
+        node.m_number_of_chunks += child.m_number_of_chunks;
+        node.m_any_flags |= child.m_any_flags;
+        node.m_all_flags &= child.m_all_flags;
+
+        if (child.m_any_flags & FLAG_HAS_MESH)
+        {
+            node.m_mesh_bounds_min = {
+                std::min(node.m_mesh_bounds_min.x, child.m_mesh_bounds_min.x),
+                std::min(node.m_mesh_bounds_min.y, child.m_mesh_bounds_min.y),
+                std::min(node.m_mesh_bounds_min.z, child.m_mesh_bounds_min.z),
+            };
+            node.m_mesh_bounds_max = {
+                std::max(node.m_mesh_bounds_max.x, child.m_mesh_bounds_max.x),
+                std::max(node.m_mesh_bounds_max.y, child.m_mesh_bounds_max.y),
+                std::max(node.m_mesh_bounds_max.z, child.m_mesh_bounds_max.z),
+            };
+        }
+    }
+}
+
+void ChunkOctree::set_chunk(const size_t chunk_index, const DirectX::XMUINT3 chunk_index_3d, const u8 flags)
+{
+    const DirectX::XMUINT3 root_origin = get_node_origin(chunk_index_3d, ROOT_LEVEL);
+    auto root = std::find_if(m_roots.begin(), m_roots.end(), [&](const u32 node_index) {
+        const DirectX::XMUINT3 origin = m_nodes[node_index].m_origin;
+        return origin.x == root_origin.x && origin.y == root_origin.y && origin.z == root_origin.z;
+    });
+
+    if (root == m_roots.end())
+    {
+        m_roots.push_back(allocate_node(root_origin, ROOT_LEVEL, INVALID_NODE));
+        root = m_roots.end() - 1;
+    }
+
+    // Nodes are referred to by index, as allocating a node may grow the node pool.
+    u32 node_index = *root;
+    for (u32 level = ROOT_LEVEL; level > 0u; level--)
+    {
+        const u32 child_slot = get_child_slot(chunk_index_3d, level - 1u);
+
+        u32 child_index = m_nodes[node_index].m_children[child_slot];
+        if (child_index == INVALID_NODE)
+        {
+            child_index = allocate_node(get_node_origin(chunk_index_3d, level - 1u), level - 1u, node_index);
+            m_nodes[node_index].m_children[child_slot] = child_index;
+        }
+
+        node_index = child_index;
+    }
+
+    Node &leaf = m_nodes[node_index];
+    if (leaf.m_number_of_chunks == 1u && leaf.m_any_flags == flags)
+    {
+        return;
+    }
+
+    leaf.m_chunk_index = chunk_index;
+    leaf.m_number_of_chunks = 1u;
+    leaf.m_any_flags = flags;
+    leaf.m_all_flags = flags;
+    leaf.m_mesh_bounds_min = chunk_index_3d;
+    leaf.m_mesh_bounds_max = chunk_index_3d;
+
+    for (u32 ancestor = leaf.m_parent; ancestor != INVALID_NODE; ancestor = m_nodes[ancestor].m_parent)
+    {
+        refresh_node(ancestor);
+    }
+
+    m_number_of_updates++;
+}
+
+void ChunkOctree::remove_chunk(const DirectX::XMUINT3 chunk_index_3d)
+{
+    const u32 leaf = find_leaf(chunk_index_3d);
+    if (leaf == INVALID_NODE)
+    {
+        return;
+    }
+
+    // Ancestors that are left without chunks are removed as well.
+    u32 node_index = leaf;
+    u32 ancestor = m_nodes[leaf].m_parent;
+    free_node(node_index);
+
+    while (ancestor != INVALID_NODE)
+    {
+        Node &ancestor_node = m_nodes[ancestor];
+        if (node_index != INVALID_NODE)
+        {
+            ancestor_node.m_children[get_child_slot(chunk_index_3d, ancestor_node.m_level - 1u)] = INVALID_NODE;
+        }
+
+        refresh_node(ancestor);
+
+        node_index = INVALID_NODE;
+        if (ancestor_node.m_number_of_chunks == 0u)
+        {
+            node_index = ancestor;
+            free_node(ancestor);
+        }
+
+        if (ancestor_node.m_parent == INVALID_NODE && node_index != INVALID_NODE)
+        {
+            std::erase(m_roots, ancestor);
+        }
+
+        ancestor = ancestor_node.m_parent;
+    }
+
+    m_number_of_updates++;
+}
+
+void ChunkOctree::cull_chunks(const FrustumCulling::Frustum &frustum, const float chunk_length,
+                              std::vector<size_t> &visible_chunk_indices)
+{
+    m_candidate_chunk_indices.clear();
+    m_candidate_chunk_min_x.clear();
+    m_candidate_chunk_min_y.clear();
+    m_candidate_chunk_min_z.clear();
+
+    const auto add_candidate = [&](const Node &leaf) {
+        m_candidate_chunk_indices.push_back(leaf.m_chunk_index);
+        m_candidate_chunk_min_x.push_back(static_cast<float>(leaf.m_origin.x) * chunk_length);
+        m_candidate_chunk_min_y.push_back(static_cast<float>(leaf.m_origin.y) * chunk_length);
+        m_candidate_chunk_min_z.push_back(static_cast<float>(leaf.m_origin.z) * chunk_length);
+    };
+
+    const auto add_visible_chunks = [&](const u32 node_index, const bool is_inside) {
+        traverse_subtree(
+            node_index, [&](const Node &node) { return (node.m_any_flags & FLAG_HAS_MESH) != 0u; },
+            [&](const Node &leaf) {
+                if (!(leaf.m_any_flags & FLAG_HAS_MESH))
+                {
+                    return;
+                }
+
+                if (is_inside)
+                {
+                    visible_chunk_indices.push_back(leaf.m_chunk_index);
+                }
+                else
+                {
+                    add_candidate(leaf);
+                }
+            });
+    };
+
+    traverse(
+        [&](const Node &node) {
+            if (!(node.m_any_flags & FLAG_HAS_MESH))
+            {
+                return false;
+            }
+
+            const FrustumCulling::BoxContainment box_containment = FrustumCulling::classify_box(
+                frustum,
+                {
+                    static_cast<float>(node.m_mesh_bounds_min.x) * chunk_length,
+                    static_cast<float>(node.m_mesh_bounds_min.y) * chunk_length,
+                    static_cast<float>(node.m_mesh_bounds_min.z) * chunk_length,
+                },
+                {
+                    static_cast<float>(node.m_mesh_bounds_max.x + 1u) * chunk_length,
+                    static_cast<float>(node.m_mesh_bounds_max.y + 1u) * chunk_length,
+                    static_cast<float>(node.m_mesh_bounds_max.z + 1u) * chunk_length,
+                });
+
+            // Below the second level (4 x 4 x 4 chunks), the remaining chunks are tested 8 at a time with cull_chunks
+            // rather than one node at a time.
+            if (box_containment == FrustumCulling::BoxContainment::Outside)
+            {
+                return false;
+            }
+
+            if (box_containment == FrustumCulling::BoxContainment::Inside || node.m_level <= 2u)
+            {
+                add_visible_chunks(static_cast<u32>(&node - m_nodes.data()),
+                                   box_containment == FrustumCulling::BoxContainment::Inside);
+                return false;
+            }
+
+            return true;
+        },
+        [&](const Node &) {});
+
+    m_visible_candidate_indices.resize(m_candidate_chunk_indices.size());
+    const size_t number_of_visible_candidates = FrustumCulling::cull_chunks(
+        frustum, chunk_length, m_candidate_chunk_min_x.data(), m_candidate_chunk_min_y.data(),
+        m_candidate_chunk_min_z.data(), m_candidate_chunk_indices.size(), m_visible_candidate_indices.data());
+
+    for (size_t i = 0u; i < number_of_visible_candidates; i++)
+    {
+        visible_chunk_indices.push_back(m_candidate_chunk_indices[m_visible_candidate_indices[i]]);
+    }
+}
+
+// Distances along the ray at which it enters and leaves the box, if it intersects it.
+static std::optional<std::pair<float, float>> intersect_ray_with_box(const DirectX::XMFLOAT3 origin,
+                                                                     const DirectX::XMFLOAT3 inverse_direction,
+                                                                     const DirectX::XMFLOAT3 box_min,
+                                                                     const DirectX::XMFLOAT3 box_max)
+{
+    float entry_distance = 0.0f;
+    float exit_distance = std::numeric_limits<float>::infinity();
+
+    const std::array<float, 3u> origins = {origin.x, origin.y, origin.z};
+    const std::array<float, 3u> inverse_directions = {inverse_direction.x, inverse_direction.y, inverse_direction.z};
+    const std::array<float, 3u> mins = {box_min.x, box_min.y, box_min.z};
+    const std::array<float, 3u> maxs = {box_max.x, box_max.y, box_max.z};
+
+    for (u32 axis = 0u; axis < 3u; axis++)
+    {
+        // A ray parallel to the slab is either always or never inside of it.
+        if (std::isinf(inverse_directions[axis]))
+        {
+            if (origins[axis] < mins[axis] || origins[axis] > maxs[axis])
+            {
+                return std::nullopt;
+            }
+
+            continue;
+        }
+
+        float near_distance = (mins[axis] - origins[axis]) * inverse_directions[axis];
+        float far_distance = (maxs[axis] - origins[axis]) * inverse_directions[axis];
+        if (near_distance > far_distance)
+        {
+            std::swap(near_distance, far_distance);
+        }
+
+        entry_distance = std::max(entry_distance, near_distance);
+        exit_distance = std::min(exit_distance, far_distance);
+    }
+
+    if (entry_distance > exit_distance)
+    {
+        return std::nullopt;
+    }
+
+    return std::make_pair(entry_distance, exit_distance);
+}
+
+std::optional<ChunkOctree::RayHit> ChunkOctree::raycast(const DirectX::XMFLOAT3 origin,
+                                                        const DirectX::XMFLOAT3 direction, const float max_distance,
+                                                        const float chunk_length, const u8 flags) const
+{
+    const DirectX::XMFLOAT3 inverse_direction = {1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z};
+
+    const auto get_entry_distance = [&](const Node &node) -> std::optional<float> {
+        const float edge_length = static_cast<float>(node.get_edge_length()) * chunk_length;
+        const DirectX::XMFLOAT3 box_min = {
+            static_cast<float>(node.m_origin.x) * chunk_length,
+            static_cast<float>(node.m_origin.y) * chunk_length,
+            static_cast<float>(node.m_origin.z) * chunk_length,
+        };
+
+        const auto distances = intersect_ray_with_box(
+            origin, inverse_direction, box_min,
+            {box_min.x + edge_length, box_min.y + edge_length, box_min.z + edge_length});
+        if (!distances.has_value() || distances->first > max_distance)
+        {
+            return std::nullopt;
+        }
+
+        return distances->first;
+    };
+
+    std::optional<RayHit> nearest_hit{};
+
+    // Nodes to visit, with the distance at which the ray enters them. The children of a node are pushed furthest
+    // first, so that the nearest one is popped first.
+    struct StackEntry
+    {
+        u32 m_node_index{};
+        float m_entry_distance{};
+    };
+
+    std::array<StackEntry, 8u * (ROOT_LEVEL + 1u)> stack{};
+
+    for (const u32 root : m_roots)
+    {
+        const std::optional<float> root_entry_distance = get_entry_distance(m_nodes[root]);
+        if (!root_entry_distance.has_value())
+        {
+            continue;
+        }
+
+        u32 stack_size = 0u;
+        stack[stack_size++] = StackEntry{root, *root_entry_distance};
+
+        while (stack_size != 0u)
+        {
+            const StackEntry entry = stack[--stack_size];
+            const Node &node = m_nodes[entry.m_node_index];
+
+            if ((node.m_any_flags & flags) != flags ||
+                (nearest_hit.has_value() && entry.m_entry_distance >= nearest_hit->m_distance))
+            {
+                continue;
+            }
+
+            if (node.m_level == 0u)
+            {
+                if ((node.m_all_flags & flags) == flags)
+                {
+                    nearest_hit = RayHit{
+                        .m_chunk_index = node.m_chunk_index,
+                        .m_distance = entry.m_entry_distance,
+                    };
+                }
+
+                continue;
+            }
+
+            std::array<StackEntry, 8u> children{};
+            u32 number_of_children = 0u;
+            for (const u32 child : node.m_children)
+            {
+                if (child == INVALID_NODE)
+                {
+                    continue;
+                }
+
+                if (const std::optional<float> child_entry_distance = get_entry_distance(m_nodes[child]))
+                {
+                    children[number_of_children++] = StackEntry{child, *child_entry_distance};
+                }
+            }
+
+            std::sort(children.begin(), children.begin() + number_of_children,
+                      [](const StackEntry &a, const StackEntry &b) { return a.m_entry_distance > b.m_entry_distance; });
+            for (u32 i = 0u; i < number_of_children; i++)
+            {
+                stack[stack_size++] = children[i];
+            }
+        }
+    }
+
+    return nearest_hit;
+}
+
+size_t ChunkOctree::get_number_of_nodes() const
+{
+    return m_nodes.size() - m_free_nodes.size();
+}
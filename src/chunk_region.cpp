@@ -0,0 +1,446 @@
+#include "voxel-engine/chunk_region.hpp"
+
+#include "shaders/interop/render_resources.hlsli"
+
+static_assert(ChunkRegions::NUMBER_OF_CHUNKS_PER_REGION_DIMENSION == ::NUMBER_OF_CHUNKS_PER_REGION_DIMENSION,
+              "The number of chunks per region must match the shaders");
+static_assert(ChunkRegions::NUMBER_OF_CHUNKS_PER_REGION == ::NUMBER_OF_CHUNKS_PER_REGION,
+              "The number of chunks per region must match the shaders");
+
+static_assert(std::bit_width(ChunkRegions::NUMBER_OF_CHUNKS_PER_REGION - 1u) == REGION_CHUNK_SLOT_BITS,
+              "The number of bits of a region chunk slot must match the shaders");
+static_assert(ChunkRegions::NUMBER_OF_LOADED_CHUNK_MESH_LISTS == ::NUMBER_OF_LOADED_CHUNK_MESH_LISTS,
+              "The number of lists of loaded chunk meshes must match the shaders");
+static_assert(offsetof(ChunkIndirectCommand, region_run) == offsetof(GPUIndirectCommand, culling_arguments),
+              "The region run must be at the start of the culling arguments");
+static_assert(offsetof(ChunkIndirectCommand::RegionRun, page_index) == offsetof(RegionRun, page_index) &&
+                  offsetof(ChunkIndirectCommand::RegionRun, first_loaded_chunk_mesh) ==
+                      offsetof(RegionRun, first_loaded_chunk_mesh) &&
+                  offsetof(ChunkIndirectCommand::RegionRun, number_of_loaded_chunk_meshes) ==
+                      offsetof(RegionRun, number_of_loaded_chunk_meshes) &&
+                  offsetof(ChunkIndirectCommand::RegionRun, loaded_chunk_mesh_list) ==
+                      offsetof(RegionRun, loaded_chunk_mesh_list),
+              "The region run must match the shaders");
+
+static_assert(REGION_CHUNK_SLOT_BITS + NUMBER_OF_FACE_DIRECTIONS * ChunkRegions::FACE_COUNT_BITS <= 128u,
+              "A loaded chunk mesh must fit in a uint4");
+
+// Each component of a region index is stored in 21 bits, which is more than enough for the chunk grid.
+static constexpr u32 REGION_KEY_COMPONENT_BITS = 21u;
+
+u64 ChunkRegions::get_region_key(const DirectX::XMUINT3 chunk_index_3d)
+{
+    return static_cast<u64>(chunk_index_3d.x / NUMBER_OF_CHUNKS_PER_REGION_DIMENSION) |
+           static_cast<u64>(chunk_index_3d.y / NUMBER_OF_CHUNKS_PER_REGION_DIMENSION) << REGION_KEY_COMPONENT_BITS |
+           static_cast<u64>(chunk_index_3d.z / NUMBER_OF_CHUNKS_PER_REGION_DIMENSION)
+               << (2u * REGION_KEY_COMPONENT_BITS);
+}
+
+u32 ChunkRegions::get_region_chunk_slot(const DirectX::XMUINT3 chunk_index_3d)
+{
+    return chunk_index_3d.x % NUMBER_OF_CHUNKS_PER_REGION_DIMENSION +
+           (chunk_index_3d.y % NUMBER_OF_CHUNKS_PER_REGION_DIMENSION) * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION +
+           (chunk_index_3d.z % NUMBER_OF_CHUNKS_PER_REGION_DIMENSION) * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION *
+               NUMBER_OF_CHUNKS_PER_REGION_DIMENSION;
+}
+
+DirectX::XMUINT3 ChunkRegions::get_chunk_index_3d(const DirectX::XMUINT3 region_index_3d, const u32 region_chunk_slot)
+{
+    return {
+        region_index_3d.x * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION +
+            region_chunk_slot % NUMBER_OF_CHUNKS_PER_REGION_DIMENSION,
+        region_index_3d.y * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION +
+            (region_chunk_slot / NUMBER_OF_CHUNKS_PER_REGION_DIMENSION) % NUMBER_OF_CHUNKS_PER_REGION_DIMENSION,
+        region_index_3d.z * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION +
+            region_chunk_slot / (NUMBER_OF_CHUNKS_PER_REGION_DIMENSION * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION),
+    };
+}
+
+DirectX::XMUINT4 ChunkRegions::encode_loaded_chunk_mesh(
+    const u32 region_chunk_slot, const std::array<u32, NUMBER_OF_FACE_DIRECTIONS> &face_direction_face_counts)
+{
+    std::array<u32, 4u> bits = {region_chunk_slot, 0u, 0u, 0u};
+
+    // A face count may straddle two components.
+    for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+    {
+        const u32 first_bit = REGION_CHUNK_SLOT_BITS + face * FACE_COUNT_BITS;
+        const u32 shift = first_bit % 32u;
+
+        bits[first_bit / 32u] |= face_direction_face_counts[face] << shift;
+        if (shift + FACE_COUNT_BITS > 32u)
+        {
+            bits[first_bit / 32u + 1u] |= face_direction_face_counts[face] >> (32u - shift);
+        }
+    }
+
+    return {bits[0], bits[1], bits[2], bits[3]};
+}
+
+ChunkRegions::Region &ChunkRegions::get_or_create_region(const DirectX::XMUINT3 chunk_index_3d)
+{
+    const auto [region, is_region_created] = m_regions.try_emplace(get_region_key(chunk_index_3d));
+    if (is_region_created)
+    {
+        region->second.m_region_index_3d = {
+            chunk_index_3d.x / NUMBER_OF_CHUNKS_PER_REGION_DIMENSION,
+            chunk_index_3d.y / NUMBER_OF_CHUNKS_PER_REGION_DIMENSION,
+            chunk_index_3d.z / NUMBER_OF_CHUNKS_PER_REGION_DIMENSION,
+        };
+    }
+
+    return region->second;
+}
+
+u32 ChunkRegions::create_page(GpuBackend &gpu_backend, Region &region, const u64 region_key, const u32 number_of_faces,
+                              const size_t position_buffer_srv_index)
+{
+    // Pages grow geometrically, so that a region that keeps on growing ends up with a few pages.
+    u32 largest_page_capacity_in_faces = 0u;
+    for (const Page &page : region.m_pages)
+    {
+        largest_page_capacity_in_faces = std::max(largest_page_capacity_in_faces, page.m_capacity_in_faces);
+    }
+
+    const u32 capacity_in_faces =
+        std::max({MIN_PAGE_CAPACITY_IN_FACES, std::bit_ceil(number_of_faces), 2u * largest_page_capacity_in_faces});
+
+    const auto empty_page = std::find_if(region.m_pages.begin(), region.m_pages.end(),
+                                         [](const Page &page) { return !page.m_index_buffer.resource; });
+    const u32 page_index = static_cast<u32>(empty_page - region.m_pages.begin());
+    if (empty_page == region.m_pages.end())
+    {
+        region.m_pages.emplace_back();
+    }
+
+    const std::wstring page_name = std::to_wstring(region_key) + std::wstring(L" : ") + std::to_wstring(page_index);
+
+    // The buffers are not initialized : the meshes are copied into them as chunks are loaded.
+    Page &page = region.m_pages[page_index];
+    page.m_index_buffer = gpu_backend
+                              .create_index_buffer(nullptr, sizeof(Index), capacity_in_faces * 6u,
+                                                   std::wstring(L"Region index buffer : ") + page_name)
+                              .index_buffer;
+    page.m_color_buffer = gpu_backend
+                              .create_structured_buffer(nullptr, sizeof(DirectX::XMFLOAT3), capacity_in_faces,
+                                                        std::wstring(L"Region color buffer : ") + page_name)
+                              .structured_buffer;
+    page.m_constant_buffer = gpu_backend.create_constant_buffer(
+        sizeof(RegionConstantBuffer), std::wstring(L"Region constant buffer : ") + page_name);
+
+    page.m_capacity_in_faces = capacity_in_faces;
+    page.m_free_face_ranges = {FaceRange{0u, capacity_in_faces}};
+    page.m_loaded_chunk_slots.reserve(NUMBER_OF_CHUNKS_PER_REGION);
+    page.m_loaded_chunk_meshes.reserve(NUMBER_OF_CHUNKS_PER_REGION);
+    page.m_number_of_allocations = 0u;
+    page.m_size_in_bytes = page.m_index_buffer.index_buffer_view.size_in_bytes + page.m_color_buffer.size_in_bytes +
+                           page.m_constant_buffer.size_in_bytes;
+
+    // The chunk translations only depend on the region, so they are written once, before any frame can read them. The
+    // loaded chunk meshes are written as they change (see update_page_indirect_commands).
+    RegionConstantBuffer region_constant_buffer_data{};
+    region_constant_buffer_data.position_buffer_index = static_cast<u32>(position_buffer_srv_index);
+    region_constant_buffer_data.color_buffer_index = static_cast<u32>(page.m_color_buffer.srv_index);
+    region_constant_buffer_data.region_chunk_slot_shift = REGION_CHUNK_SLOT_SHIFT;
+    region_constant_buffer_data.face_count_bits = FACE_COUNT_BITS;
+
+    for (u32 z = 0u; z < NUMBER_OF_CHUNKS_PER_REGION_DIMENSION; z++)
+    {
+        for (u32 y = 0u; y < NUMBER_OF_CHUNKS_PER_REGION_DIMENSION; y++)
+        {
+            for (u32 x = 0u; x < NUMBER_OF_CHUNKS_PER_REGION_DIMENSION; x++)
+            {
+                const DirectX::XMUINT3 chunk_index_3d = {
+                    region.m_region_index_3d.x * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION + x,
+                    region.m_region_index_3d.y * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION + y,
+                    region.m_region_index_3d.z * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION + z,
+                };
+
+                region_constant_buffer_data.chunk_translation_vectors[get_region_chunk_slot(chunk_index_3d)] = {
+                    chunk_index_3d.x * Chunk::CHUNK_LENGTH,
+                    chunk_index_3d.y * Chunk::CHUNK_LENGTH,
+                    chunk_index_3d.z * Chunk::CHUNK_LENGTH,
+                    0u,
+                };
+            }
+        }
+    }
+
+    page.m_constant_buffer.update(&region_constant_buffer_data);
+
+    region.m_number_of_pages++;
+    m_number_of_pages++;
+    m_number_of_pages_created++;
+    m_pages_size_in_bytes += page.m_size_in_bytes;
+
+    return page_index;
+}
+
+ChunkRegionAllocation ChunkRegions::allocate(GpuBackend &gpu_backend, const DirectX::XMUINT3 chunk_index_3d,
+                                             const u32 number_of_faces, const size_t position_buffer_srv_index)
+{
+    const u64 region_key = get_region_key(chunk_index_3d);
+    Region &region = get_or_create_region(chunk_index_3d);
+
+    // First fit, in the first page that has room.
+    const auto find_free_face_range = [&](Page &page) {
+        return std::find_if(
+            page.m_free_face_ranges.begin(), page.m_free_face_ranges.end(),
+            [&](const FaceRange &face_range) { return face_range.m_number_of_faces >= number_of_faces; });
+    };
+
+    u32 page_index = 0u;
+    while (page_index < region.m_pages.size() &&
+           find_free_face_range(region.m_pages[page_index]) == region.m_pages[page_index].m_free_face_ranges.end())
+    {
+        ++page_index;
+    }
+
+    if (page_index == region.m_pages.size())
+    {
+        page_index = create_page(gpu_backend, region, region_key, number_of_faces, position_buffer_srv_index);
+    }
+
+    Page &page = region.m_pages[page_index];
+    const auto free_face_range = find_free_face_range(page);
+
+    const ChunkRegionAllocation allocation = {
+        .m_region_key = region_key,
+        .m_page_index = page_index,
+        .m_first_face = free_face_range->m_first_face,
+        .m_number_of_faces = number_of_faces,
+    };
+
+    free_face_range->m_first_face += number_of_faces;
+    free_face_range->m_number_of_faces -= number_of_faces;
+    if (free_face_range->m_number_of_faces == 0u)
+    {
+        page.m_free_face_ranges.erase(free_face_range);
+    }
+
+    page.m_number_of_allocations++;
+
+    return allocation;
+}
+
+void ChunkRegions::free(const ChunkRegionAllocation &allocation)
+{
+    const auto region = m_regions.find(allocation.m_region_key);
+    Page &page = region->second.m_pages[allocation.m_page_index];
+
+    // The range is merged with the free ranges right before and after it, if any.
+    const auto next_face_range = std::lower_bound(
+        page.m_free_face_ranges.begin(), page.m_free_face_ranges.end(), allocation.m_first_face,
+        [](const FaceRange &face_range, const u32 first_face) { return face_range.m_first_face < first_face; });
+
+    const auto face_range = page.m_free_face_ranges.insert(next_face_range, FaceRange{
+                                                                                .m_first_face = allocation.m_first_face,
+                                                                                .m_number_of_faces =
+                                                                                    allocation.m_number_of_faces,
+                                                                            });
+
+    if (const auto next = std::next(face_range);
+        next != page.m_free_face_ranges.end() &&
+        face_range->m_first_face + face_range->m_number_of_faces == next->m_first_face)
+    {
+        face_range->m_number_of_faces += next->m_number_of_faces;
+        page.m_free_face_ranges.erase(next);
+    }
+
+    if (face_range != page.m_free_face_ranges.begin())
+    {
+        const auto previous = std::prev(face_range);
+        if (previous->m_first_face + previous->m_number_of_faces == face_range->m_first_face)
+        {
+            previous->m_number_of_faces += face_range->m_number_of_faces;
+            page.m_free_face_ranges.erase(face_range);
+        }
+    }
+
+    if (--page.m_number_of_allocations != 0u)
+    {
+        return;
+    }
+
+    m_pages_size_in_bytes -= page.m_size_in_bytes;
+    m_number_of_pages--;
+    page = Page{};
+
+    if (--region->second.m_number_of_pages == 0u)
+    {
+        m_regions.erase(region);
+    }
+}
+
+const ChunkRegions::Page &ChunkRegions::get_page(const ChunkRegionAllocation &allocation) const
+{
+    return m_regions.at(allocation.m_region_key).m_pages[allocation.m_page_index];
+}
+
+ChunkIndirectCommand ChunkRegions::create_indirect_command(const ChunkRegionAllocation &allocation,
+                                                           const u32 region_chunk_slot) const
+{
+    const Page &page = get_page(allocation);
+
+    return ChunkIndirectCommand{
+        .region_constant_buffer_index = static_cast<u32>(page.m_constant_buffer.cbv_index),
+        .first_face_index = allocation.m_first_face,
+        .region_chunk_slot = region_chunk_slot,
+        .index_buffer_view = page.m_index_buffer.index_buffer_view,
+        .index_count_per_instance = allocation.m_number_of_faces * 6u,
+        .start_index_location = allocation.m_first_face * 6u,
+        .face_direction_index_counts = {},
+    };
+}
+
+void ChunkRegions::set_loaded_mesh(const DirectX::XMUINT3 chunk_index_3d, const ChunkRegionAllocation &allocation,
+                                   const FaceDirectionIndexRanges &face_direction_index_ranges,
+                                   const u64 direct_queue_fence_value)
+{
+    // The region only goes away once all of its ranges are freed, which is after the chunk is no longer drawn.
+    const u64 region_key = get_region_key(chunk_index_3d);
+    const auto region = m_regions.find(region_key);
+    if (region == m_regions.end())
+    {
+        return;
+    }
+
+    const u32 region_chunk_slot = get_region_chunk_slot(chunk_index_3d);
+    LoadedMesh &loaded_mesh = region->second.m_loaded_meshes[region_chunk_slot];
+
+    // The mesh is removed from the loaded chunk meshes of the page of its previous range, and inserted into the ones
+    // of the page of its new range, which stay sorted by first face.
+    const ChunkRegionAllocation previous_allocation = loaded_mesh.m_allocation;
+    if (previous_allocation.is_valid())
+    {
+        Page &page = region->second.m_pages[previous_allocation.m_page_index];
+
+        const auto loaded_chunk_slot =
+            std::find(page.m_loaded_chunk_slots.begin(), page.m_loaded_chunk_slots.end(), region_chunk_slot);
+        page.m_loaded_chunk_meshes.erase(page.m_loaded_chunk_meshes.begin() +
+                                         (loaded_chunk_slot - page.m_loaded_chunk_slots.begin()));
+        page.m_loaded_chunk_slots.erase(loaded_chunk_slot);
+    }
+
+    loaded_mesh.m_allocation = allocation;
+    for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+    {
+        loaded_mesh.m_face_direction_face_counts[face] = face_direction_index_ranges[face].m_number_of_indices / 6u;
+    }
+
+    if (allocation.is_valid())
+    {
+        Page &page = region->second.m_pages[allocation.m_page_index];
+
+        const auto loaded_chunk_slot = std::lower_bound(
+            page.m_loaded_chunk_slots.begin(), page.m_loaded_chunk_slots.end(), allocation.m_first_face,
+            [&](const u32 slot, const u32 first_face) {
+                return region->second.m_loaded_meshes[slot].m_allocation.m_first_face < first_face;
+            });
+        page.m_loaded_chunk_meshes.insert(
+            page.m_loaded_chunk_meshes.begin() + (loaded_chunk_slot - page.m_loaded_chunk_slots.begin()),
+            encode_loaded_chunk_mesh(region_chunk_slot, loaded_mesh.m_face_direction_face_counts));
+        page.m_loaded_chunk_slots.insert(loaded_chunk_slot, region_chunk_slot);
+    }
+
+    // The commands of the other pages of the region are left as they are.
+    if (previous_allocation.is_valid())
+    {
+        update_page_indirect_commands(region_key, region->second, previous_allocation.m_page_index,
+                                      direct_queue_fence_value);
+    }
+
+    if (allocation.is_valid() &&
+        (!previous_allocation.is_valid() || allocation.m_page_index != previous_allocation.m_page_index))
+    {
+        update_page_indirect_commands(region_key, region->second, allocation.m_page_index, direct_queue_fence_value);
+    }
+}
+
+void ChunkRegions::update_page_indirect_commands(const u64 region_key, Region &region, const u32 page_index,
+                                                 const u64 direct_queue_fence_value)
+{
+    Page &page = region.m_pages[page_index];
+
+    // The list the frames in flight may be reading is never overwritten : once the direct queue has signalled since
+    // the list was first written, the changed list is written into the next one.
+    if (page.m_loaded_chunk_mesh_list_direct_queue_fence_value.has_value() &&
+        *page.m_loaded_chunk_mesh_list_direct_queue_fence_value != direct_queue_fence_value)
+    {
+        page.m_loaded_chunk_mesh_list = (page.m_loaded_chunk_mesh_list + 1u) % NUMBER_OF_LOADED_CHUNK_MESH_LISTS;
+    }
+
+    page.m_loaded_chunk_mesh_list_direct_queue_fence_value = direct_queue_fence_value;
+
+    memcpy(page.m_constant_buffer.resource_mapped_ptr + offsetof(RegionConstantBuffer, loaded_chunk_meshes) +
+               sizeof(DirectX::XMUINT4) * page.m_loaded_chunk_mesh_list * NUMBER_OF_CHUNKS_PER_REGION,
+           page.m_loaded_chunk_meshes.data(), sizeof(DirectX::XMUINT4) * page.m_loaded_chunk_meshes.size());
+
+    const DirectX::XMFLOAT3 region_min = {
+        static_cast<float>(region.m_region_index_3d.x * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION * Chunk::CHUNK_LENGTH),
+        static_cast<float>(region.m_region_index_3d.y * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION * Chunk::CHUNK_LENGTH),
+        static_cast<float>(region.m_region_index_3d.z * NUMBER_OF_CHUNKS_PER_REGION_DIMENSION * Chunk::CHUNK_LENGTH),
+    };
+
+    // Adjacent meshes of the page are drawn with one command. The commands of the previous runs of the page are
+    // overwritten with the new runs, so that the runs before the mesh that changed are not uploaded again.
+    u32 number_of_runs = 0u;
+    u32 first_loaded_chunk_mesh = 0u;
+    while (first_loaded_chunk_mesh < page.m_loaded_chunk_slots.size())
+    {
+        ChunkRegionAllocation run =
+            region.m_loaded_meshes[page.m_loaded_chunk_slots[first_loaded_chunk_mesh]].m_allocation;
+
+        u32 end_loaded_chunk_mesh = first_loaded_chunk_mesh + 1u;
+        for (; end_loaded_chunk_mesh < page.m_loaded_chunk_slots.size(); end_loaded_chunk_mesh++)
+        {
+            const ChunkRegionAllocation &allocation =
+                region.m_loaded_meshes[page.m_loaded_chunk_slots[end_loaded_chunk_mesh]].m_allocation;
+            if (allocation.m_first_face != run.m_first_face + run.m_number_of_faces)
+            {
+                break;
+            }
+
+            run.m_number_of_faces += allocation.m_number_of_faces;
+        }
+
+        ChunkIndirectCommand indirect_command = create_indirect_command(run, REGION_COMMAND_CHUNK_SLOT);
+        indirect_command.region_run = {
+            .page_index = page_index,
+            .first_loaded_chunk_mesh = first_loaded_chunk_mesh,
+            .number_of_loaded_chunk_meshes = end_loaded_chunk_mesh - first_loaded_chunk_mesh,
+            .loaded_chunk_mesh_list = page.m_loaded_chunk_mesh_list,
+        };
+
+        if (number_of_runs < page.m_indirect_command_handles.size())
+        {
+            m_region_indirect_commands.set(page.m_indirect_command_handles[number_of_runs], indirect_command);
+        }
+        else
+        {
+            page.m_indirect_command_handles.push_back(
+                m_region_indirect_commands.add(region_key, indirect_command, region_min));
+        }
+
+        ++number_of_runs;
+        first_loaded_chunk_mesh = end_loaded_chunk_mesh;
+    }
+
+    // The command that is moved into the hole of a removed command was the last one, so its handle is found from the
+    // size of the array, in the page of its run.
+    while (page.m_indirect_command_handles.size() > number_of_runs)
+    {
+        const u32 handle = page.m_indirect_command_handles.back();
+        page.m_indirect_command_handles.pop_back();
+
+        if (const std::optional<size_t> moved_region_key = m_region_indirect_commands.remove(handle))
+        {
+            std::vector<u32> &moved_page_handles =
+                m_regions.at(*moved_region_key)
+                    .m_pages[m_region_indirect_commands.m_commands[handle].region_run.page_index]
+                    .m_indirect_command_handles;
+            *std::find(moved_page_handles.begin(), moved_page_handles.end(),
+                       static_cast<u32>(m_region_indirect_commands.size())) = handle;
+        }
+    }
+}
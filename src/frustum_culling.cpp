@@ -0,0 +1,260 @@
+#include "voxel-engine/frustum_culling.hpp"
+
+#include <immintrin.h>
+
+namespace FrustumCulling
+{
+// Plane in the form used by the culling loops : the chunk is visible if, for every plane,
+// normal . chunk_min + distance >= negative_radius. The half edge length of the chunks is folded into the distance, so
+// that the chunk minimum can be used rather than the center.
+struct CullingPlane
+{
+    float m_normal_x{};
+    float m_normal_y{};
+    float m_normal_z{};
+    float m_distance{};
+    float m_negative_radius{};
+};
+
+static std::array<CullingPlane, 6u> get_culling_planes(const Frustum &frustum, const float chunk_length)
+{
+    const float half_chunk_length = chunk_length * 0.5f;
+
+    std::array<CullingPlane, 6u> culling_planes{};
+    for (size_t i = 0u; i < frustum.m_planes.size(); i++)
+    {
+        const DirectX::XMFLOAT4 &plane = frustum.m_planes[i];
+
+        // The projection of the AABB half extents onto the plane normal.
+        const float radius =
+            half_chunk_length * (std::abs(plane.x) + std::abs(plane.y) + std::abs(plane.z));
+
+        culling_planes[i] = CullingPlane{
+            .m_normal_x = plane.x,
+            .m_normal_y = plane.y,
+            .m_normal_z = plane.z,
+            .m_distance = plane.w + half_chunk_length * (plane.x + plane.y + plane.z),
+            .m_negative_radius = -radius,
+        };
+    }
+
+    return culling_planes;
+}
+
+Frustum create_frustum(const DirectX::XMFLOAT4X4 &view_projection_matrix, const DirectX::XMFLOAT3 camera_position)
+{
+    const auto &m = view_projection_matrix.m;
+
+    // Clip space coordinate j of a point is the dot product of the point with column j of the matrix.
+    const auto get_column = [&](const size_t j) {
+        return std::array<float, 4u>{m[0][j], m[1][j], m[2][j], m[3][j]};
+    };
+
+    const std::array<float, 4u> x = get_column(0u);
+    const std::array<float, 4u> y = get_column(1u);
+    const std::array<float, 4u> z = get_column(2u);
+    const std::array<float, 4u> w = get_column(3u);
+
+    // -w <= x <= w, -w <= y <= w, 0 <= z <= w.
+    const std::array<std::array<float, 4u>, 6u> planes = {{
+        {w[0] + x[0], w[1] + x[1], w[2] + x[2], w[3] + x[3]},
+        {w[0] - x[0], w[1] - x[1], w[2] - x[2], w[3] - x[3]},
+        {w[0] + y[0], w[1] + y[1], w[2] + y[2], w[3] + y[3]},
+        {w[0] - y[0], w[1] - y[1], w[2] - y[2], w[3] - y[3]},
+        {z[0], z[1], z[2], z[3]},
+        {w[0] - z[0], w[1] - z[1], w[2] - z[2], w[3] - z[3]},
+    }};
+
+    Frustum frustum{};
+    for (size_t i = 0u; i < planes.size(); i++)
+    {
+        const std::array<float, 4u> &plane = planes[i];
+
+        const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        const float inverse_length = length > 0.0f ? 1.0f / length : 1.0f;
+
+        // The camera position is large compared to the distances that matter for culling, so it is folded in with
+        // double precision.
+        const double distance = static_cast<double>(plane[3]) - static_cast<double>(plane[0]) * camera_position.x -
+                                static_cast<double>(plane[1]) * camera_position.y -
+                                static_cast<double>(plane[2]) * camera_position.z;
+
+        frustum.m_planes[i] = DirectX::XMFLOAT4{
+            plane[0] * inverse_length,
+            plane[1] * inverse_length,
+            plane[2] * inverse_length,
+            static_cast<float>(distance * inverse_length),
+        };
+    }
+
+    return frustum;
+}
+
+static size_t cull_chunks_scalar(const std::array<CullingPlane, 6u> &culling_planes, const float *const chunk_min_x,
+                                 const float *const chunk_min_y, const float *const chunk_min_z, const size_t first,
+                                 const size_t number_of_chunks, u32 *const visible_chunk_indices)
+{
+    size_t number_of_visible_chunks = 0u;
+    for (size_t i = first; i < number_of_chunks; i++)
+    {
+        bool is_visible = true;
+        for (const CullingPlane &plane : culling_planes)
+        {
+            const float distance = plane.m_normal_x * chunk_min_x[i] + plane.m_normal_y * chunk_min_y[i] +
+                                   plane.m_normal_z * chunk_min_z[i] + plane.m_distance;
+            is_visible &= distance >= plane.m_negative_radius;
+        }
+
+        if (is_visible)
+        {
+            visible_chunk_indices[number_of_visible_chunks++] = static_cast<u32>(i);
+        }
+    }
+
+    return number_of_visible_chunks;
+}
+
+size_t cull_chunks(const Frustum &frustum, const float chunk_length, const float *const chunk_min_x,
+                   const float *const chunk_min_y, const float *const chunk_min_z, const size_t number_of_chunks,
+                   u32 *const visible_chunk_indices)
+{
+    const std::array<CullingPlane, 6u> culling_planes = get_culling_planes(frustum, chunk_length);
+
+    size_t i = 0u;
+    size_t number_of_visible_chunks = 0u;
+
+#if defined(__AVX2__)
+    struct Avx2CullingPlane
+    {
+        __m256 m_normal_x;
+        __m256 m_normal_y;
+        __m256 m_normal_z;
+        __m256 m_distance;
+        __m256 m_negative_radius;
+    };
+
+    std::array<Avx2CullingPlane, 6u> avx2_culling_planes{};
+    for (size_t j = 0u; j < culling_planes.size(); j++)
+    {
+        avx2_culling_planes[j] = Avx2CullingPlane{
+            .m_normal_x = _mm256_set1_ps(culling_planes[j].m_normal_x),
+            .m_normal_y = _mm256_set1_ps(culling_planes[j].m_normal_y),
+            .m_normal_z = _mm256_set1_ps(culling_planes[j].m_normal_z),
+            .m_distance = _mm256_set1_ps(culling_planes[j].m_distance),
+            .m_negative_radius = _mm256_set1_ps(culling_planes[j].m_negative_radius),
+        };
+    }
+
+    // 8 chunks at a time. The visible chunks are found from the bits of the mask, lowest first.
+    for (; i + 8u <= number_of_chunks; i += 8u)
+    {
+        const __m256 x = _mm256_loadu_ps(chunk_min_x + i);
+        const __m256 y = _mm256_loadu_ps(chunk_min_y + i);
+        const __m256 z = _mm256_loadu_ps(chunk_min_z + i);
+
+        __m256 is_visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const Avx2CullingPlane &plane : avx2_culling_planes)
+        {
+            const __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(plane.m_normal_x, x), _mm256_mul_ps(plane.m_normal_y, y)),
+                _mm256_add_ps(_mm256_mul_ps(plane.m_normal_z, z), plane.m_distance));
+            is_visible = _mm256_and_ps(is_visible, _mm256_cmp_ps(distance, plane.m_negative_radius, _CMP_GE_OQ));
+        }
+
+        u32 visible_mask = static_cast<u32>(_mm256_movemask_ps(is_visible));
+        while (visible_mask != 0u)
+        {
+            visible_chunk_indices[number_of_visible_chunks++] = static_cast<u32>(i + std::countr_zero(visible_mask));
+            visible_mask &= visible_mask - 1u;
+        }
+    }
+#endif
+
+    return number_of_visible_chunks + cull_chunks_scalar(culling_planes, chunk_min_x, chunk_min_y, chunk_min_z, i,
+                                                         number_of_chunks,
+                                                         visible_chunk_indices + number_of_visible_chunks);
+}
+
+size_t cull_chunks_scalar(const Frustum &frustum, const float chunk_length, const float *const chunk_min_x,
+                          const float *const chunk_min_y, const float *const chunk_min_z, const size_t number_of_chunks,
+                          u32 *const visible_chunk_indices)
+{
+    return cull_chunks_scalar(get_culling_planes(frustum, chunk_length), chunk_min_x, chunk_min_y, chunk_min_z, 0u,
+                              number_of_chunks, visible_chunk_indices);
+}
+
+bool is_chunk_visible_by_clip_space_test(const DirectX::XMFLOAT4X4 &view_projection_matrix,
+                                         const DirectX::XMFLOAT3 camera_position, const float chunk_length,
+                                         const DirectX::XMFLOAT3 chunk_min)
+{
+    const auto &m = view_projection_matrix.m;
+
+    u32 outside_clip_planes_mask = 0x3fu;
+    for (u32 i = 0u; i < 8u; i++)
+    {
+        // Same corner order as the chunk AABB in the scene constant buffer. The order does not matter for the test.
+        const std::array<float, 4u> corner = {
+            chunk_min.x + ((i & 1u) ? chunk_length : 0.0f) - camera_position.x,
+            chunk_min.y + ((i & 2u) ? chunk_length : 0.0f) - camera_position.y,
+            chunk_min.z + ((i & 4u) ? chunk_length : 0.0f) - camera_position.z,
+            1.0f,
+        };
+
+        std::array<float, 4u> clip_space_coords{};
+        for (size_t j = 0u; j < 4u; j++)
+        {
+            clip_space_coords[j] =
+                corner[0] * m[0][j] + corner[1] * m[1][j] + corner[2] * m[2][j] + corner[3] * m[3][j];
+        }
+
+        const auto [x, y, z, w] = clip_space_coords;
+        outside_clip_planes_mask &= (x < -w ? 1u : 0u) | (x > w ? 2u : 0u) | (y < -w ? 4u : 0u) | (y > w ? 8u : 0u) |
+                                    (z < 0.0f ? 16u : 0u) | (z > w ? 32u : 0u);
+    }
+
+    return outside_clip_planes_mask == 0u;
+}
+
+BoxContainment classify_box(const Frustum &frustum, const DirectX::XMFLOAT3 box_min, const DirectX::XMFLOAT3 box_max)
+{
+    const DirectX::XMFLOAT3 center = {
+        (box_min.x + box_max.x) * 0.5f,
+        (box_min.y + box_max.y) * 0.5f,
+        (box_min.z + box_max.z) * 0.5f,
+    };
+    const DirectX::XMFLOAT3 half_extents = {
+        (box_max.x - box_min.x) * 0.5f,
+        (box_max.y - box_min.y) * 0.5f,
+        (box_max.z - box_min.z) * 0.5f,
+    };
+
+    BoxContainment box_containment = BoxContainment::Inside;
+    for (const DirectX::XMFLOAT4 &plane : frustum.m_planes)
+    {
+        const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+        const float radius = half_extents.x * std::abs(plane.x) + half_extents.y * std::abs(plane.y) +
+                             half_extents.z * std::abs(plane.z);
+
+        if (distance < -radius)
+        {
+            return BoxContainment::Outside;
+        }
+
+        if (distance < radius)
+        {
+            box_containment = BoxContainment::Intersecting;
+        }
+    }
+
+    return box_containment;
+}
+
+const char *get_simd_instruction_set_name()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#else
+    return "Scalar";
+#endif
+}
+} // namespace FrustumCulling
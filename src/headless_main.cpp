@@ -0,0 +1,1213 @@
+#include "voxel-engine/cave_culling.hpp"
+#include "voxel-engine/chunk_octree.hpp"
+#include "voxel-engine/frustum_culling.hpp"
+#include "voxel-engine/null_gpu_backend.hpp"
+#include "voxel-engine/occlusion_culling.hpp"
+#include "voxel-engine/timer.hpp"
+#include "voxel-engine/voxel.hpp"
+
+#include "shaders/interop/render_resources.hlsli"
+
+// View projection matrix of a camera at the origin looking in the given (normalized) direction, with the same reverse Z
+// infinite projection as the engine. It is built by hand rather than with DirectXMath, so that it does not depend on
+// the DirectXMath port of the platform.
+static DirectX::XMFLOAT4X4 create_view_projection_matrix(const DirectX::XMFLOAT3 front)
+{
+    const float sin_fov = std::sin(0.5f * DirectX::XMConvertToRadians(45.0f));
+    const float cos_fov = std::cos(0.5f * DirectX::XMConvertToRadians(45.0f));
+
+    const float height = cos_fov / sin_fov;
+    const float width = height / (16.0f / 9.0f);
+    constexpr float near_plane = 1.0f;
+
+    // right = normalize(cross(world up, front)), up = cross(front, right).
+    const float right_length = std::sqrt(front.z * front.z + front.x * front.x);
+    const DirectX::XMFLOAT3 right = {front.z / right_length, 0.0f, -front.x / right_length};
+    const DirectX::XMFLOAT3 up = {
+        front.y * right.z - front.z * right.y,
+        front.z * right.x - front.x * right.z,
+        front.x * right.y - front.y * right.x,
+    };
+
+    // The view matrix (LookToLH, the camera being at the origin) multiplied by the projection matrix.
+    const std::array<std::array<float, 4u>, 4u> rows = {{
+        {right.x * width, up.x * height, 0.0f, front.x},
+        {right.y * width, up.y * height, 0.0f, front.y},
+        {right.z * width, up.z * height, 0.0f, front.z},
+        {0.0f, 0.0f, near_plane, 0.0f},
+    }};
+
+    DirectX::XMFLOAT4X4 view_projection_matrix{};
+    for (size_t i = 0u; i < rows.size(); i++)
+    {
+        std::copy(rows[i].begin(), rows[i].end(), view_projection_matrix.m[i]);
+    }
+
+    return view_projection_matrix;
+}
+
+// World space center of a chunk.
+static DirectX::XMFLOAT3 get_chunk_center(const DirectX::XMUINT3 chunk_index_3d)
+{
+    return {
+        (static_cast<float>(chunk_index_3d.x) + 0.5f) * Chunk::CHUNK_LENGTH,
+        (static_cast<float>(chunk_index_3d.y) + 0.5f) * Chunk::CHUNK_LENGTH,
+        (static_cast<float>(chunk_index_3d.z) + 0.5f) * Chunk::CHUNK_LENGTH,
+    };
+}
+
+// Returns true if the segment from the camera to a point in the target chunk goes through a loaded chunk that is
+// entirely full (i.e an occluder) before reaching the target chunk. The segment is sampled in small steps, so a chunk
+// that the segment only grazes may be missed, which only makes this check stricter.
+static bool is_segment_blocked_by_full_chunks(const ChunkManager &chunk_manager, const DirectX::XMFLOAT3 from,
+                                              const DirectX::XMFLOAT3 to, const size_t target_chunk_index)
+{
+    constexpr float step_length = Chunk::CHUNK_LENGTH / 32.0f;
+
+    const DirectX::XMFLOAT3 delta = {to.x - from.x, to.y - from.y, to.z - from.z};
+    const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y + delta.z * delta.z);
+    const u32 number_of_steps = static_cast<u32>(std::ceil(length / step_length));
+
+    for (u32 i = 0u; i <= number_of_steps; i++)
+    {
+        const float t = static_cast<float>(i) / static_cast<float>(std::max(number_of_steps, 1u));
+        const size_t chunk_index = convert_to_1d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>({
+            static_cast<u32>((from.x + delta.x * t) / Chunk::CHUNK_LENGTH),
+            static_cast<u32>((from.y + delta.y * t) / Chunk::CHUNK_LENGTH),
+            static_cast<u32>((from.z + delta.z * t) / Chunk::CHUNK_LENGTH),
+        });
+
+        if (chunk_index == target_chunk_index)
+        {
+            return false;
+        }
+
+        const ChunkManager::LoadedChunk *const loaded_chunk = chunk_manager.m_loaded_chunks.find(chunk_index);
+        if (loaded_chunk && loaded_chunk->m_chunk.m_occupancy_state == OccupancyState::Full)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns true if the segment from the camera to a point in the target chunk goes through an active voxel of a loaded
+// chunk before reaching the target chunk. Chunks that are not loaded are empty. As above, the segment is sampled in
+// small steps.
+static bool is_segment_blocked_by_voxels(const ChunkManager &chunk_manager, const DirectX::XMFLOAT3 from,
+                                         const DirectX::XMFLOAT3 to, const size_t target_chunk_index)
+{
+    constexpr float step_length = Voxel::EDGE_LENGTH / 4.0f;
+
+    const DirectX::XMFLOAT3 delta = {to.x - from.x, to.y - from.y, to.z - from.z};
+    const float length = std::sqrt(delta.x * delta.x + delta.y * delta.y + delta.z * delta.z);
+    const u32 number_of_steps = static_cast<u32>(std::ceil(length / step_length));
+
+    for (u32 i = 0u; i <= number_of_steps; i++)
+    {
+        const float t = static_cast<float>(i) / static_cast<float>(std::max(number_of_steps, 1u));
+        const DirectX::XMUINT3 voxel_index_3d = {
+            static_cast<u32>((from.x + delta.x * t) / Voxel::EDGE_LENGTH),
+            static_cast<u32>((from.y + delta.y * t) / Voxel::EDGE_LENGTH),
+            static_cast<u32>((from.z + delta.z * t) / Voxel::EDGE_LENGTH),
+        };
+
+        const size_t chunk_index = convert_to_1d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>({
+            voxel_index_3d.x / CHUNK_DIMENSION,
+            voxel_index_3d.y / CHUNK_DIMENSION,
+            voxel_index_3d.z / CHUNK_DIMENSION,
+        });
+
+        if (chunk_index == target_chunk_index)
+        {
+            return false;
+        }
+
+        const ChunkManager::LoadedChunk *const loaded_chunk = chunk_manager.m_loaded_chunks.find(chunk_index);
+        if (loaded_chunk && loaded_chunk->m_chunk.is_voxel_active({
+                                voxel_index_3d.x % CHUNK_DIMENSION,
+                                voxel_index_3d.y % CHUNK_DIMENSION,
+                                voxel_index_3d.z % CHUNK_DIMENSION,
+                            }))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Statistics of a streaming run, and the state that stands in for the GPU between its frames.
+struct StreamingStatistics
+{
+    // There is no direct queue, so the frame index stands in for its fence value (and every frame is complete as soon
+    // as it has been 'submitted').
+    u64 m_number_of_frames{};
+
+    u64 m_peak_memory_usage_in_bytes{};
+
+    // Stands in for the upload buffer the engine copies the indirect commands that changed each frame into. The same
+    // goes for the commands of the regions.
+    std::vector<ChunkIndirectCommand> m_uploaded_indirect_commands{};
+    std::vector<ChunkIndirectCommand> m_uploaded_region_indirect_commands{};
+
+    struct OcclusionCullingStatistics
+    {
+        u64 m_number_of_occluders{};
+        u64 m_number_of_chunks_tested{};
+        u64 m_number_of_chunks_occluded{};
+        float m_total_culling_time_us{};
+    };
+
+    OcclusionCullingStatistics m_occlusion_culling{};
+
+    float m_total_cave_culling_search_time_us{};
+};
+
+// Runs a frame of the chunk pipeline, in the same order as the engine, with the player in the given chunk. The player
+// looks in the direction it is moving in (+x).
+static void run_frame(ChunkManager &chunk_manager, NullGpuBackend &gpu_backend,
+                      const DirectX::XMUINT3 player_chunk_index_3d, StreamingStatistics &statistics)
+{
+    // Chunks are only added when the player enters another chunk, in the same way as the engine.
+    chunk_manager.add_chunks_around_player_to_setup_queue(player_chunk_index_3d);
+
+    // The player looks in the direction it is moving in.
+    chunk_manager.set_view(ChunkLoadScheduler::View::create(
+        {
+            static_cast<float>(player_chunk_index_3d.x) + 0.5f,
+            static_cast<float>(player_chunk_index_3d.y) + 0.5f,
+            static_cast<float>(player_chunk_index_3d.z) + 0.5f,
+        },
+        {1.0f, 0.0f, 0.0f}, DirectX::XMConvertToRadians(45.0f), 16.0f / 9.0f));
+
+    chunk_manager.create_chunks_from_setup_queue(gpu_backend);
+    chunk_manager.transfer_chunks_from_setup_to_loaded_state(
+        gpu_backend, gpu_backend.get_completed_copy_queue_fence_value(), statistics.m_number_of_frames);
+
+    // Chunks that fall behind the player are unloaded, so that the voxel data pools and buffers are recycled.
+    chunk_manager.evict_chunks(statistics.m_number_of_frames);
+    chunk_manager.release_retired_chunk_buffers(gpu_backend.get_completed_copy_queue_fence_value(),
+                                                statistics.m_number_of_frames);
+
+    statistics.m_uploaded_indirect_commands.resize(
+        std::max(statistics.m_uploaded_indirect_commands.size(), chunk_manager.m_chunk_indirect_commands.size()));
+    chunk_manager.m_chunk_indirect_commands.upload_dirty_ranges(
+        [&](const u32 first_command_index, const u32 number_of_commands, const ChunkIndirectCommand *const commands) {
+            std::copy_n(commands, number_of_commands,
+                        statistics.m_uploaded_indirect_commands.begin() + first_command_index);
+        });
+
+    ChunkIndirectCommandArray &region_indirect_commands = chunk_manager.m_chunk_regions.m_region_indirect_commands;
+    statistics.m_uploaded_region_indirect_commands.resize(
+        std::max(statistics.m_uploaded_region_indirect_commands.size(), region_indirect_commands.size()));
+    region_indirect_commands.upload_dirty_ranges(
+        [&](const u32 first_command_index, const u32 number_of_commands, const ChunkIndirectCommand *const commands) {
+            std::copy_n(commands, number_of_commands,
+                        statistics.m_uploaded_region_indirect_commands.begin() + first_command_index);
+        });
+
+    // The player looks in the direction it is moving in, from the center of its chunk.
+    const u64 number_of_completed_occlusion_culling_frames =
+        chunk_manager.m_occlusion_culler.m_number_of_completed_frames;
+    chunk_manager.update_occlusion_culling(create_view_projection_matrix({1.0f, 0.0f, 0.0f}),
+                                           get_chunk_center(player_chunk_index_3d), 1.0f);
+    if (chunk_manager.m_occlusion_culler.m_number_of_completed_frames != number_of_completed_occlusion_culling_frames)
+    {
+        const OcclusionCuller::Frame &frame = chunk_manager.m_occlusion_culler.m_completed_frame;
+        statistics.m_occlusion_culling.m_number_of_occluders += frame.m_occluder_chunk_mins.size();
+        statistics.m_occlusion_culling.m_number_of_chunks_tested += frame.m_chunk_indices.size();
+        statistics.m_occlusion_culling.m_number_of_chunks_occluded += frame.m_occluded_chunk_indices.size();
+        statistics.m_occlusion_culling.m_total_culling_time_us += frame.m_culling_time_us;
+    }
+
+    // The search only runs when the player enters another chunk, or the face connectivity of the loaded chunks
+    // changes.
+    const u64 number_of_cave_culling_searches = chunk_manager.m_number_of_cave_culling_searches;
+    chunk_manager.update_cave_culling(player_chunk_index_3d);
+    if (chunk_manager.m_number_of_cave_culling_searches != number_of_cave_culling_searches)
+    {
+        statistics.m_total_cave_culling_search_time_us += chunk_manager.m_potentially_visible_chunks.m_search_time_us;
+    }
+
+    statistics.m_peak_memory_usage_in_bytes =
+        std::max(statistics.m_peak_memory_usage_in_bytes, chunk_manager.get_memory_usage_in_bytes());
+
+    ++statistics.m_number_of_frames;
+}
+
+// The uploaded commands must match the commands of the loaded chunks, as if they had been rebuilt every frame.
+static size_t check_indirect_commands(const ChunkManager &chunk_manager, const StreamingStatistics &statistics)
+{
+    size_t number_of_failed_checks = 0u;
+
+    const ChunkIndirectCommandArray &indirect_commands = chunk_manager.m_chunk_indirect_commands;
+    const size_t number_of_stale_indirect_commands = static_cast<size_t>(std::count_if(
+        indirect_commands.m_commands.begin(), indirect_commands.m_commands.end(),
+        [&](const ChunkIndirectCommand &command) {
+            const ChunkIndirectCommand &uploaded_command =
+                statistics.m_uploaded_indirect_commands[&command - indirect_commands.m_commands.data()];
+            return memcmp(&command, &uploaded_command, sizeof(ChunkIndirectCommand)) != 0;
+        }));
+    printf("Indirect commands : %zu, %zu uploaded (%f / frame), %zu stale\n", indirect_commands.size(),
+           indirect_commands.m_number_of_uploaded_commands,
+           static_cast<float>(indirect_commands.m_number_of_uploaded_commands) /
+               static_cast<float>(statistics.m_number_of_frames),
+           number_of_stale_indirect_commands);
+    number_of_failed_checks += number_of_stale_indirect_commands != 0u;
+
+    return number_of_failed_checks;
+}
+
+// The region commands must draw exactly the faces of the loaded chunks, and the indices of the range of each loaded
+// chunk must have the slot of the chunk in their upper bits (and a vertex of the lattice in the others).
+static size_t check_chunk_regions(const ChunkManager &chunk_manager, const StreamingStatistics &statistics)
+{
+    size_t number_of_failed_checks = 0u;
+
+    const ChunkRegions &chunk_regions = chunk_manager.m_chunk_regions;
+    const ChunkIndirectCommandArray &region_indirect_commands = chunk_regions.m_region_indirect_commands;
+
+    size_t number_of_stale_region_indirect_commands = 0u;
+    u64 number_of_region_command_indices = 0u;
+    for (size_t i = 0u; i < region_indirect_commands.size(); i++)
+    {
+        number_of_stale_region_indirect_commands +=
+            memcmp(&region_indirect_commands.m_commands[i], &statistics.m_uploaded_region_indirect_commands[i],
+                   sizeof(ChunkIndirectCommand)) != 0;
+        number_of_region_command_indices += region_indirect_commands.m_commands[i].index_count_per_instance;
+    }
+
+    size_t number_of_mismatched_region_indices = 0u;
+    chunk_manager.m_loaded_chunks.for_each(
+        [&](const size_t chunk_index, const ChunkManager::LoadedChunk &loaded_chunk) {
+            if (!loaded_chunk.m_region_allocation.is_valid())
+            {
+                return;
+            }
+
+            const u32 region_chunk_slot = ChunkRegions::get_region_chunk_slot(
+                convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index));
+            const ChunkRegions::Index *const indices =
+                static_cast<const ChunkRegions::Index *>(
+                    chunk_regions.get_page(loaded_chunk.m_region_allocation).m_index_buffer.resource.get()) +
+                loaded_chunk.m_region_allocation.m_first_face * 6u;
+
+            for (u32 i = 0u; i < loaded_chunk.m_region_allocation.m_number_of_faces * 6u; i++)
+            {
+                number_of_mismatched_region_indices +=
+                    (indices[i] >> ChunkRegions::REGION_CHUNK_SLOT_SHIFT) != region_chunk_slot ||
+                    (indices[i] & ((1u << ChunkRegions::REGION_CHUNK_SLOT_SHIFT) - 1u)) >=
+                        NUMBER_OF_SHARED_VERTICES<CHUNK_DIMENSION>;
+            }
+        });
+
+    // The loaded chunk meshes of the list of the command in the constant buffer of its page must be the meshes of
+    // loaded chunks, and cover the range of the command.
+    size_t number_of_mismatched_region_meshes = 0u;
+    for (size_t i = 0u; i < region_indirect_commands.size(); i++)
+    {
+        const ChunkIndirectCommand &command = region_indirect_commands.m_commands[i];
+        const ChunkIndirectCommand::RegionRun &region_run = command.region_run;
+        const ChunkRegions::Region &region = chunk_regions.m_regions.at(region_indirect_commands.m_owners[i]);
+
+        // The mapped constant buffer is not as aligned as the struct, so the meshes are copied out of it.
+        decltype(RegionConstantBuffer::loaded_chunk_meshes) loaded_chunk_meshes{};
+        memcpy(loaded_chunk_meshes,
+               region.m_pages[region_run.page_index].m_constant_buffer.resource_mapped_ptr +
+                   offsetof(RegionConstantBuffer, loaded_chunk_meshes),
+               sizeof(loaded_chunk_meshes));
+
+        u32 next_face = command.start_index_location / 6u;
+        for (u32 j = 0u; j < region_run.number_of_loaded_chunk_meshes; j++)
+        {
+            const DirectX::XMUINT4 &loaded_chunk_mesh =
+                loaded_chunk_meshes[region_run.loaded_chunk_mesh_list * NUMBER_OF_CHUNKS_PER_REGION +
+                                    region_run.first_loaded_chunk_mesh + j];
+            const u32 region_chunk_slot = loaded_chunk_mesh.x & ((1u << REGION_CHUNK_SLOT_BITS) - 1u);
+
+            const ChunkManager::LoadedChunk *const loaded_chunk = chunk_manager.m_loaded_chunks.find(
+                convert_to_1d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(
+                    ChunkRegions::get_chunk_index_3d(region.m_region_index_3d, region_chunk_slot)));
+            if (!loaded_chunk || loaded_chunk->m_region_allocation.m_first_face != next_face)
+            {
+                ++number_of_mismatched_region_meshes;
+                continue;
+            }
+
+            std::array<u32, NUMBER_OF_FACE_DIRECTIONS> face_counts{};
+            for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+            {
+                face_counts[face] = loaded_chunk->m_face_direction_index_ranges[face].m_number_of_indices / 6u;
+            }
+
+            const DirectX::XMUINT4 expected_loaded_chunk_mesh =
+                ChunkRegions::encode_loaded_chunk_mesh(region_chunk_slot, face_counts);
+            number_of_mismatched_region_meshes +=
+                memcmp(&loaded_chunk_mesh, &expected_loaded_chunk_mesh, sizeof(DirectX::XMUINT4)) != 0;
+
+            next_face += loaded_chunk->m_region_allocation.m_number_of_faces;
+        }
+
+        number_of_mismatched_region_meshes +=
+            next_face * 6u != command.start_index_location + command.index_count_per_instance;
+    }
+
+    printf("Regions : %zu regions, %zu pages (%zu created, %zu KiB), %zu indirect commands (%zu stale), "
+           "%zu / %zu triangles drawn, %zu mismatched indices, %zu mismatched meshes\n",
+           chunk_regions.m_regions.size(), chunk_regions.m_number_of_pages,
+           chunk_regions.m_number_of_pages_created, chunk_regions.m_pages_size_in_bytes / 1024u,
+           region_indirect_commands.size(), number_of_stale_region_indirect_commands,
+           number_of_region_command_indices / 3u, chunk_manager.m_number_of_loaded_triangles,
+           number_of_mismatched_region_indices, number_of_mismatched_region_meshes);
+    number_of_failed_checks += number_of_stale_region_indirect_commands != 0u;
+    number_of_failed_checks += number_of_mismatched_region_meshes != 0u;
+    number_of_failed_checks += number_of_mismatched_region_indices != 0u;
+    number_of_failed_checks +=
+        number_of_region_command_indices / 3u != chunk_manager.m_number_of_loaded_triangles;
+
+    return number_of_failed_checks;
+}
+
+// Levels of detail of the loaded chunks. Chunks in setup range must have been meshed at the level of detail of their
+// distance to the player once everything is loaded. Each chunk is also meshed at full resolution and at its level of
+// detail without neighbors, to measure how many triangles the levels of detail save.
+static size_t check_chunk_lods(const ChunkManager &chunk_manager, const DirectX::XMUINT3 player_chunk_index_3d)
+{
+    size_t number_of_failed_checks = 0u;
+
+    std::array<size_t, NUMBER_OF_CHUNK_LODS> number_of_chunks_per_lod{};
+    std::array<u64, NUMBER_OF_CHUNK_LODS> number_of_triangles_per_lod{};
+    std::array<u64, NUMBER_OF_CHUNK_LODS> number_of_full_resolution_triangles_per_lod{};
+    size_t number_of_stale_lods = 0u;
+
+    ChunkMesh mesh{};
+    chunk_manager.m_loaded_chunks.for_each(
+        [&](const size_t chunk_index, const ChunkManager::LoadedChunk &loaded_chunk) {
+            if (loaded_chunk.m_chunk.m_occupancy_state != OccupancyState::Mixed)
+            {
+                return;
+            }
+
+            const DirectX::XMUINT3 chunk_index_3d =
+                convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+            const u32 distance = static_cast<u32>(std::max({
+                std::abs(static_cast<i32>(chunk_index_3d.x) - static_cast<i32>(player_chunk_index_3d.x)),
+                std::abs(static_cast<i32>(chunk_index_3d.y) - static_cast<i32>(player_chunk_index_3d.y)),
+                std::abs(static_cast<i32>(chunk_index_3d.z) - static_cast<i32>(player_chunk_index_3d.z)),
+            }));
+            const u32 lod = static_cast<u32>(
+                std::count_if(ChunkManager::CHUNK_LOD_DISTANCES.begin(),
+                              ChunkManager::CHUNK_LOD_DISTANCES.end(),
+                              [&](const u32 lod_distance) { return distance > lod_distance; }));
+
+            number_of_stale_lods +=
+                distance <= ChunkManager::CHUNK_SETUP_CANCELLATION_DISTANCE && loaded_chunk.m_lod != lod;
+
+            number_of_chunks_per_lod[loaded_chunk.m_lod]++;
+            number_of_triangles_per_lod[loaded_chunk.m_lod] +=
+                loaded_chunk.m_region_allocation.m_number_of_faces * 2u;
+
+            mesh.clear();
+            ChunkMesher::binary_greedy_mesh(loaded_chunk.m_chunk, ChunkNeighborApron{}, mesh);
+            number_of_full_resolution_triangles_per_lod[loaded_chunk.m_lod] += mesh.get_triangle_count();
+        });
+
+    printf("Chunk levels of detail : %zu re-meshes, %zu stale\n", chunk_manager.m_number_of_lod_remeshes,
+           number_of_stale_lods);
+    number_of_failed_checks += number_of_stale_lods != 0u;
+    for (u32 lod = 0u; lod < NUMBER_OF_CHUNK_LODS; lod++)
+    {
+        printf("Level of detail %u : %zu mixed chunks, %zu triangles (%zu without neighbors at full "
+               "resolution)\n",
+               lod, number_of_chunks_per_lod[lod], number_of_triangles_per_lod[lod],
+               number_of_full_resolution_triangles_per_lod[lod]);
+    }
+
+    return number_of_failed_checks;
+}
+
+// Frustum culling of the loaded chunks, from the chunk of the player, in a few view directions.
+// The vectorized plane test must match the scalar one and the chunk octree, and is compared with the clip space test
+// of the culling shader : chunks culled by the clip space test only are chunks the GPU path wrongly culls.
+static size_t check_frustum_culling(ChunkManager &chunk_manager, const DirectX::XMUINT3 player_chunk_index_3d)
+{
+    size_t number_of_failed_checks = 0u;
+
+    const ChunkIndirectCommandArray &indirect_commands = chunk_manager.m_chunk_indirect_commands;
+    const DirectX::XMFLOAT3 camera_position = get_chunk_center(player_chunk_index_3d);
+
+    constexpr std::array<DirectX::XMFLOAT3, 4u> view_directions = {{
+        {1.0f, 0.0f, 0.0f},
+        {-1.0f, 0.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f},
+        {0.8f, -0.6f, 0.0f},
+    }};
+
+    const size_t number_of_chunks = indirect_commands.size();
+    const float chunk_length = static_cast<float>(Chunk::CHUNK_LENGTH);
+
+    std::vector<u32> visible_chunk_indices(number_of_chunks);
+    std::vector<u32> scalar_visible_chunk_indices(number_of_chunks);
+    std::vector<u32> hierarchical_visible_chunk_indices(number_of_chunks);
+
+    constexpr u32 number_of_iterations = 1000u;
+
+    size_t number_of_visible_chunks = 0u;
+    size_t number_of_mismatches = 0u;
+    size_t number_of_hierarchical_mismatches = 0u;
+    size_t number_of_chunks_culled_by_clip_space_test_only = 0u;
+    size_t number_of_chunks_culled_by_plane_test_only = 0u;
+    float simd_time_us = 0.0f;
+    float scalar_time_us = 0.0f;
+    float hierarchical_time_us = 0.0f;
+
+    for (const DirectX::XMFLOAT3 view_direction : view_directions)
+    {
+        const DirectX::XMFLOAT4X4 view_projection_matrix = create_view_projection_matrix(view_direction);
+        const FrustumCulling::Frustum frustum =
+            FrustumCulling::create_frustum(view_projection_matrix, camera_position);
+
+        size_t number_of_simd_visible_chunks = 0u;
+        Timer culling_timer{};
+        culling_timer.start();
+        for (u32 i = 0u; i < number_of_iterations; i++)
+        {
+            number_of_simd_visible_chunks = FrustumCulling::cull_chunks(
+                frustum, chunk_length, indirect_commands.m_bounds_min_x.data(),
+                indirect_commands.m_bounds_min_y.data(), indirect_commands.m_bounds_min_z.data(),
+                number_of_chunks, visible_chunk_indices.data());
+        }
+        culling_timer.stop();
+        simd_time_us += culling_timer.get_delta_time() * 1000000.0f;
+
+        size_t number_of_scalar_visible_chunks = 0u;
+        culling_timer.start();
+        for (u32 i = 0u; i < number_of_iterations; i++)
+        {
+            number_of_scalar_visible_chunks = FrustumCulling::cull_chunks_scalar(
+                frustum, chunk_length, indirect_commands.m_bounds_min_x.data(),
+                indirect_commands.m_bounds_min_y.data(), indirect_commands.m_bounds_min_z.data(),
+                number_of_chunks, scalar_visible_chunk_indices.data());
+        }
+        culling_timer.stop();
+        scalar_time_us += culling_timer.get_delta_time() * 1000000.0f;
+
+        size_t number_of_hierarchical_visible_chunks = 0u;
+        culling_timer.start();
+        for (u32 i = 0u; i < number_of_iterations; i++)
+        {
+            number_of_hierarchical_visible_chunks =
+                chunk_manager.cull_chunks_hierarchical(frustum, hierarchical_visible_chunk_indices.data());
+        }
+        culling_timer.stop();
+        hierarchical_time_us += culling_timer.get_delta_time() * 1000000.0f;
+
+        // The octree visits the chunks in another order than the commands.
+        std::sort(hierarchical_visible_chunk_indices.begin(),
+                  hierarchical_visible_chunk_indices.begin() + number_of_hierarchical_visible_chunks);
+        if (number_of_simd_visible_chunks != number_of_hierarchical_visible_chunks ||
+            !std::equal(visible_chunk_indices.begin(),
+                        visible_chunk_indices.begin() + number_of_simd_visible_chunks,
+                        hierarchical_visible_chunk_indices.begin()))
+        {
+            ++number_of_hierarchical_mismatches;
+        }
+
+        number_of_visible_chunks += number_of_simd_visible_chunks;
+        if (number_of_simd_visible_chunks != number_of_scalar_visible_chunks ||
+            !std::equal(visible_chunk_indices.begin(),
+                        visible_chunk_indices.begin() + number_of_simd_visible_chunks,
+                        scalar_visible_chunk_indices.begin()))
+        {
+            ++number_of_mismatches;
+        }
+
+        std::vector<bool> is_chunk_visible(number_of_chunks, false);
+        for (size_t i = 0u; i < number_of_simd_visible_chunks; i++)
+        {
+            is_chunk_visible[visible_chunk_indices[i]] = true;
+        }
+
+        for (size_t i = 0u; i < number_of_chunks; i++)
+        {
+            const bool is_visible_by_clip_space_test = FrustumCulling::is_chunk_visible_by_clip_space_test(
+                view_projection_matrix, camera_position, chunk_length,
+                {indirect_commands.m_bounds_min_x[i], indirect_commands.m_bounds_min_y[i],
+                 indirect_commands.m_bounds_min_z[i]});
+
+            number_of_chunks_culled_by_clip_space_test_only +=
+                is_chunk_visible[i] && !is_visible_by_clip_space_test;
+            number_of_chunks_culled_by_plane_test_only +=
+                !is_chunk_visible[i] && is_visible_by_clip_space_test;
+        }
+    }
+
+    const float number_of_chunks_tested =
+        static_cast<float>(number_of_chunks * view_directions.size() * number_of_iterations);
+    printf("Frustum culling (%s) : %zu / %zu chunks visible, %f chunks / us (scalar %f chunks / us), "
+           "%zu mismatches\n",
+           FrustumCulling::get_simd_instruction_set_name(), number_of_visible_chunks,
+           number_of_chunks * view_directions.size(), number_of_chunks_tested / simd_time_us,
+           number_of_chunks_tested / scalar_time_us, number_of_mismatches);
+    printf("Frustum culling with the chunk octree : %f us / frustum (flat %f us / frustum), %zu mismatches\n",
+           hierarchical_time_us / static_cast<float>(view_directions.size() * number_of_iterations),
+           simd_time_us / static_cast<float>(view_directions.size() * number_of_iterations),
+           number_of_hierarchical_mismatches);
+    printf("Frustum culling clip space test : %zu chunks culled by the clip space test only, %zu by the plane "
+           "test only\n",
+           number_of_chunks_culled_by_clip_space_test_only, number_of_chunks_culled_by_plane_test_only);
+    number_of_failed_checks += number_of_mismatches != 0u;
+    number_of_failed_checks += number_of_hierarchical_mismatches != 0u;
+    number_of_failed_checks += number_of_chunks_culled_by_clip_space_test_only != 0u;
+
+    // Whole face directions that point away from the camera are not drawn (see gpu_culling_shader.hlsl).
+    u64 number_of_indices = 0u;
+    u64 number_of_drawn_indices = 0u;
+    chunk_manager.m_loaded_chunks.for_each(
+        [&](const size_t chunk_index, const ChunkManager::LoadedChunk &loaded_chunk) {
+            const DirectX::XMUINT3 chunk_index_3d =
+                convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+            const u8 visible_face_directions_mask = get_visible_face_directions_mask(
+                {
+                    camera_position.x - static_cast<float>(chunk_index_3d.x) * chunk_length,
+                    camera_position.y - static_cast<float>(chunk_index_3d.y) * chunk_length,
+                    camera_position.z - static_cast<float>(chunk_index_3d.z) * chunk_length,
+                },
+                chunk_length);
+
+            for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+            {
+                const u32 face_direction_number_of_indices =
+                    loaded_chunk.m_face_direction_index_ranges[face].m_number_of_indices;
+
+                number_of_indices += face_direction_number_of_indices;
+                if (visible_face_directions_mask & (1u << face))
+                {
+                    number_of_drawn_indices += face_direction_number_of_indices;
+                }
+            }
+        });
+    printf("Face direction culling : %zu / %zu triangles drawn (%f %%)\n", number_of_drawn_indices / 3u,
+           number_of_indices / 3u,
+           100.0f * static_cast<float>(number_of_drawn_indices) /
+               static_cast<float>(std::max(number_of_indices, u64{1u})));
+
+    return number_of_failed_checks;
+}
+
+// Occlusion culling, from the chunk of the player once every chunk around it has been loaded.
+static size_t check_occlusion_culling(ChunkManager &chunk_manager, const DirectX::XMUINT3 player_chunk_index_3d,
+                                      const StreamingStatistics &statistics)
+{
+    size_t number_of_failed_checks = 0u;
+
+    const DirectX::XMFLOAT3 camera_position = get_chunk_center(player_chunk_index_3d);
+    const float chunk_length = static_cast<float>(Chunk::CHUNK_LENGTH);
+
+    const u64 number_of_occlusion_culling_frames =
+        chunk_manager.m_occlusion_culler.m_number_of_completed_frames;
+    const float occlusion_culling_frames =
+        static_cast<float>(std::max(number_of_occlusion_culling_frames, u64{1u}));
+    printf("Occlusion culling (%s) : %zu frames, %f occluders / frame, %f / %f chunks occluded / frame, "
+           "%f us / frame\n",
+           FrustumCulling::get_simd_instruction_set_name(), number_of_occlusion_culling_frames,
+           statistics.m_occlusion_culling.m_number_of_occluders / occlusion_culling_frames,
+           statistics.m_occlusion_culling.m_number_of_chunks_occluded / occlusion_culling_frames,
+           statistics.m_occlusion_culling.m_number_of_chunks_tested / occlusion_culling_frames,
+           statistics.m_occlusion_culling.m_total_culling_time_us / occlusion_culling_frames);
+
+    // Cull once more from the final position of the player, now that every chunk around it has been loaded.
+    // Then, check that each occluded chunk is hidden by the occluders : the segments from the camera to the
+    // center and the (slightly inset) corners of the chunk must all go through an entirely full chunk.
+    chunk_manager.m_job_system.wait_for_all_jobs();
+    chunk_manager.update_occlusion_culling(create_view_projection_matrix({1.0f, 0.0f, 0.0f}), camera_position,
+                                           1.0f);
+    chunk_manager.m_job_system.wait_for_all_jobs();
+    chunk_manager.m_occlusion_culler.poll();
+
+    const std::vector<size_t> &occluded_chunk_indices =
+        chunk_manager.m_occlusion_culler.m_completed_frame.m_occluded_chunk_indices;
+
+    size_t number_of_wrongly_occluded_chunks = 0u;
+    for (const size_t chunk_index : occluded_chunk_indices)
+    {
+        const DirectX::XMFLOAT3 chunk_center =
+            get_chunk_center(convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index));
+
+        bool is_hidden = true;
+        for (u32 i = 0u; i <= 8u && is_hidden; i++)
+        {
+            // Point 8 is the center.
+            const float inset_half_length = i < 8u ? chunk_length * 0.49f : 0.0f;
+            const DirectX::XMFLOAT3 point = {
+                chunk_center.x + ((i & 1u) ? inset_half_length : -inset_half_length),
+                chunk_center.y + ((i & 2u) ? inset_half_length : -inset_half_length),
+                chunk_center.z + ((i & 4u) ? inset_half_length : -inset_half_length),
+            };
+
+            is_hidden = is_segment_blocked_by_full_chunks(chunk_manager, camera_position, point, chunk_index);
+        }
+
+        number_of_wrongly_occluded_chunks += is_hidden ? 0u : 1u;
+    }
+    printf("Occlusion culling final frame : %zu / %zu chunks occluded, %zu of them not hidden by occluders\n",
+           occluded_chunk_indices.size(),
+           chunk_manager.m_occlusion_culler.m_completed_frame.m_chunk_indices.size(),
+           number_of_wrongly_occluded_chunks);
+    number_of_failed_checks += number_of_wrongly_occluded_chunks != 0u;
+
+    return number_of_failed_checks;
+}
+
+// Cave culling, from the chunk of the player. Each chunk with an indirect command that is not potentially visible must
+// be hidden by the voxels of the loaded chunks : the segments from the camera to the center and the (slightly inset)
+// corners of the chunk must all go through an active voxel.
+static size_t check_cave_culling(ChunkManager &chunk_manager, const DirectX::XMUINT3 player_chunk_index_3d,
+                                 const StreamingStatistics &statistics)
+{
+    size_t number_of_failed_checks = 0u;
+
+    const ChunkIndirectCommandArray &indirect_commands = chunk_manager.m_chunk_indirect_commands;
+    const DirectX::XMFLOAT3 camera_position = get_chunk_center(player_chunk_index_3d);
+    const float chunk_length = static_cast<float>(Chunk::CHUNK_LENGTH);
+
+    chunk_manager.update_cave_culling(player_chunk_index_3d);
+
+    size_t number_of_cave_culled_chunks = 0u;
+    size_t number_of_wrongly_cave_culled_chunks = 0u;
+    for (const size_t chunk_index : indirect_commands.m_owners)
+    {
+        if (chunk_manager.is_chunk_potentially_visible(chunk_index))
+        {
+            continue;
+        }
+
+        ++number_of_cave_culled_chunks;
+
+        const DirectX::XMFLOAT3 chunk_center =
+            get_chunk_center(convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index));
+
+        bool is_hidden = true;
+        for (u32 i = 0u; i <= 8u && is_hidden; i++)
+        {
+            const float inset_half_length = i < 8u ? chunk_length * 0.49f : 0.0f;
+            const DirectX::XMFLOAT3 point = {
+                chunk_center.x + ((i & 1u) ? inset_half_length : -inset_half_length),
+                chunk_center.y + ((i & 2u) ? inset_half_length : -inset_half_length),
+                chunk_center.z + ((i & 4u) ? inset_half_length : -inset_half_length),
+            };
+
+            is_hidden = is_segment_blocked_by_voxels(chunk_manager, camera_position, point, chunk_index);
+        }
+
+        number_of_wrongly_cave_culled_chunks += is_hidden ? 0u : 1u;
+    }
+
+    const CaveCulling::PotentiallyVisibleSet &potentially_visible_chunks =
+        chunk_manager.m_potentially_visible_chunks;
+    printf("Cave culling : %zu searches in %zu frames, %f us / search, %zu / %zu chunks of the search cube "
+           "visible\n",
+           chunk_manager.m_number_of_cave_culling_searches, statistics.m_number_of_frames,
+           statistics.m_total_cave_culling_search_time_us /
+               static_cast<float>(std::max(chunk_manager.m_number_of_cave_culling_searches, u64{1u})),
+           potentially_visible_chunks.m_number_of_visible_chunks,
+           potentially_visible_chunks.m_entered_faces_masks.size());
+    printf("Cave culling final frame : %zu / %zu chunks culled, %zu of them not hidden by voxels\n",
+           number_of_cave_culled_chunks, indirect_commands.size(), number_of_wrongly_cave_culled_chunks);
+    number_of_failed_checks += number_of_wrongly_cave_culled_chunks != 0u;
+
+    // Region commands are split around the chunks that are not potentially visible, and must then draw the
+    // faces of the other chunks.
+    const auto is_chunk_potentially_visible = [&](const DirectX::XMUINT3 chunk_index_3d) {
+        return chunk_manager.is_chunk_potentially_visible(
+            convert_to_1d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index_3d));
+    };
+
+    u64 number_of_potentially_visible_faces = 0u;
+    chunk_manager.m_loaded_chunks.for_each(
+        [&](const size_t chunk_index, const ChunkManager::LoadedChunk &loaded_chunk) {
+            if (chunk_manager.is_chunk_potentially_visible(chunk_index))
+            {
+                number_of_potentially_visible_faces += loaded_chunk.m_region_allocation.m_number_of_faces;
+            }
+        });
+
+    const ChunkIndirectCommandArray &region_indirect_commands =
+        chunk_manager.m_chunk_regions.m_region_indirect_commands;
+    u64 number_of_region_run_faces = 0u;
+    size_t number_of_region_runs = 0u;
+    for (size_t i = 0u; i < region_indirect_commands.size(); i++)
+    {
+        chunk_manager.m_chunk_regions.for_each_visible_run(
+            region_indirect_commands.m_owners[i], region_indirect_commands.m_commands[i],
+            is_chunk_potentially_visible, [&](const ChunkIndirectCommand &run_command) {
+                number_of_region_run_faces += run_command.index_count_per_instance / 6u;
+                ++number_of_region_runs;
+            });
+    }
+
+    printf("Cave culling of region commands : %zu runs, %zu / %zu faces of potentially visible chunks drawn\n",
+           number_of_region_runs, number_of_region_run_faces, number_of_potentially_visible_faces);
+    number_of_failed_checks += number_of_region_run_faces != number_of_potentially_visible_faces;
+
+    // The face connectivity of the loaded chunks is computed again to time it, and must match the one that
+    // was computed when they were meshed. The search is also timed at a larger radius than the unload
+    // distance, where most chunks are not loaded (and are all connected).
+    size_t number_of_mixed_chunks = 0u;
+    size_t number_of_stale_face_connectivities = 0u;
+    Timer face_connectivity_timer{};
+    face_connectivity_timer.start();
+    chunk_manager.m_loaded_chunks.for_each([&](const size_t, const ChunkManager::LoadedChunk &loaded_chunk) {
+        if (loaded_chunk.m_chunk.m_occupancy_state == OccupancyState::Mixed)
+        {
+            const CaveCulling::FaceConnectivity face_connectivity =
+                CaveCulling::compute_face_connectivity(loaded_chunk.m_chunk);
+            ++number_of_mixed_chunks;
+            number_of_stale_face_connectivities += face_connectivity != loaded_chunk.m_face_connectivity;
+        }
+    });
+    face_connectivity_timer.stop();
+
+    constexpr u32 large_search_radius = 16u;
+    constexpr u32 number_of_large_searches = 16u;
+    CaveCulling::PotentiallyVisibleSet large_potentially_visible_set{};
+    float large_search_time_us = 0.0f;
+    for (u32 i = 0u; i < number_of_large_searches; i++)
+    {
+        large_potentially_visible_set.update<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(
+            potentially_visible_chunks.m_camera_chunk_index_3d, large_search_radius,
+            [&](const size_t chunk_index) { return chunk_manager.get_face_connectivity(chunk_index); });
+        large_search_time_us += large_potentially_visible_set.m_search_time_us;
+    }
+
+    printf("Cave culling face connectivity : %f us / mixed chunk, %zu stale, search at radius %u : %f us, "
+           "%zu / %zu chunks visible\n",
+           face_connectivity_timer.get_delta_time() * 1000000.0f /
+               static_cast<float>(std::max(number_of_mixed_chunks, size_t{1u})),
+           number_of_stale_face_connectivities, large_search_radius,
+           large_search_time_us / static_cast<float>(number_of_large_searches),
+           large_potentially_visible_set.m_number_of_visible_chunks,
+           large_potentially_visible_set.m_entered_faces_masks.size());
+    number_of_failed_checks += number_of_stale_face_connectivities != 0u;
+
+    return number_of_failed_checks;
+}
+
+// The chunk octree, and its queries from the chunk of the player.
+static size_t check_chunk_octree(const ChunkManager &chunk_manager, const DirectX::XMUINT3 player_chunk_index_3d)
+{
+    size_t number_of_failed_checks = 0u;
+
+    const DirectX::XMFLOAT3 camera_position = get_chunk_center(player_chunk_index_3d);
+    const float chunk_length = static_cast<float>(Chunk::CHUNK_LENGTH);
+
+    // The chunk octree must hold every loaded chunk, with the flags it would be given now. Its queries are
+    // checked against a loop over the loaded chunks.
+    const ChunkOctree &chunk_octree = chunk_manager.m_chunk_octree;
+    size_t number_of_loaded_chunks = 0u;
+    size_t number_of_wrong_octree_leaves = 0u;
+    chunk_manager.m_loaded_chunks.for_each(
+        [&](const size_t chunk_index, const ChunkManager::LoadedChunk &loaded_chunk) {
+            ++number_of_loaded_chunks;
+
+            const OccupancyState occupancy_state = loaded_chunk.m_chunk.m_occupancy_state;
+            const u8 flags = static_cast<u8>(
+                (occupancy_state == OccupancyState::Empty ? ChunkOctree::FLAG_EMPTY : 0u) |
+                (occupancy_state == OccupancyState::Full ? ChunkOctree::FLAG_FULL : 0u) |
+                (loaded_chunk.m_indirect_command_handle != ChunkIndirectCommandArray::INVALID_HANDLE
+                     ? ChunkOctree::FLAG_HAS_MESH
+                     : 0u) |
+                (chunk_manager.m_chunk_indices_that_are_being_setup.contains(chunk_index)
+                     ? ChunkOctree::FLAG_DIRTY
+                     : 0u));
+
+            const u32 leaf = chunk_octree.find_leaf(
+                convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index));
+            number_of_wrong_octree_leaves += leaf == ChunkOctree::INVALID_NODE ||
+                                             chunk_octree.m_nodes[leaf].m_chunk_index != chunk_index ||
+                                             chunk_octree.m_nodes[leaf].m_any_flags != flags;
+        });
+
+    size_t number_of_octree_chunks = 0u;
+    for (const u32 root : chunk_octree.m_roots)
+    {
+        number_of_octree_chunks += chunk_octree.m_nodes[root].m_number_of_chunks;
+    }
+
+    printf("Chunk octree : %zu nodes, %zu roots, %zu / %zu chunks, %zu wrong leaves, %zu updates\n",
+           chunk_octree.get_number_of_nodes(), chunk_octree.m_roots.size(), number_of_octree_chunks,
+           number_of_loaded_chunks, number_of_wrong_octree_leaves, chunk_octree.m_number_of_updates);
+    number_of_failed_checks += number_of_wrong_octree_leaves != 0u;
+    number_of_failed_checks += number_of_octree_chunks != number_of_loaded_chunks;
+
+    const DirectX::XMINT3 camera_chunk_index = {
+        static_cast<i32>(player_chunk_index_3d.x),
+        static_cast<i32>(player_chunk_index_3d.y),
+        static_cast<i32>(player_chunk_index_3d.z),
+    };
+    constexpr u32 number_of_query_iterations = 100u;
+
+    std::vector<size_t> octree_far_chunk_indices{};
+    Timer query_timer{};
+    query_timer.start();
+    for (u32 i = 0u; i < number_of_query_iterations; i++)
+    {
+        octree_far_chunk_indices.clear();
+        chunk_octree.for_each_chunk_further_than(
+            camera_chunk_index, ChunkManager::CHUNK_RENDER_DISTANCE,
+            [&](const size_t chunk_index) { octree_far_chunk_indices.push_back(chunk_index); });
+    }
+    query_timer.stop();
+    const float octree_far_query_time_us = query_timer.get_delta_time() * 1000000.0f;
+
+    std::vector<size_t> far_chunk_indices{};
+    query_timer.start();
+    for (u32 i = 0u; i < number_of_query_iterations; i++)
+    {
+        far_chunk_indices.clear();
+        chunk_manager.m_loaded_chunks.for_each(
+            [&](const size_t chunk_index, const ChunkManager::LoadedChunk &) {
+                const DirectX::XMUINT3 chunk_index_3d =
+                    convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+                const i32 distance = std::max({
+                    std::abs(static_cast<i32>(chunk_index_3d.x) - camera_chunk_index.x),
+                    std::abs(static_cast<i32>(chunk_index_3d.y) - camera_chunk_index.y),
+                    std::abs(static_cast<i32>(chunk_index_3d.z) - camera_chunk_index.z),
+                });
+
+                if (distance > static_cast<i32>(ChunkManager::CHUNK_RENDER_DISTANCE))
+                {
+                    far_chunk_indices.push_back(chunk_index);
+                }
+            });
+    }
+    query_timer.stop();
+    const float far_query_time_us = query_timer.get_delta_time() * 1000000.0f;
+
+    std::sort(octree_far_chunk_indices.begin(), octree_far_chunk_indices.end());
+    std::sort(far_chunk_indices.begin(), far_chunk_indices.end());
+    printf("Chunk octree eviction query : %zu chunks out of render distance, %f us / query (loop %f us / "
+           "query), %s\n",
+           octree_far_chunk_indices.size(), octree_far_query_time_us / number_of_query_iterations,
+           far_query_time_us / number_of_query_iterations,
+           octree_far_chunk_indices == far_chunk_indices ? "matches" : "mismatch");
+    number_of_failed_checks += octree_far_chunk_indices != far_chunk_indices;
+
+    // Rays from the camera, against the full chunks. The nearest full chunk is also searched by testing the
+    // ray against each of them.
+    const auto get_ray_entry_distance = [&](const DirectX::XMFLOAT3 direction,
+                                            const DirectX::XMUINT3 chunk_index_3d) -> std::optional<float> {
+        const std::array<float, 3u> origin = {camera_position.x, camera_position.y, camera_position.z};
+        const std::array<float, 3u> directions = {direction.x, direction.y, direction.z};
+        const std::array<float, 3u> chunk_min = {
+            static_cast<float>(chunk_index_3d.x) * chunk_length,
+            static_cast<float>(chunk_index_3d.y) * chunk_length,
+            static_cast<float>(chunk_index_3d.z) * chunk_length,
+        };
+
+        float entry_distance = 0.0f;
+        float exit_distance = std::numeric_limits<float>::infinity();
+        for (u32 axis = 0u; axis < 3u; axis++)
+        {
+            const float a = (chunk_min[axis] - origin[axis]) / directions[axis];
+            const float b = (chunk_min[axis] + chunk_length - origin[axis]) / directions[axis];
+            entry_distance = std::max(entry_distance, std::min(a, b));
+            exit_distance = std::min(exit_distance, std::max(a, b));
+        }
+
+        return entry_distance <= exit_distance ? std::optional<float>(entry_distance) : std::nullopt;
+    };
+
+    constexpr u32 number_of_rays = 1000u;
+    const float max_ray_distance = static_cast<float>(ChunkManager::CHUNK_UNLOAD_DISTANCE) * chunk_length;
+
+    std::mt19937 random_engine(1234u);
+    std::normal_distribution<float> normal_distribution{};
+
+    size_t number_of_ray_hits = 0u;
+    size_t number_of_ray_mismatches = 0u;
+    float raycast_time_us = 0.0f;
+    for (u32 i = 0u; i < number_of_rays; i++)
+    {
+        DirectX::XMFLOAT3 direction = {normal_distribution(random_engine), normal_distribution(random_engine),
+                                       normal_distribution(random_engine)};
+        DirectX::XMStoreFloat3(&direction, DirectX::XMVector3Normalize(DirectX::XMLoadFloat3(&direction)));
+
+        query_timer.start();
+        const std::optional<ChunkOctree::RayHit> ray_hit = chunk_octree.raycast(
+            camera_position, direction, max_ray_distance, chunk_length, ChunkOctree::FLAG_FULL);
+        query_timer.stop();
+        raycast_time_us += query_timer.get_delta_time() * 1000000.0f;
+
+        std::optional<float> nearest_distance{};
+        chunk_octree.for_each_chunk(ChunkOctree::FLAG_FULL, [&](const size_t chunk_index) {
+            const std::optional<float> distance = get_ray_entry_distance(
+                direction, convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index));
+            if (distance.has_value() && *distance <= max_ray_distance &&
+                (!nearest_distance.has_value() || *distance < *nearest_distance))
+            {
+                nearest_distance = distance;
+            }
+        });
+
+        // Chunks that the ray enters at the same distance (e.g through a shared edge) may both be the nearest.
+        number_of_ray_hits += ray_hit.has_value();
+        number_of_ray_mismatches +=
+            ray_hit.has_value() != nearest_distance.has_value() ||
+            (ray_hit.has_value() && std::abs(ray_hit->m_distance - *nearest_distance) > chunk_length * 1e-3f);
+    }
+
+    printf("Chunk octree ray casts : %zu / %u rays hit a full chunk, %f us / ray, %zu mismatches\n",
+           number_of_ray_hits, number_of_rays, raycast_time_us / number_of_rays, number_of_ray_mismatches);
+    number_of_failed_checks += number_of_ray_mismatches != 0u;
+
+    return number_of_failed_checks;
+}
+
+// The player leaves render distance and comes back while the setup of the chunks around it is still in flight : the
+// only worker thread is kept busy until the player is back, so the setups cancelled on the way are only discarded then.
+// Every chunk within render distance of the player must still be loaded once the workers are done.
+static size_t check_streaming_round_trip(NullGpuBackend &gpu_backend)
+{
+    size_t number_of_failed_checks = 0u;
+
+    ChunkManager chunk_manager(gpu_backend, 1u);
+    StreamingStatistics statistics{};
+
+    constexpr u32 chunk_grid_middle = ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION / 2u;
+    constexpr u32 number_of_chunks_to_move = ChunkManager::CHUNK_RENDER_DISTANCE + 2u;
+    constexpr u32 number_of_frames_before_round_trip = 4u;
+    constexpr u32 number_of_frames_after_round_trip = 200u;
+
+    const DirectX::XMUINT3 start_chunk_index_3d = {chunk_grid_middle, chunk_grid_middle, chunk_grid_middle};
+
+    std::atomic<bool> is_worker_parked{false};
+    std::atomic<bool> is_worker_released{false};
+    chunk_manager.m_job_system.submit(chunk_manager.m_job_system.create_job(
+        [&]() {
+            is_worker_parked.store(true);
+            while (!is_worker_released.load())
+            {
+                std::this_thread::yield();
+            }
+        },
+        JobPriority::High));
+
+    while (!is_worker_parked.load())
+    {
+        std::this_thread::yield();
+    }
+
+    // The setup of the chunks closest to the player is submitted, then the player walks away and back.
+    for (u32 i = 0u; i < number_of_frames_before_round_trip; i++)
+    {
+        run_frame(chunk_manager, gpu_backend, start_chunk_index_3d, statistics);
+    }
+
+    for (u32 i = 1u; i <= 2u * number_of_chunks_to_move; i++)
+    {
+        const u32 distance_moved = i <= number_of_chunks_to_move ? i : 2u * number_of_chunks_to_move - i;
+        run_frame(chunk_manager, gpu_backend,
+                  {start_chunk_index_3d.x + distance_moved, start_chunk_index_3d.y, start_chunk_index_3d.z},
+                  statistics);
+    }
+
+    is_worker_released.store(true);
+
+    while (!chunk_manager.m_chunk_indices_that_are_being_setup.empty())
+    {
+        run_frame(chunk_manager, gpu_backend, start_chunk_index_3d, statistics);
+        std::this_thread::yield();
+    }
+
+    for (u32 i = 0u; i < number_of_frames_after_round_trip; i++)
+    {
+        run_frame(chunk_manager, gpu_backend, start_chunk_index_3d, statistics);
+    }
+
+    constexpr u32 render_distance = ChunkManager::CHUNK_RENDER_DISTANCE;
+    size_t number_of_missing_chunks = 0u;
+    for (u32 z = chunk_grid_middle - render_distance; z <= chunk_grid_middle + render_distance; z++)
+    {
+        for (u32 y = chunk_grid_middle - render_distance; y <= chunk_grid_middle + render_distance; y++)
+        {
+            for (u32 x = chunk_grid_middle - render_distance; x <= chunk_grid_middle + render_distance; x++)
+            {
+                number_of_missing_chunks += !chunk_manager.m_loaded_chunks.contains(
+                    convert_to_1d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>({x, y, z}));
+            }
+        }
+    }
+
+    printf("Streaming round trip : %u chunks away and back with setups in flight, %zu cancelled, %zu chunks within "
+           "render distance missing\n",
+           number_of_chunks_to_move, chunk_manager.m_number_of_cancelled_setup_chunks, number_of_missing_chunks);
+    number_of_failed_checks += number_of_missing_chunks != 0u;
+
+    return number_of_failed_checks;
+}
+
+static void print_pipeline_statistics(const ChunkManager &chunk_manager, const StreamingStatistics &statistics)
+{
+    constexpr std::array<const char *, 2u> meshing_mode_names = {"Naive", "Binary greedy"};
+    for (size_t i = 0; i < meshing_mode_names.size(); i++)
+    {
+        const auto &meshing_statistics = chunk_manager.m_meshing_statistics[i];
+        if (meshing_statistics.m_number_of_chunks_meshed == 0u)
+        {
+            continue;
+        }
+
+        const float number_of_chunks_meshed = static_cast<float>(meshing_statistics.m_number_of_chunks_meshed);
+        printf("%s mesher : %zu chunks, %f us / chunk, %f triangles / chunk\n", meshing_mode_names[i],
+               meshing_statistics.m_number_of_chunks_meshed,
+               meshing_statistics.m_total_meshing_time_us / number_of_chunks_meshed,
+               meshing_statistics.m_number_of_triangles / number_of_chunks_meshed);
+    }
+
+    constexpr std::array<const char *, 2u> terrain_preset_names = {"Heightmap", "Density"};
+    for (size_t i = 0; i < terrain_preset_names.size(); i++)
+    {
+        const auto &generation_statistics = chunk_manager.m_generation_statistics[i];
+        if (generation_statistics.m_number_of_chunks_generated == 0u)
+        {
+            continue;
+        }
+
+        printf("%s generation (%s) : %zu chunks, %f us / chunk, %f million voxels / sec / thread\n",
+               terrain_preset_names[i], Noise::get_simd_instruction_set_name(),
+               generation_statistics.m_number_of_chunks_generated,
+               generation_statistics.m_total_generation_time_us /
+                   static_cast<float>(generation_statistics.m_number_of_chunks_generated),
+               static_cast<float>(generation_statistics.m_number_of_voxels_generated) /
+                   generation_statistics.m_total_generation_time_us);
+    }
+
+    const BlockPool::Statistics pool_statistics = Chunk::get_voxel_data_pool_statistics();
+    printf("Voxel data pools : %zu blocks in use (peak %zu), %zu pages, %zu KiB reserved\n",
+           pool_statistics.m_number_of_blocks_in_use, pool_statistics.m_peak_number_of_blocks_in_use,
+           pool_statistics.m_number_of_page_allocations, pool_statistics.m_reserved_size_in_bytes / 1024u);
+
+    // The mesh upload pool stops growing once streaming reaches a steady state, just like the voxel data pools.
+    const UploadPool::Statistics upload_pool_statistics = chunk_manager.m_mesh_upload_pool.get_statistics();
+    printf("Mesh upload pool : %zu ranges allocated, %zu KiB in use (peak %zu KiB), %zu pages, %zu KiB reserved\n",
+           upload_pool_statistics.m_number_of_allocations, upload_pool_statistics.m_size_in_bytes_in_use / 1024u,
+           upload_pool_statistics.m_peak_size_in_bytes_in_use / 1024u,
+           upload_pool_statistics.m_number_of_page_allocations,
+           upload_pool_statistics.m_reserved_size_in_bytes / 1024u);
+    printf("Chunk memory usage : %zu KiB (peak %zu KiB, budget %zu KiB)\n",
+           chunk_manager.get_memory_usage_in_bytes() / 1024u, statistics.m_peak_memory_usage_in_bytes / 1024u,
+           chunk_manager.m_memory_budget_in_bytes / 1024u);
+    printf("Scratch mesh allocations : %zu\n", chunk_manager.m_number_of_scratch_mesh_allocations.load());
+
+    const JobSystem::Statistics job_system_statistics = chunk_manager.m_job_system.get_statistics();
+    printf("Jobs : %u worker threads, %zu executed, %zu stolen\n",
+           chunk_manager.m_job_system.get_number_of_worker_threads(),
+           job_system_statistics.m_number_of_jobs_executed, job_system_statistics.m_number_of_jobs_stolen);
+}
+
+// Streams chunks around a player that moves through the world at a constant speed, without a window or GPU (see
+// NullGpuBackend). This runs the same chunk pipeline as the engine (generation, meshing, buffer creation, loading and
+// unloading), so it can be used to profile and benchmark it on any platform. The results of the pipeline are then
+// checked against reference implementations : any failed check fails the run (see the tests in src/CMakeLists.txt).
+// Scaling can be measured by varying the number of worker threads (by default, one per hardware thread but one).
+// The memory budget of the chunk manager can be lowered to exercise budgeted eviction.
+// Usage : voxel-engine-headless [number of chunks to move] [frames per chunk moved] [number of worker threads]
+// [memory budget in KiB]
+int main(int argc, char **argv)
+{
+    const u32 number_of_chunks_to_move = argc > 1 ? static_cast<u32>(std::atoi(argv[1])) : 32u;
+    const u32 frames_per_chunk_moved = argc > 2 ? std::max(static_cast<u32>(std::atoi(argv[2])), 1u) : 8u;
+    const u32 number_of_worker_threads = argc > 3 ? static_cast<u32>(std::atoi(argv[3])) : 0u;
+    const u64 memory_budget_in_bytes =
+        argc > 4 ? std::strtoull(argv[4], nullptr, 10) * 1024u : ChunkManager::DEFAULT_MEMORY_BUDGET_IN_BYTES;
+
+    NullGpuBackend gpu_backend{};
+
+    // Number of checks (stale or mismatching results against a reference) that failed. Any of them fails the run, and
+    // each check that fails is reported by name.
+    size_t number_of_failed_checks = 0u;
+    const auto run_check = [&](const char *const check_name, const size_t number_of_check_failures) {
+        if (number_of_check_failures != 0u)
+        {
+            printf("Check failed : %s (%zu failures)\n", check_name, number_of_check_failures);
+        }
+
+        number_of_failed_checks += number_of_check_failures;
+    };
+
+    {
+        ChunkManager chunk_manager(gpu_backend, number_of_worker_threads);
+        chunk_manager.m_memory_budget_in_bytes = memory_budget_in_bytes;
+
+        constexpr u32 chunk_grid_middle = ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION / 2u;
+
+        StreamingStatistics statistics{};
+
+        Timer timer{};
+        timer.start();
+
+        // Once the player stops moving, keep running frames until every chunk around the player has been loaded.
+        const u64 number_of_frames_moving = static_cast<u64>(number_of_chunks_to_move) * frames_per_chunk_moved;
+        while (statistics.m_number_of_frames < number_of_frames_moving ||
+               !chunk_manager.m_chunk_indices_that_are_being_setup.empty())
+        {
+            const u32 distance_moved = static_cast<u32>(
+                std::min(statistics.m_number_of_frames, number_of_frames_moving) / frames_per_chunk_moved);
+
+            run_frame(chunk_manager, gpu_backend,
+                      {chunk_grid_middle + distance_moved, chunk_grid_middle, chunk_grid_middle}, statistics);
+
+            // Once the player has stopped, frames only wait for the workers. The main thread yields, as spinning on
+            // empty frames can starve the workers on machines with few cores.
+            if (statistics.m_number_of_frames > number_of_frames_moving)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        timer.stop();
+
+        const float total_time_s = timer.get_delta_time();
+
+        printf("Chunk dimension : %u (%zu bit indices)\n", CHUNK_DIMENSION, sizeof(ChunkMesh::Index) * 8u);
+        printf("Frames : %zu, %f s (%f ms / frame)\n", statistics.m_number_of_frames, total_time_s,
+               total_time_s * 1000.0f / static_cast<float>(statistics.m_number_of_frames));
+        printf("Chunks : %zu loaded, %zu unloaded, %zu cancelled, %zu triangles loaded\n",
+               chunk_manager.m_loaded_chunks.size(), chunk_manager.m_number_of_unloaded_chunks,
+               chunk_manager.m_number_of_cancelled_setup_chunks, chunk_manager.m_number_of_loaded_triangles);
+
+        const DirectX::XMUINT3 player_chunk_index_3d = {chunk_grid_middle + number_of_chunks_to_move,
+                                                        chunk_grid_middle, chunk_grid_middle};
+
+        run_check("Indirect commands", check_indirect_commands(chunk_manager, statistics));
+        run_check("Chunk regions", check_chunk_regions(chunk_manager, statistics));
+        run_check("Chunk levels of detail", check_chunk_lods(chunk_manager, player_chunk_index_3d));
+        run_check("Frustum culling", check_frustum_culling(chunk_manager, player_chunk_index_3d));
+        run_check("Occlusion culling", check_occlusion_culling(chunk_manager, player_chunk_index_3d, statistics));
+        run_check("Cave culling", check_cave_culling(chunk_manager, player_chunk_index_3d, statistics));
+        run_check("Chunk octree", check_chunk_octree(chunk_manager, player_chunk_index_3d));
+
+        print_pipeline_statistics(chunk_manager, statistics);
+    }
+
+    run_check("Streaming round trip", check_streaming_round_trip(gpu_backend));
+
+    // All chunks have been destroyed, so every resource should have been released.
+    const NullGpuBackend::Statistics gpu_backend_statistics = gpu_backend.get_statistics();
+    printf("Buffers created : %zu index, %zu structured, %zu constant, %zu upload (%zu KiB uploaded)\n",
+           gpu_backend_statistics.m_number_of_index_buffers_created,
+           gpu_backend_statistics.m_number_of_structured_buffers_created,
+           gpu_backend_statistics.m_number_of_constant_buffers_created,
+           gpu_backend_statistics.m_number_of_upload_buffers_created,
+           gpu_backend_statistics.m_uploaded_size_in_bytes / 1024u);
+    printf("Live resources after shutdown : %zu (%zu bytes)\n", gpu_backend_statistics.m_number_of_live_resources,
+           gpu_backend_statistics.m_live_resources_size_in_bytes);
+
+    printf("Failed checks : %zu\n", number_of_failed_checks);
+
+    return number_of_failed_checks == 0u && gpu_backend_statistics.m_number_of_live_resources == 0u ? EXIT_SUCCESS
+                                                                                                      : EXIT_FAILURE;
+}
@@ -0,0 +1,50 @@
+#include "voxel-engine/heightmap_column_cache.hpp"
+
+const HeightmapColumn &HeightmapColumnCache::Entry::get_or_generate(const TerrainSettings &terrain_settings,
+                                                                    bool &is_generated)
+{
+    std::call_once(m_once_flag, [&]() {
+        TerrainGenerator::generate_heightmap_column(terrain_settings, m_chunk_x, m_chunk_z, m_heightmap_column);
+        is_generated = true;
+    });
+
+    return m_heightmap_column;
+}
+
+void HeightmapColumnCache::acquire(const u32 chunk_x, const u32 chunk_z)
+{
+    std::shared_ptr<Entry> &entry = m_entries[get_key(chunk_x, chunk_z)];
+    if (!entry)
+    {
+        entry = std::make_shared<Entry>();
+        entry->m_chunk_x = chunk_x;
+        entry->m_chunk_z = chunk_z;
+    }
+
+    entry->m_reference_count++;
+}
+
+void HeightmapColumnCache::release(const u32 chunk_x, const u32 chunk_z)
+{
+    const auto entry = m_entries.find(get_key(chunk_x, chunk_z));
+    if (entry == m_entries.end())
+    {
+        return;
+    }
+
+    if (--entry->second->m_reference_count == 0u)
+    {
+        m_entries.erase(entry);
+    }
+}
+
+std::shared_ptr<HeightmapColumnCache::Entry> HeightmapColumnCache::get(const u32 chunk_x, const u32 chunk_z) const
+{
+    const auto entry = m_entries.find(get_key(chunk_x, chunk_z));
+    if (entry == m_entries.end())
+    {
+        return nullptr;
+    }
+
+    return entry->second;
+}
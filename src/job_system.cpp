@@ -0,0 +1,225 @@
+#include "voxel-engine/job_system.hpp"
+
+// Set for the worker threads of a job system, so that jobs queued by a worker go to its own deques.
+static thread_local const JobSystem *t_job_system{};
+static thread_local u32 t_worker_index{};
+
+JobSystem::JobSystem(const u32 number_of_worker_threads)
+{
+    const u32 number_of_workers = number_of_worker_threads != 0u
+                                      ? number_of_worker_threads
+                                      : std::max(std::thread::hardware_concurrency(), 2u) - 1u;
+
+    for (u32 i = 0; i < number_of_workers; i++)
+    {
+        m_workers.emplace_back(std::make_unique<Worker>());
+    }
+
+    // Workers are only started once all of them exist, as they steal from each other.
+    for (u32 i = 0; i < number_of_workers; i++)
+    {
+        m_workers[i]->m_thread = std::thread([this, i]() { worker_thread_function(i); });
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    wait_for_all_jobs();
+
+    {
+        std::scoped_lock<std::mutex> scoped_lock(m_sleep_mutex);
+        m_stop = true;
+    }
+
+    m_sleep_condition_variable.notify_all();
+
+    for (const auto &worker : m_workers)
+    {
+        worker->m_thread.join();
+    }
+}
+
+JobSystem::JobHandle JobSystem::create_job(std::function<void()> function, const JobPriority priority)
+{
+    JobHandle job = std::make_shared<Job>();
+    job->m_function = std::move(function);
+    job->m_priority = priority;
+
+    return job;
+}
+
+void JobSystem::add_dependency(const JobHandle &job, const JobHandle &dependency)
+{
+    std::scoped_lock<std::mutex> scoped_lock(dependency->m_mutex);
+    if (dependency->m_is_complete)
+    {
+        return;
+    }
+
+    job->m_number_of_pending_dependencies++;
+    dependency->m_dependents.push_back(job);
+}
+
+void JobSystem::submit(const JobHandle &job)
+{
+    m_number_of_pending_jobs++;
+
+    if (--job->m_number_of_pending_dependencies == 0u)
+    {
+        queue_job(JobHandle(job));
+    }
+}
+
+void JobSystem::wait_for_all_jobs()
+{
+    std::unique_lock<std::mutex> unique_lock(m_sleep_mutex);
+    m_idle_condition_variable.wait(unique_lock, [&]() { return m_number_of_pending_jobs.load() == 0u; });
+}
+
+u32 JobSystem::get_number_of_worker_threads() const
+{
+    return static_cast<u32>(m_workers.size());
+}
+
+u64 JobSystem::get_number_of_pending_jobs() const
+{
+    return m_number_of_pending_jobs.load();
+}
+
+JobSystem::Statistics JobSystem::get_statistics() const
+{
+    Statistics statistics{};
+    for (const auto &worker : m_workers)
+    {
+        statistics.m_number_of_jobs_executed += worker->m_number_of_jobs_executed.load(std::memory_order_relaxed);
+        statistics.m_number_of_jobs_stolen += worker->m_number_of_jobs_stolen.load(std::memory_order_relaxed);
+    }
+
+    return statistics;
+}
+
+void JobSystem::worker_thread_function(const u32 worker_index)
+{
+    t_job_system = this;
+    t_worker_index = worker_index;
+
+    Worker &worker = *m_workers[worker_index];
+
+    while (true)
+    {
+        if (const JobHandle job = pop_or_steal_job(worker_index))
+        {
+            job->m_function();
+
+            // Release whatever the job captured as soon as possible, rather than when the last handle is destroyed.
+            job->m_function = nullptr;
+
+            worker.m_number_of_jobs_executed.fetch_add(1u, std::memory_order_relaxed);
+            complete_job(job);
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> unique_lock(m_sleep_mutex);
+        m_sleep_condition_variable.wait(unique_lock,
+                                        [&]() { return m_stop || m_number_of_queued_jobs.load() != 0u; });
+
+        if (m_stop && m_number_of_queued_jobs.load() == 0u)
+        {
+            return;
+        }
+    }
+}
+
+void JobSystem::queue_job(JobHandle &&job)
+{
+    const u32 worker_index = t_job_system == this
+                                 ? t_worker_index
+                                 : m_next_worker_index.fetch_add(1u, std::memory_order_relaxed) %
+                                       static_cast<u32>(m_workers.size());
+
+    // Counted before it is pushed, so that the count never drops below the number of jobs in the deques.
+    m_number_of_queued_jobs++;
+
+    Worker &worker = *m_workers[worker_index];
+    {
+        std::scoped_lock<std::mutex> scoped_lock(worker.m_mutex);
+        worker.m_jobs[static_cast<u32>(job->m_priority)].push_back(std::move(job));
+    }
+
+    // The mutex is acquired so that the notification cannot happen between a sleeping worker checking the number of
+    // queued jobs and it starting to wait.
+    {
+        std::scoped_lock<std::mutex> scoped_lock(m_sleep_mutex);
+    }
+
+    m_sleep_condition_variable.notify_one();
+}
+
+JobSystem::JobHandle JobSystem::pop_or_steal_job(const u32 worker_index)
+{
+    const u32 number_of_workers = static_cast<u32>(m_workers.size());
+
+    for (u32 priority = 0; priority < NUMBER_OF_JOB_PRIORITIES; priority++)
+    {
+        {
+            Worker &worker = *m_workers[worker_index];
+
+            std::scoped_lock<std::mutex> scoped_lock(worker.m_mutex);
+            if (auto &jobs = worker.m_jobs[priority]; !jobs.empty())
+            {
+                JobHandle job = std::move(jobs.back());
+                jobs.pop_back();
+
+                m_number_of_queued_jobs--;
+                return job;
+            }
+        }
+
+        // Start stealing at the next worker, so that the workers do not all steal from the same victim.
+        for (u32 i = 1; i < number_of_workers; i++)
+        {
+            Worker &victim = *m_workers[(worker_index + i) % number_of_workers];
+
+            std::scoped_lock<std::mutex> scoped_lock(victim.m_mutex);
+            if (auto &jobs = victim.m_jobs[priority]; !jobs.empty())
+            {
+                JobHandle job = std::move(jobs.front());
+                jobs.pop_front();
+
+                m_number_of_queued_jobs--;
+                m_workers[worker_index]->m_number_of_jobs_stolen.fetch_add(1u, std::memory_order_relaxed);
+                return job;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+void JobSystem::complete_job(const JobHandle &job)
+{
+    std::vector<JobHandle> dependents{};
+    {
+        std::scoped_lock<std::mutex> scoped_lock(job->m_mutex);
+        job->m_is_complete = true;
+        dependents = std::move(job->m_dependents);
+    }
+
+    for (JobHandle &dependent : dependents)
+    {
+        if (--dependent->m_number_of_pending_dependencies == 0u)
+        {
+            queue_job(std::move(dependent));
+        }
+    }
+
+    if (--m_number_of_pending_jobs == 0u)
+    {
+        {
+            std::scoped_lock<std::mutex> scoped_lock(m_sleep_mutex);
+        }
+
+        m_idle_condition_variable.notify_all();
+    }
+}
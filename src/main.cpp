@@ -1,5 +1,6 @@
 #include "voxel-engine/camera.hpp"
 #include "voxel-engine/filesystem.hpp"
+#include "voxel-engine/frustum_culling.hpp"
 #include "voxel-engine/renderer.hpp"
 #include "voxel-engine/shader_compiler.hpp"
 #include "voxel-engine/timer.hpp"
@@ -205,15 +206,21 @@ int main()
         renderer.m_device->CreateComputePipelineState(&gpu_culling_compute_pso_desc, IID_PPV_ARGS(&gpu_culling_pso)));
 
     // Indirect command struct : command signature must match this struct.
-    // Each chunk will have its own IndirectCommand, with 3 arguments. The render resources struct root constants, index
-    // buffer view and a draw call.
-    struct IndirectCommand
-    {
-        VoxelRenderResources render_resources{};
-        D3D12_INDEX_BUFFER_VIEW index_buffer_view{};
-        D3D12_DRAW_INDEXED_ARGUMENTS draw_arguments{};
-        float padding;
-    };
+    // Each chunk will have its own indirect command, with 3 arguments. The render resources struct root constants,
+    // index buffer view and a draw call.
+    // The commands are kept by the chunk manager (see ChunkIndirectCommandArray). The culling shader outputs one
+    // command per range of visible face directions of each chunk, i.e upto 3 per chunk, which are merged across the
+    // chunks of region commands when they are adjacent.
+    // The culling arguments at the end of the command (the face direction index counts of chunk commands, or the run of
+    // region commands) are only read by the culling shader.
+    using IndirectCommand = ChunkIndirectCommand;
+    static_assert(sizeof(IndirectCommand) == sizeof(GPUIndirectCommand));
+    static_assert(offsetof(IndirectCommand, index_buffer_view) == sizeof(VoxelRenderResources));
+    static_assert(offsetof(IndirectCommand, index_count_per_instance) ==
+                  sizeof(VoxelRenderResources) + sizeof(D3D12_INDEX_BUFFER_VIEW));
+    static_assert(sizeof(IndirectCommand) - offsetof(IndirectCommand, index_count_per_instance) ==
+                  sizeof(D3D12_DRAW_INDEXED_ARGUMENTS) + sizeof(u32) +
+                      sizeof(IndirectCommand::face_direction_index_counts));
 
     printf("Size of indirect command : %zd\n", sizeof(IndirectCommand));
 
@@ -249,7 +256,6 @@ int main()
 
     // Command buffer that will be used to store the indirect command args.
     static constexpr size_t MAX_CHUNKS_TO_BE_DRAWN = 10'00'000;
-    std::vector<IndirectCommand> indirect_command_vector{};
 
     CommandBuffer indirect_command_buffer =
         renderer.create_command_buffer(sizeof(IndirectCommand), MAX_CHUNKS_TO_BE_DRAWN, L"Indirect Command Buffer");
@@ -278,45 +284,42 @@ int main()
     renderer.m_direct_queue.execute_command_list();
     renderer.m_direct_queue.flush_queue();
 
-    // Precompute the offset to a chunk index X, using which we can load chunks within the CHUNK_RENDER_DISTANCE volume
-    // around the player at any given moment.
-    // For precomputation, X is assumed to be zero. These values will be added to the current chunk index.
-    // NOTE : The current player chunk is loaded first, then the chunks 1 distance away, then 2 distance away, etc.
-    // note(rtarun9) : Make this more efficient?
-    std::vector<DirectX::XMINT3> chunk_render_distance_offsets = {};
-    chunk_render_distance_offsets.push_back(DirectX::XMINT3{0, 0, 0});
-
-    for (i32 z = -1 * ChunkManager::CHUNK_RENDER_DISTANCE; z <= (i32)ChunkManager::CHUNK_RENDER_DISTANCE; z++)
-    {
-        for (i32 y = -ChunkManager::CHUNK_RENDER_DISTANCE; y <= (i32)ChunkManager::CHUNK_RENDER_DISTANCE; y++)
-        {
-            for (i32 x = -ChunkManager::CHUNK_RENDER_DISTANCE; x <= (i32)ChunkManager::CHUNK_RENDER_DISTANCE; x++)
-            {
-                if ((z == -ChunkManager::CHUNK_RENDER_DISTANCE || z == ChunkManager::CHUNK_RENDER_DISTANCE) ||
-                    (y == -ChunkManager::CHUNK_RENDER_DISTANCE || y == ChunkManager::CHUNK_RENDER_DISTANCE) ||
-                    (x == -ChunkManager::CHUNK_RENDER_DISTANCE || x == ChunkManager::CHUNK_RENDER_DISTANCE))
-                {
-                    chunk_render_distance_offsets.emplace_back(DirectX::XMINT3{x, y, z});
-                }
-            }
-        }
-    }
-    std::sort(chunk_render_distance_offsets.begin(), chunk_render_distance_offsets.end(),
-              [](const DirectX::XMINT3 &a, const DirectX::XMINT3 &b) {
-                  return a.x * a.x + a.y * a.y + a.z * a.z < b.x * b.x + b.y * b.y + b.z * b.z;
-              });
-
     Camera camera{};
     const u64 chunk_grid_middle = Chunk::CHUNK_LENGTH * ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION / 2u;
     camera.m_position = {chunk_grid_middle, chunk_grid_middle, chunk_grid_middle, 1.0f};
 
-    std::queue<u64> chunks_to_unload{};
-
     Timer timer{};
     float delta_time = 0.0f;
 
     bool setup_chunks{false};
 
+    // When enabled, chunks outside of the view frustum (or hidden behind full chunks, or not reachable through empty
+    // space from the chunk the camera is in) are culled on the CPU before upload, so the culling shader only sees the
+    // visible commands.
+    bool cpu_frustum_culling{false};
+    bool cpu_occlusion_culling{false};
+
+    // Frustum culling walks the chunk octree rather than testing every command, when CPU frustum culling is enabled.
+    // Off by default, as at the current render distance testing every command is faster.
+    bool hierarchical_frustum_culling{false};
+    bool cave_culling{false};
+
+    // When enabled, the loaded chunks of each region are drawn with a few commands (see ChunkRegions) rather than one
+    // command per chunk. The culling shader still culls the chunks (and face directions) of region commands one by one,
+    // and CPU culling splits the runs of region commands around the chunks it culls.
+    // Off by default until the region command path of the culling shader has been validated on a GPU.
+    bool region_batching{false};
+
+    // Commands whose persistent copy is in the upload buffer, if any. It is overwritten by CPU culling, and has to be
+    // uploaded again in full when switching between chunk and region commands.
+    const ChunkIndirectCommandArray *uploaded_indirect_commands{};
+    std::vector<u32> visible_chunk_indices{};
+
+    // Chunk commands that are inside of the frustum, when the chunks of region commands are culled with the chunk
+    // octree.
+    std::vector<u32> visible_chunk_command_indices{};
+    std::vector<bool> is_chunk_command_visible{};
+
     u64 frame_count = 0;
 
     bool quit{false};
@@ -334,26 +337,32 @@ int main()
         };
 
         const u64 current_chunk_index =
-            convert_to_1d(current_chunk_3d_index, ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION);
+            convert_to_1d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(current_chunk_3d_index);
 
         if (setup_chunks)
         {
             // Load chunks around the player (ChunkManager::CHUNK_RENDER_DISTANCE) determines how many of these
-            // chunks to load.
-            for (const auto &offset : chunk_render_distance_offsets)
-            {
-                const DirectX::XMUINT3 chunk_3d_index = {
-                    current_chunk_3d_index.x + offset.x,
-                    current_chunk_3d_index.y + offset.y,
-                    current_chunk_3d_index.z + offset.z,
-                };
-
-                chunk_manager.add_chunk_to_setup_stack(
-                    convert_to_1d(chunk_3d_index, ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION));
-            }
+            // chunks to load. Chunks are only added when the player enters another chunk.
+            chunk_manager.add_chunks_around_player_to_setup_queue(current_chunk_3d_index);
+        }
+        else
+        {
+            // Chunks may have been unloaded in the meantime, so every chunk around the player is added once loading
+            // resumes.
+            chunk_manager.m_player_chunk_index_3d.reset();
         }
 
-        chunk_manager.create_chunks_from_setup_stack(renderer);
+        // Chunks that are in view are setup first (see ChunkLoadScheduler).
+        chunk_manager.set_view(ChunkLoadScheduler::View::create(
+            {
+                camera.m_position.x / Chunk::CHUNK_LENGTH,
+                camera.m_position.y / Chunk::CHUNK_LENGTH,
+                camera.m_position.z / Chunk::CHUNK_LENGTH,
+            },
+            {camera.m_front.x, camera.m_front.y, camera.m_front.z}, DirectX::XMConvertToRadians(45.0f),
+            static_cast<float>(window.get_width()) / window.get_height()));
+
+        chunk_manager.create_chunks_from_setup_queue(renderer);
 
         timer.start();
 
@@ -369,7 +378,11 @@ int main()
             quit = true;
         }
 
-        chunk_manager.transfer_chunks_from_setup_to_loaded_state(renderer.m_copy_queue.m_fence->GetCompletedValue());
+        chunk_manager.transfer_chunks_from_setup_to_loaded_state(renderer,
+                                                                 renderer.m_copy_queue.m_fence->GetCompletedValue(),
+                                                                 renderer.m_direct_queue.m_monotonic_fence_value);
+        chunk_manager.release_retired_chunk_buffers(renderer.m_copy_queue.m_fence->GetCompletedValue(),
+                                                    renderer.m_direct_queue.m_fence->GetCompletedValue());
 
         const float window_aspect_ratio = static_cast<float>(window.get_width()) / window.get_height();
 
@@ -391,7 +404,9 @@ int main()
         const DirectX::XMMATRIX projection_matrix = DirectX::XMMatrixSet(
             width, 0.0f, 0.0f, 0.0f, 0.0f, height, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, near_plane, 0.0f);
 
-        scene_buffer_data.view_matrix = camera.update_and_get_view_matrix(delta_time);
+        const DirectX::XMMATRIX view_matrix = camera.update_and_get_view_matrix(delta_time);
+
+        scene_buffer_data.view_matrix = view_matrix;
         scene_buffer_data.projection_matrix = projection_matrix;
         scene_buffer_data.camera_position = camera.m_position;
 
@@ -433,66 +448,160 @@ int main()
         command_list->RSSetViewports(1u, &viewport);
         command_list->RSSetScissorRects(1u, &scissor_rect);
 
-        // Evict the chunks that are out of range of render distance.
-        // Because evicting chunks seems to have such a high overhead (more specifically freeing allocated id3d12
-        // resources) each frame only a certain number of chunks are unloaded.
-        for (const auto &[i, chunk] : chunk_manager.m_loaded_chunks)
+        // Evict the chunks that are out of unload distance (or over the memory budget). Their buffers are released a
+        // few at a time once the GPU is done with them, as freeing D3D12 resources has a high overhead.
+        chunk_manager.evict_chunks(renderer.m_direct_queue.m_monotonic_fence_value);
+
+        // Only chunks with a non empty mesh have an indirect command. The commands live in the upload buffer from one
+        // frame to the next, so only the ones that were added (or moved by a removal) since the last frame are copied.
+        // With CPU frustum (occlusion, or cave) culling, the visible commands are compacted into the upload buffer
+        // every frame instead, which overwrites the persistent copy : it is then uploaded again in full once CPU
+        // culling is disabled.
+        ChunkIndirectCommandArray &chunk_indirect_commands =
+            region_batching ? chunk_manager.m_chunk_regions.m_region_indirect_commands
+                            : chunk_manager.m_chunk_indirect_commands;
+
+        DirectX::XMFLOAT4X4 view_projection_matrix{};
+        DirectX::XMStoreFloat4x4(&view_projection_matrix, DirectX::XMMatrixMultiply(view_matrix, projection_matrix));
+
+        const DirectX::XMFLOAT3 camera_position = {camera.m_position.x, camera.m_position.y, camera.m_position.z};
+
+        // Occlusion culling runs on the worker threads, and its result is used from the next frame on.
+        if (cpu_occlusion_culling)
         {
-            const DirectX::XMUINT3 chunk_index_3d = convert_to_3d(i, ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION);
-            if (std::abs((i32)chunk_index_3d.x - (i32)current_chunk_3d_index.x) >
-                    ChunkManager::CHUNK_RENDER_DISTANCE * 8 ||
-                std::abs((i32)chunk_index_3d.y - (i32)current_chunk_3d_index.y) >
-                    ChunkManager::CHUNK_RENDER_DISTANCE * 8 ||
-                std::abs((i32)chunk_index_3d.z - (i32)current_chunk_3d_index.z) >
-                    ChunkManager::CHUNK_RENDER_DISTANCE * 8)
-            {
-                chunks_to_unload.push(i);
-            }
+            chunk_manager.update_occlusion_culling(view_projection_matrix, camera_position, near_plane);
         }
 
-        /*
-        size_t unloaded_chunks = 0;
-        while (false && !chunks_to_unload.empty() && unloaded_chunks < ChunkManager::CHUNKS_TO_UNLOAD_PER_FRAME)
+        // The potentially visible chunks are only searched again when the camera enters another chunk, or the loaded
+        // chunks change.
+        if (cave_culling)
         {
-            const auto chunk_to_unload = chunks_to_unload.front();
-            chunks_to_unload.pop();
+            chunk_manager.update_cave_culling(current_chunk_3d_index);
+        }
 
-            chunk_manager.m_loaded_chunks.erase(chunk_to_unload);
+        size_t number_of_indirect_commands = chunk_indirect_commands.size();
+        size_t number_of_occluded_chunks = 0u;
+        size_t number_of_cave_culled_chunks = 0u;
+        if (cpu_frustum_culling || cpu_occlusion_culling || cave_culling)
+        {
+            visible_chunk_indices.resize(chunk_indirect_commands.size());
+            std::iota(visible_chunk_indices.begin(), visible_chunk_indices.end(), 0u);
 
-            chunk_manager.m_chunk_index_buffers.erase(chunk_to_unload);
-            chunk_manager.m_chunk_index_buffers[chunk_to_unload].resource.Reset();
+            // The chunk octree culls chunks rather than regions : with region commands, the runs of every region
+            // command are split around the chunks that are outside of the frustum instead.
+            const bool is_frustum_culling_per_region_chunk =
+                cpu_frustum_culling && hierarchical_frustum_culling && region_batching;
 
-            chunk_manager.m_chunk_color_buffers.erase(chunk_to_unload);
-            chunk_manager.m_chunk_color_buffers[chunk_to_unload].resource.Reset();
+            size_t number_of_visible_chunks = chunk_indirect_commands.size();
+            if (cpu_frustum_culling)
+            {
+                const FrustumCulling::Frustum frustum =
+                    FrustumCulling::create_frustum(view_projection_matrix, camera_position);
 
-            chunk_manager.m_chunk_constant_buffers[chunk_to_unload].resource.Reset();
-            chunk_manager.m_chunk_constant_buffers.erase(chunk_to_unload);
+                if (is_frustum_culling_per_region_chunk)
+                {
+                    const size_t number_of_chunk_commands = chunk_manager.m_chunk_indirect_commands.size();
+                    visible_chunk_command_indices.resize(number_of_chunk_commands);
+                    const size_t number_of_visible_chunk_commands =
+                        chunk_manager.cull_chunks_hierarchical(frustum, visible_chunk_command_indices.data());
 
-            ++unloaded_chunks;
-        }
-        */
+                    is_chunk_command_visible.assign(number_of_chunk_commands, false);
+                    for (size_t i = 0u; i < number_of_visible_chunk_commands; i++)
+                    {
+                        is_chunk_command_visible[visible_chunk_command_indices[i]] = true;
+                    }
+                }
+                else if (hierarchical_frustum_culling)
+                {
+                    number_of_visible_chunks =
+                        chunk_manager.cull_chunks_hierarchical(frustum, visible_chunk_indices.data());
+                }
+                else
+                {
+                    // The bounds of region commands are the bounds of their region.
+                    const float command_length =
+                        static_cast<float>(region_batching ? Chunk::CHUNK_LENGTH *
+                                                                 ChunkRegions::NUMBER_OF_CHUNKS_PER_REGION_DIMENSION
+                                                           : Chunk::CHUNK_LENGTH);
+
+                    number_of_visible_chunks = FrustumCulling::cull_chunks(
+                        frustum, command_length, chunk_indirect_commands.m_bounds_min_x.data(),
+                        chunk_indirect_commands.m_bounds_min_y.data(), chunk_indirect_commands.m_bounds_min_z.data(),
+                        chunk_indirect_commands.size(), visible_chunk_indices.data());
+                }
+            }
 
-        // Setup indirect command vector.
-        indirect_command_vector.clear();
-        indirect_command_vector.reserve(chunk_manager.m_loaded_chunks.size());
-        for (const auto &[i, chunk] : chunk_manager.m_loaded_chunks)
-        {
-            const VoxelRenderResources render_resources = {
-                .scene_constant_buffer_index = static_cast<u32>(scene_buffer.cbv_index),
-                .chunk_constant_buffer_index = static_cast<u32>(chunk_manager.m_chunk_constant_buffers[i].cbv_index),
+            const auto is_chunk_visible = [&](const size_t chunk_index) {
+                if (cave_culling && !chunk_manager.is_chunk_potentially_visible(chunk_index))
+                {
+                    ++number_of_cave_culled_chunks;
+                    return false;
+                }
+
+                if (cpu_occlusion_culling && chunk_manager.m_occlusion_culler.is_chunk_occluded(chunk_index))
+                {
+                    ++number_of_occluded_chunks;
+                    return false;
+                }
+
+                return true;
+            };
+
+            const auto upload_indirect_command = [&](const IndirectCommand &indirect_command) {
+                memcpy(indirect_command_buffer.upload_resource_mapped_ptr +
+                           number_of_indirect_commands * sizeof(IndirectCommand),
+                       &indirect_command, sizeof(IndirectCommand));
+                ++number_of_indirect_commands;
             };
 
-            indirect_command_vector.emplace_back(IndirectCommand{
-                .render_resources = render_resources,
-                .index_buffer_view = chunk_manager.m_chunk_index_buffers[i].index_buffer_view,
-                .draw_arguments =
-                    D3D12_DRAW_INDEXED_ARGUMENTS{
-                        .IndexCountPerInstance = (u32)chunk_manager.m_chunk_index_buffers[i].indices_count,
-                        .InstanceCount = 1u,
-                        .StartIndexLocation = 0u,
-                        .BaseVertexLocation = 0u,
-                        .StartInstanceLocation = 0u,
+            number_of_indirect_commands = 0u;
+            for (size_t i = 0u; i < number_of_visible_chunks; i++)
+            {
+                const u32 command_index = visible_chunk_indices[i];
+                if (!region_batching)
+                {
+                    if (is_chunk_visible(chunk_indirect_commands.m_owners[command_index]))
+                    {
+                        upload_indirect_command(chunk_indirect_commands.m_commands[command_index]);
+                    }
+
+                    continue;
+                }
+
+                // The owner of a region command is its region.
+                chunk_manager.m_chunk_regions.for_each_visible_run(
+                    chunk_indirect_commands.m_owners[command_index],
+                    chunk_indirect_commands.m_commands[command_index],
+                    [&](const DirectX::XMUINT3 chunk_index_3d) {
+                        const size_t chunk_index =
+                            convert_to_1d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index_3d);
+                        if (is_frustum_culling_per_region_chunk &&
+                            !is_chunk_command_visible[chunk_manager.m_loaded_chunks.find(chunk_index)
+                                                          ->m_indirect_command_handle])
+                        {
+                            return false;
+                        }
+
+                        return is_chunk_visible(chunk_index);
                     },
+                    upload_indirect_command);
+            }
+
+            uploaded_indirect_commands = nullptr;
+        }
+        else
+        {
+            if (uploaded_indirect_commands != &chunk_indirect_commands)
+            {
+                chunk_indirect_commands.mark_all_dirty();
+                uploaded_indirect_commands = &chunk_indirect_commands;
+            }
+
+            chunk_indirect_commands.upload_dirty_ranges([&](const u32 first_command_index, const u32 number_of_commands,
+                                                            const IndirectCommand *const commands) {
+                u8 *const destination =
+                    indirect_command_buffer.upload_resource_mapped_ptr + first_command_index * sizeof(IndirectCommand);
+                memcpy(destination, commands, number_of_commands * sizeof(IndirectCommand));
             });
         }
 
@@ -506,7 +615,7 @@ int main()
         command_list->OMSetRenderTargets(1u, &rtv_handle, FALSE, &dsv_handle);
 
         // Run the culling compute shader, followed by voxel rendering shader.
-        if (!indirect_command_vector.empty())
+        if (number_of_indirect_commands != 0u)
         {
             const D3D12_RESOURCE_BARRIER indirect_argument_to_copy_dest_state = {
                 .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
@@ -521,11 +630,8 @@ int main()
             };
             command_list->ResourceBarrier(1u, &indirect_argument_to_copy_dest_state);
 
-            memcpy(indirect_command_buffer.upload_resource_mapped_ptr, indirect_command_vector.data(),
-                   indirect_command_vector.size() * sizeof(IndirectCommand));
-
             GPUCullRenderResources gpu_cull_render_resources = {
-                .number_of_chunks = static_cast<u32>(indirect_command_vector.size()),
+                .number_of_chunks = static_cast<u32>(number_of_indirect_commands),
                 .indirect_command_srv_index = static_cast<u32>(indirect_command_buffer.upload_resource_srv_index),
                 .output_command_uav_index = static_cast<u32>(indirect_command_buffer.default_resource_uav_index),
                 .scene_constant_buffer_index = static_cast<u32>(scene_buffer.cbv_index),
@@ -558,7 +664,7 @@ int main()
 
             command_list->ResourceBarrier(1u, &copy_dest_to_unordered_access_state);
 
-            command_list->Dispatch((indirect_command_vector.size() + 31) / 32u, 1u, 1u);
+            command_list->Dispatch((number_of_indirect_commands + 31) / 32u, 1u, 1u);
 
             const D3D12_RESOURCE_BARRIER unordered_access_to_indirect_argument_state = {
                 .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
@@ -600,6 +706,30 @@ int main()
         ImGui::SliderFloat("near plane", &near_plane, 0.1f, 1.0f);
         ImGui::SliderFloat("Far plane", &far_plane, 10.0f, 10000000.0f);
         ImGui::Checkbox("Start loading chunks", &setup_chunks);
+        ImGui::Checkbox("CPU frustum culling", &cpu_frustum_culling);
+        ImGui::Checkbox("Hierarchical frustum culling", &hierarchical_frustum_culling);
+        ImGui::Checkbox("CPU occlusion culling", &cpu_occlusion_culling);
+        ImGui::Checkbox("Cave culling", &cave_culling);
+        ImGui::Checkbox("Region batching", &region_batching);
+
+        static constexpr std::array<const char *, 2u> meshing_mode_names = {"Naive", "Binary Greedy"};
+
+        int meshing_mode = static_cast<int>(chunk_manager.m_meshing_mode);
+        if (ImGui::Combo("Meshing mode", &meshing_mode, meshing_mode_names.data(),
+                         static_cast<int>(meshing_mode_names.size())))
+        {
+            chunk_manager.m_meshing_mode = static_cast<MeshingMode>(meshing_mode);
+        }
+
+        static constexpr std::array<const char *, 2u> terrain_preset_names = {"Heightmap", "Density"};
+
+        int terrain_preset = static_cast<int>(chunk_manager.m_terrain_preset);
+        if (ImGui::Combo("Terrain preset", &terrain_preset, terrain_preset_names.data(),
+                         static_cast<int>(terrain_preset_names.size())))
+        {
+            chunk_manager.m_terrain_preset = static_cast<TerrainPreset>(terrain_preset);
+        }
+
         ImGui::Text("Delta Time: %f", delta_time);
         ImGui::Text("Camera Position : %f %f %f", camera.m_position.x, camera.m_position.y, camera.m_position.z);
         ImGui::Text("Pitch and Yaw: %f %f", camera.m_pitch, camera.m_yaw);
@@ -607,12 +737,90 @@ int main()
         ImGui::Text("Current 3D Index: %zu, %zu, %zu", current_chunk_3d_index.x, current_chunk_3d_index.y,
                     current_chunk_3d_index.z);
         ImGui::Text("Number of loaded chunks: %zu", chunk_manager.m_loaded_chunks.size());
-        ImGui::Text("Number of rendered chunks: %zu", indirect_command_vector.size());
+        {
+            const auto &occupancy_state_counts = chunk_manager.m_number_of_loaded_chunks_per_occupancy_state;
+            ImGui::Text("Loaded chunks : %llu empty, %llu full, %llu mixed",
+                        occupancy_state_counts[static_cast<u32>(OccupancyState::Empty)],
+                        occupancy_state_counts[static_cast<u32>(OccupancyState::Full)],
+                        occupancy_state_counts[static_cast<u32>(OccupancyState::Mixed)]);
+        }
+        ImGui::Text("Loaded voxel data : %f KB",
+                    static_cast<float>(chunk_manager.m_loaded_voxel_data_size_in_bytes) / 1024.0f);
+        {
+            const BlockPool::Statistics voxel_data_pool_statistics = Chunk::get_voxel_data_pool_statistics();
+            ImGui::Text("Voxel data pools : %llu blocks in use (peak %llu), %f MB reserved in %llu pages",
+                        voxel_data_pool_statistics.m_number_of_blocks_in_use,
+                        voxel_data_pool_statistics.m_peak_number_of_blocks_in_use,
+                        static_cast<float>(voxel_data_pool_statistics.m_reserved_size_in_bytes) / (1024.0f * 1024.0f),
+                        voxel_data_pool_statistics.m_number_of_page_allocations);
+            ImGui::Text("Scratch mesh allocations : %llu",
+                        chunk_manager.m_number_of_scratch_mesh_allocations.load());
+        }
+        ImGui::Text("Number of rendered chunks: %zu", chunk_manager.m_chunk_indirect_commands.size());
+        ImGui::Text("Number of regions: %zu (%llu pages, %f MB, %zu region commands)",
+                    chunk_manager.m_chunk_regions.m_regions.size(), chunk_manager.m_chunk_regions.m_number_of_pages,
+                    static_cast<float>(chunk_manager.m_chunk_regions.m_pages_size_in_bytes) / (1024.0f * 1024.0f),
+                    chunk_manager.m_chunk_regions.m_region_indirect_commands.size());
+        ImGui::Text("Number of chunk octree nodes: %zu", chunk_manager.m_chunk_octree.get_number_of_nodes());
+        ImGui::Text("Number of chunks after CPU frustum culling: %zu", number_of_indirect_commands);
+        ImGui::Text("Number of occluded chunks: %zu (%zu occluders, %f us)", number_of_occluded_chunks,
+                    chunk_manager.m_occlusion_culler.m_completed_frame.m_occluder_chunk_mins.size(),
+                    chunk_manager.m_occlusion_culler.m_completed_frame.m_culling_time_us);
+        ImGui::Text("Number of cave culled chunks: %zu (%zu potentially visible, %f us / search)",
+                    number_of_cave_culled_chunks,
+                    chunk_manager.m_potentially_visible_chunks.m_number_of_visible_chunks,
+                    chunk_manager.m_potentially_visible_chunks.m_search_time_us);
+        ImGui::Text("Number of loaded triangles: %llu", chunk_manager.m_number_of_loaded_triangles);
+        ImGui::Text("Number of level of detail re-meshes: %llu", chunk_manager.m_number_of_lod_remeshes);
+        ImGui::Text("Number of chunks to re-mesh: %zu", chunk_manager.m_chunks_to_remesh_queue.size());
+        ImGui::Text("Number of setup chunks waiting to be loaded: %zu", chunk_manager.m_completed_setup_chunks.size());
+        ImGui::Text("Number of cancelled setup chunks: %llu", chunk_manager.m_number_of_cancelled_setup_chunks);
+        ImGui::Text("Memory usage: %llu / %llu MiB (%llu KiB of mesh upload pool)",
+                    chunk_manager.get_memory_usage_in_bytes() / (1024u * 1024u),
+                    chunk_manager.m_memory_budget_in_bytes / (1024u * 1024u),
+                    chunk_manager.m_mesh_upload_pool.get_statistics().m_reserved_size_in_bytes / 1024u);
+        for (size_t i = 0; i < meshing_mode_names.size(); i++)
+        {
+            const auto &meshing_statistics = chunk_manager.m_meshing_statistics[i];
+            if (meshing_statistics.m_number_of_chunks_meshed == 0u)
+            {
+                continue;
+            }
+
+            const float number_of_chunks_meshed = static_cast<float>(meshing_statistics.m_number_of_chunks_meshed);
+            ImGui::Text("%s mesher : %f us / chunk, %f triangles / chunk", meshing_mode_names[i],
+                        meshing_statistics.m_total_meshing_time_us / number_of_chunks_meshed,
+                        meshing_statistics.m_number_of_triangles / number_of_chunks_meshed);
+        }
+        // Generation time is summed over all worker threads, so this is the throughput of a single worker.
+        for (size_t i = 0; i < terrain_preset_names.size(); i++)
+        {
+            const auto &generation_statistics = chunk_manager.m_generation_statistics[i];
+            if (generation_statistics.m_number_of_chunks_generated == 0u)
+            {
+                continue;
+            }
+
+            ImGui::Text("%s generation (%s) : %f us / chunk, %f million voxels / sec / thread", terrain_preset_names[i],
+                        Noise::get_simd_instruction_set_name(),
+                        generation_statistics.m_total_generation_time_us /
+                            static_cast<float>(generation_statistics.m_number_of_chunks_generated),
+                        static_cast<float>(generation_statistics.m_number_of_voxels_generated) /
+                            generation_statistics.m_total_generation_time_us);
+        }
+        ImGui::Text("Heightmap columns : %zu cached, %llu generated",
+                    chunk_manager.m_heightmap_column_cache.m_entries.size(),
+                    chunk_manager.m_generation_statistics[static_cast<u32>(TerrainPreset::Heightmap)]
+                        .m_number_of_heightmap_columns_generated);
         ImGui::Text("Number of copy alloc / list pairs : %zu",
                     renderer.m_copy_queue.m_command_allocator_list_queue.size());
         ImGui::Text("Voxel edge length : %zu", Voxel::EDGE_LENGTH);
-        ImGui::Text("Number of threads in pool : %zu", chunk_manager.m_thread_pool.get_thread_count());
-        ImGui::Text("Number of queued threads in pool : %zu", chunk_manager.m_thread_pool.get_tasks_queued());
+        ImGui::Text("Chunk dimension : %u (%zu bit indices)", CHUNK_DIMENSION, sizeof(ChunkMesh::Index) * 8u);
+        const JobSystem::Statistics job_system_statistics = chunk_manager.m_job_system.get_statistics();
+        ImGui::Text("Number of worker threads : %u", chunk_manager.m_job_system.get_number_of_worker_threads());
+        ImGui::Text("Number of pending jobs : %llu", chunk_manager.m_job_system.get_number_of_pending_jobs());
+        ImGui::Text("Jobs executed : %llu (%llu stolen)", job_system_statistics.m_number_of_jobs_executed,
+                    job_system_statistics.m_number_of_jobs_stolen);
 
         ImGui::ShowMetricsWindow();
         ImGui::End();
@@ -0,0 +1,476 @@
+#include "voxel-engine/noise.hpp"
+
+#include <immintrin.h>
+
+namespace Noise
+{
+// Primes used to hash the integer lattice coordinates.
+static constexpr u32 PRIME_X = 501125321u;
+static constexpr u32 PRIME_Y = 1136930381u;
+static constexpr u32 PRIME_Z = 1720413743u;
+static constexpr u32 HASH_MULTIPLIER = 0x27d4eb2du;
+
+// The noise function is written once, in terms of the operations of a 'lane' type below. Each lane type wraps a
+// instruction set, where F is a vector of floats and I is a vector of 32 bit integers with the same number of elements.
+struct ScalarLanes
+{
+    using F = float;
+    using I = u32;
+
+    static constexpr size_t WIDTH = 1u;
+
+    static inline F set(const float a)
+    {
+        return a;
+    }
+    static inline I set_i(const u32 a)
+    {
+        return a;
+    }
+    static inline F ramp(const float start, [[maybe_unused]] const float step)
+    {
+        return start;
+    }
+    static inline F floor(const F a)
+    {
+        return std::floor(a);
+    }
+    static inline I to_int(const F a)
+    {
+        return static_cast<u32>(static_cast<i32>(a));
+    }
+    static inline F add(const F a, const F b)
+    {
+        return a + b;
+    }
+    static inline F sub(const F a, const F b)
+    {
+        return a - b;
+    }
+    static inline F mul(const F a, const F b)
+    {
+        return a * b;
+    }
+    static inline I add_i(const I a, const I b)
+    {
+        return a + b;
+    }
+    static inline I mul_i(const I a, const I b)
+    {
+        return a * b;
+    }
+    static inline I xor_i(const I a, const I b)
+    {
+        return a ^ b;
+    }
+    static inline I and_i(const I a, const I b)
+    {
+        return a & b;
+    }
+    static inline I or_i(const I a, const I b)
+    {
+        return a | b;
+    }
+    static inline I srl_i(const I a, const int shift)
+    {
+        return a >> shift;
+    }
+    static inline I sll_i(const I a, const int shift)
+    {
+        return a << shift;
+    }
+    static inline I less_than_i(const I a, const I b)
+    {
+        return static_cast<i32>(a) < static_cast<i32>(b) ? ~0u : 0u;
+    }
+    static inline I equal_i(const I a, const I b)
+    {
+        return a == b ? ~0u : 0u;
+    }
+    static inline F select(const I mask, const F a, const F b)
+    {
+        return mask ? a : b;
+    }
+    static inline F xor_sign(const F a, const I sign)
+    {
+        return std::bit_cast<float>(std::bit_cast<u32>(a) ^ sign);
+    }
+    static inline void store(float *const output, const F a)
+    {
+        *output = a;
+    }
+};
+
+#if defined(__AVX2__)
+struct Avx2Lanes
+{
+    using F = __m256;
+    using I = __m256i;
+
+    static constexpr size_t WIDTH = 8u;
+
+    static inline F set(const float a)
+    {
+        return _mm256_set1_ps(a);
+    }
+    static inline I set_i(const u32 a)
+    {
+        return _mm256_set1_epi32(static_cast<i32>(a));
+    }
+    static inline F ramp(const float start, const float step)
+    {
+        return _mm256_add_ps(_mm256_set1_ps(start),
+                             _mm256_mul_ps(_mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f),
+                                           _mm256_set1_ps(step)));
+    }
+    static inline F floor(const F a)
+    {
+        return _mm256_floor_ps(a);
+    }
+    static inline I to_int(const F a)
+    {
+        return _mm256_cvttps_epi32(a);
+    }
+    static inline F add(const F a, const F b)
+    {
+        return _mm256_add_ps(a, b);
+    }
+    static inline F sub(const F a, const F b)
+    {
+        return _mm256_sub_ps(a, b);
+    }
+    static inline F mul(const F a, const F b)
+    {
+        return _mm256_mul_ps(a, b);
+    }
+    static inline I add_i(const I a, const I b)
+    {
+        return _mm256_add_epi32(a, b);
+    }
+    static inline I mul_i(const I a, const I b)
+    {
+        return _mm256_mullo_epi32(a, b);
+    }
+    static inline I xor_i(const I a, const I b)
+    {
+        return _mm256_xor_si256(a, b);
+    }
+    static inline I and_i(const I a, const I b)
+    {
+        return _mm256_and_si256(a, b);
+    }
+    static inline I or_i(const I a, const I b)
+    {
+        return _mm256_or_si256(a, b);
+    }
+    static inline I srl_i(const I a, const int shift)
+    {
+        return _mm256_srli_epi32(a, shift);
+    }
+    static inline I sll_i(const I a, const int shift)
+    {
+        return _mm256_slli_epi32(a, shift);
+    }
+    static inline I less_than_i(const I a, const I b)
+    {
+        return _mm256_cmpgt_epi32(b, a);
+    }
+    static inline I equal_i(const I a, const I b)
+    {
+        return _mm256_cmpeq_epi32(a, b);
+    }
+    static inline F select(const I mask, const F a, const F b)
+    {
+        return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask));
+    }
+    static inline F xor_sign(const F a, const I sign)
+    {
+        return _mm256_xor_ps(a, _mm256_castsi256_ps(sign));
+    }
+    static inline void store(float *const output, const F a)
+    {
+        _mm256_storeu_ps(output, a);
+    }
+};
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+struct Sse2Lanes
+{
+    using F = __m128;
+    using I = __m128i;
+
+    static constexpr size_t WIDTH = 4u;
+
+    static inline F set(const float a)
+    {
+        return _mm_set1_ps(a);
+    }
+    static inline I set_i(const u32 a)
+    {
+        return _mm_set1_epi32(static_cast<i32>(a));
+    }
+    static inline F ramp(const float start, const float step)
+    {
+        return _mm_add_ps(_mm_set1_ps(start), _mm_mul_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), _mm_set1_ps(step)));
+    }
+
+    // SSE2 has no floor instruction : truncate, and subtract one where truncation rounded up (negative values).
+    static inline F floor(const F a)
+    {
+        const F truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a));
+        return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, a), _mm_set1_ps(1.0f)));
+    }
+    static inline I to_int(const F a)
+    {
+        return _mm_cvttps_epi32(a);
+    }
+    static inline F add(const F a, const F b)
+    {
+        return _mm_add_ps(a, b);
+    }
+    static inline F sub(const F a, const F b)
+    {
+        return _mm_sub_ps(a, b);
+    }
+    static inline F mul(const F a, const F b)
+    {
+        return _mm_mul_ps(a, b);
+    }
+    static inline I add_i(const I a, const I b)
+    {
+        return _mm_add_epi32(a, b);
+    }
+
+    // SSE2 has no 32 bit multiply (_mm_mullo_epi32 is SSE4.1), so it is emulated using two 32 x 32 -> 64 bit
+    // multiplies of the even and odd elements.
+    static inline I mul_i(const I a, const I b)
+    {
+        const I even = _mm_mul_epu32(a, b);
+        const I odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+        return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                  _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+    }
+    static inline I xor_i(const I a, const I b)
+    {
+        return _mm_xor_si128(a, b);
+    }
+    static inline I and_i(const I a, const I b)
+    {
+        return _mm_and_si128(a, b);
+    }
+    static inline I or_i(const I a, const I b)
+    {
+        return _mm_or_si128(a, b);
+    }
+    static inline I srl_i(const I a, const int shift)
+    {
+        return _mm_srli_epi32(a, shift);
+    }
+    static inline I sll_i(const I a, const int shift)
+    {
+        return _mm_slli_epi32(a, shift);
+    }
+    static inline I less_than_i(const I a, const I b)
+    {
+        return _mm_cmplt_epi32(a, b);
+    }
+    static inline I equal_i(const I a, const I b)
+    {
+        return _mm_cmpeq_epi32(a, b);
+    }
+    static inline F select(const I mask, const F a, const F b)
+    {
+        const F mask_f = _mm_castsi128_ps(mask);
+        return _mm_or_ps(_mm_and_ps(mask_f, a), _mm_andnot_ps(mask_f, b));
+    }
+    static inline F xor_sign(const F a, const I sign)
+    {
+        return _mm_xor_ps(a, _mm_castsi128_ps(sign));
+    }
+    static inline void store(float *const output, const F a)
+    {
+        _mm_storeu_ps(output, a);
+    }
+};
+#endif
+
+template <typename L>
+static inline typename L::I hash(const typename L::I seed, const typename L::I x_primed, const typename L::I y_primed,
+                                 const typename L::I z_primed)
+{
+    typename L::I result = L::xor_i(L::xor_i(seed, x_primed), L::xor_i(y_primed, z_primed));
+    result = L::mul_i(result, L::set_i(HASH_MULTIPLIER));
+    return L::xor_i(result, L::srl_i(result, 15));
+}
+
+// Dot product of the gradient selected by the hash with (x, y, z). The 12 gradients are the edge midpoints of a cube,
+// with 4 of them repeated so that the lower 4 bits of the hash can be used directly (as in improved perlin noise).
+template <typename L>
+static inline typename L::F gradient(const typename L::I hash, const typename L::F x, const typename L::F y,
+                                     const typename L::F z)
+{
+    const typename L::I h = L::and_i(hash, L::set_i(15u));
+
+    const typename L::F u = L::select(L::less_than_i(h, L::set_i(8u)), x, y);
+    const typename L::F v = L::select(L::less_than_i(h, L::set_i(4u)), y,
+                                      L::select(L::equal_i(L::or_i(h, L::set_i(2u)), L::set_i(14u)), x, z));
+
+    // Bit 0 and 1 of the hash decide the signs of u and v.
+    const typename L::F signed_u = L::xor_sign(u, L::sll_i(L::and_i(h, L::set_i(1u)), 31));
+    const typename L::F signed_v = L::xor_sign(v, L::sll_i(L::and_i(h, L::set_i(2u)), 30));
+
+    return L::add(signed_u, signed_v);
+}
+
+template <typename L>
+static inline typename L::F fade(const typename L::F t)
+{
+    // 6t^5 - 15t^4 + 10t^3.
+    const typename L::F t_cubed = L::mul(L::mul(t, t), t);
+    return L::mul(t_cubed, L::add(L::mul(t, L::sub(L::mul(t, L::set(6.0f)), L::set(15.0f))), L::set(10.0f)));
+}
+
+template <typename L>
+static inline typename L::F lerp(const typename L::F a, const typename L::F b, const typename L::F t)
+{
+    return L::add(a, L::mul(t, L::sub(b, a)));
+}
+
+template <typename L>
+static inline typename L::F gradient_noise_3d(const typename L::F x, const typename L::F y, const typename L::F z,
+                                              const u32 seed)
+{
+    using F = typename L::F;
+    using I = typename L::I;
+
+    const F x_floor = L::floor(x);
+    const F y_floor = L::floor(y);
+    const F z_floor = L::floor(z);
+
+    const F fx = L::sub(x, x_floor);
+    const F fy = L::sub(y, y_floor);
+    const F fz = L::sub(z, z_floor);
+
+    const F fx1 = L::sub(fx, L::set(1.0f));
+    const F fy1 = L::sub(fy, L::set(1.0f));
+    const F fz1 = L::sub(fz, L::set(1.0f));
+
+    const I x0 = L::mul_i(L::to_int(x_floor), L::set_i(PRIME_X));
+    const I y0 = L::mul_i(L::to_int(y_floor), L::set_i(PRIME_Y));
+    const I z0 = L::mul_i(L::to_int(z_floor), L::set_i(PRIME_Z));
+
+    const I x1 = L::add_i(x0, L::set_i(PRIME_X));
+    const I y1 = L::add_i(y0, L::set_i(PRIME_Y));
+    const I z1 = L::add_i(z0, L::set_i(PRIME_Z));
+
+    const I s = L::set_i(seed);
+
+    const F u = fade<L>(fx);
+    const F v = fade<L>(fy);
+    const F w = fade<L>(fz);
+
+    const F x00 = lerp<L>(gradient<L>(hash<L>(s, x0, y0, z0), fx, fy, fz),
+                          gradient<L>(hash<L>(s, x1, y0, z0), fx1, fy, fz), u);
+    const F x10 = lerp<L>(gradient<L>(hash<L>(s, x0, y1, z0), fx, fy1, fz),
+                          gradient<L>(hash<L>(s, x1, y1, z0), fx1, fy1, fz), u);
+    const F x01 = lerp<L>(gradient<L>(hash<L>(s, x0, y0, z1), fx, fy, fz1),
+                          gradient<L>(hash<L>(s, x1, y0, z1), fx1, fy, fz1), u);
+    const F x11 = lerp<L>(gradient<L>(hash<L>(s, x0, y1, z1), fx, fy1, fz1),
+                          gradient<L>(hash<L>(s, x1, y1, z1), fx1, fy1, fz1), u);
+
+    return lerp<L>(lerp<L>(x00, x10, v), lerp<L>(x01, x11, v), w);
+}
+
+// Evaluate as many samples as possible (in multiples of the lane width), starting at sample index i.
+template <typename L>
+static inline void gradient_noise_3d_row(const float x, const float x_step, const float y, const float z,
+                                         const u32 seed, const size_t count, float *const output, size_t &i)
+{
+    const typename L::F y_vector = L::set(y);
+    const typename L::F z_vector = L::set(z);
+
+    for (; i + L::WIDTH <= count; i += L::WIDTH)
+    {
+        const typename L::F x_vector = L::ramp(x + x_step * static_cast<float>(i), x_step);
+        L::store(output + i, gradient_noise_3d<L>(x_vector, y_vector, z_vector, seed));
+    }
+}
+
+float gradient_noise_3d(const float x, const float y, const float z, const u32 seed)
+{
+    return gradient_noise_3d<ScalarLanes>(x, y, z, seed);
+}
+
+void gradient_noise_3d_row(const float x, const float x_step, const float y, const float z, const u32 seed,
+                           const size_t count, float *const output)
+{
+    size_t i = 0u;
+
+#if defined(__AVX2__)
+    gradient_noise_3d_row<Avx2Lanes>(x, x_step, y, z, seed, count, output, i);
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    gradient_noise_3d_row<Sse2Lanes>(x, x_step, y, z, seed, count, output, i);
+#endif
+
+    gradient_noise_3d_row<ScalarLanes>(x, x_step, y, z, seed, count, output, i);
+}
+
+void fbm_3d_row(const FbmSettings &fbm_settings, const float x, const float y, const float z, const u32 seed,
+                const size_t count, float *const output)
+{
+    // Octaves are accumulated in batches, so that a fixed size scratch buffer can be used.
+    static constexpr size_t BATCH_SIZE = 64u;
+    std::array<float, BATCH_SIZE> octave{};
+
+    for (size_t batch_start = 0u; batch_start < count; batch_start += BATCH_SIZE)
+    {
+        const size_t batch_count = std::min(BATCH_SIZE, count - batch_start);
+        float *const batch_output = output + batch_start;
+
+        std::fill_n(batch_output, batch_count, 0.0f);
+
+        float frequency = fbm_settings.m_frequency;
+        float amplitude = 1.0f;
+        float amplitude_sum = 0.0f;
+
+        for (u32 i = 0u; i < fbm_settings.m_number_of_octaves; i++)
+        {
+            // Each octave uses a different seed, so that the octaves are not correlated at the lattice points.
+            gradient_noise_3d_row((x + static_cast<float>(batch_start)) * frequency, frequency, y * frequency,
+                                  z * frequency, seed + i, batch_count, octave.data());
+
+            for (size_t j = 0u; j < batch_count; j++)
+            {
+                batch_output[j] += octave[j] * amplitude;
+            }
+
+            amplitude_sum += amplitude;
+            frequency *= fbm_settings.m_lacunarity;
+            amplitude *= fbm_settings.m_gain;
+        }
+
+        if (amplitude_sum > 0.0f)
+        {
+            const float inverse_amplitude_sum = 1.0f / amplitude_sum;
+            for (size_t j = 0u; j < batch_count; j++)
+            {
+                batch_output[j] *= inverse_amplitude_sum;
+            }
+        }
+    }
+}
+
+const char *get_simd_instruction_set_name()
+{
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+} // namespace Noise
@@ -0,0 +1,151 @@
+#include "voxel-engine/null_gpu_backend.hpp"
+
+GpuResource NullGpuBackend::create_resource(const void *data, const size_t size_in_bytes)
+{
+    u8 *const resource = new u8[size_in_bytes];
+    if (data)
+    {
+        memcpy(resource, data, size_in_bytes);
+    }
+
+    {
+        std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+        m_statistics.m_number_of_live_resources++;
+        m_statistics.m_live_resources_size_in_bytes += size_in_bytes;
+    }
+
+    return GpuResource(resource, [this, size_in_bytes](void *const resource) {
+        delete[] static_cast<u8 *>(resource);
+
+        std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+        m_statistics.m_number_of_live_resources--;
+        m_statistics.m_live_resources_size_in_bytes -= size_in_bytes;
+    });
+}
+
+NullGpuBackend::IndexBufferWithIntermediateResource NullGpuBackend::create_index_buffer(
+    const void *data, const size_t stride, const size_t indices_count, const std::wstring_view buffer_name)
+{
+    (void)buffer_name;
+
+    const size_t size_in_bytes = stride * indices_count;
+    GpuResource resource = create_resource(data, size_in_bytes);
+
+    {
+        std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+        m_statistics.m_number_of_index_buffers_created++;
+        m_statistics.m_uploaded_size_in_bytes += data ? size_in_bytes : 0u;
+    }
+
+    // The address of the memory stands in for the GPU virtual address.
+    const IndexBufferView index_buffer_view = {
+        .buffer_location = reinterpret_cast<u64>(resource.get()),
+        .size_in_bytes = static_cast<u32>(size_in_bytes),
+        .format = stride == sizeof(u32) ? INDEX_FORMAT_R32_UINT : INDEX_FORMAT_R16_UINT,
+    };
+
+    return {
+        IndexBuffer{
+            .resource = std::move(resource),
+            .indices_count = indices_count,
+            .index_buffer_view = index_buffer_view,
+        },
+        nullptr,
+    };
+}
+
+NullGpuBackend::StucturedBufferWithIntermediateResource NullGpuBackend::create_structured_buffer(
+    const void *data, const size_t stride, const size_t num_elements, const std::wstring_view buffer_name)
+{
+    (void)buffer_name;
+
+    const size_t size_in_bytes = stride * num_elements;
+    GpuResource resource = create_resource(data, size_in_bytes);
+
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    m_statistics.m_number_of_structured_buffers_created++;
+    m_statistics.m_uploaded_size_in_bytes += data ? size_in_bytes : 0u;
+
+    return {
+        StructuredBuffer{
+            .resource = std::move(resource),
+            .srv_index = m_next_descriptor_index++,
+            .size_in_bytes = size_in_bytes,
+        },
+        nullptr,
+    };
+}
+
+ConstantBuffer NullGpuBackend::create_constant_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name)
+{
+    (void)buffer_name;
+
+    GpuResource resource = create_resource(nullptr, size_in_bytes);
+    u8 *const resource_mapped_ptr = static_cast<u8 *>(resource.get());
+
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    m_statistics.m_number_of_constant_buffers_created++;
+
+    return ConstantBuffer{
+        .resource = std::move(resource),
+        .cbv_index = m_next_descriptor_index++,
+        .size_in_bytes = size_in_bytes,
+        .resource_mapped_ptr = resource_mapped_ptr,
+    };
+}
+
+UploadBuffer NullGpuBackend::create_upload_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name)
+{
+    (void)buffer_name;
+
+    GpuResource resource = create_resource(nullptr, size_in_bytes);
+    u8 *const resource_mapped_ptr = static_cast<u8 *>(resource.get());
+
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    m_statistics.m_number_of_upload_buffers_created++;
+
+    return UploadBuffer{
+        .resource = std::move(resource),
+        .resource_mapped_ptr = resource_mapped_ptr,
+        .size_in_bytes = size_in_bytes,
+    };
+}
+
+void NullGpuBackend::copy_buffer_region(const GpuResource &destination, const size_t destination_offset,
+                                        const UploadBuffer &source, const size_t source_offset,
+                                        const size_t size_in_bytes)
+{
+    memcpy(static_cast<u8 *>(destination.get()) + destination_offset, source.resource_mapped_ptr + source_offset,
+           size_in_bytes);
+
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    m_statistics.m_uploaded_size_in_bytes += size_in_bytes;
+}
+
+u64 NullGpuBackend::get_last_copy_queue_fence_value() const
+{
+    return 0u;
+}
+
+u64 NullGpuBackend::get_completed_copy_queue_fence_value() const
+{
+    return std::numeric_limits<u64>::max();
+}
+
+void NullGpuBackend::flush_copy_queue()
+{
+}
+
+NullGpuBackend::Statistics NullGpuBackend::get_statistics() const
+{
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    return m_statistics;
+}
@@ -0,0 +1,365 @@
+#include "voxel-engine/occlusion_culling.hpp"
+
+#include "voxel-engine/timer.hpp"
+
+#include <immintrin.h>
+
+// Faces of a box, as indices into its corners (bit 0 : max x, bit 1 : max y, bit 2 : max z) in cyclic order. A face is
+// on the min or max side of the box along its axis.
+struct BoxFace
+{
+    std::array<u32, 4u> m_corner_indices{};
+    u32 m_axis{};
+    bool m_is_max_side{};
+};
+
+static constexpr std::array<BoxFace, 6u> BOX_FACES = {{
+    {{0u, 2u, 6u, 4u}, 0u, false},
+    {{1u, 3u, 7u, 5u}, 0u, true},
+    {{0u, 1u, 5u, 4u}, 1u, false},
+    {{2u, 3u, 7u, 6u}, 1u, true},
+    {{0u, 1u, 3u, 2u}, 2u, false},
+    {{4u, 5u, 7u, 6u}, 2u, true},
+}};
+
+void OcclusionBuffer::set_view(const DirectX::XMFLOAT4X4 &view_projection_matrix,
+                               const DirectX::XMFLOAT3 camera_position, const float near_plane)
+{
+    m_view_projection_matrix = view_projection_matrix;
+    m_camera_position = camera_position;
+    m_near_plane = near_plane;
+
+    m_depth.assign(static_cast<size_t>(WIDTH) * HEIGHT, std::numeric_limits<float>::infinity());
+}
+
+OcclusionBuffer::ProjectedPoint OcclusionBuffer::project(const DirectX::XMFLOAT3 position) const
+{
+    const auto &m = m_view_projection_matrix.m;
+
+    // The view matrix is relative to the camera.
+    const float x = position.x - m_camera_position.x;
+    const float y = position.y - m_camera_position.y;
+    const float z = position.z - m_camera_position.z;
+
+    const float clip_x = x * m[0][0] + y * m[1][0] + z * m[2][0] + m[3][0];
+    const float clip_y = x * m[0][1] + y * m[1][1] + z * m[2][1] + m[3][1];
+    const float clip_w = x * m[0][3] + y * m[1][3] + z * m[2][3] + m[3][3];
+
+    // Clip space y points up, and screen space y points down.
+    return ProjectedPoint{
+        .m_x = (clip_x / clip_w * 0.5f + 0.5f) * static_cast<float>(WIDTH),
+        .m_y = (0.5f - clip_y / clip_w * 0.5f) * static_cast<float>(HEIGHT),
+        .m_w = clip_w,
+    };
+}
+
+bool OcclusionBuffer::project_box(const DirectX::XMFLOAT3 box_min, const float edge_length,
+                                  std::array<ProjectedPoint, 8u> &corners) const
+{
+    for (u32 i = 0u; i < 8u; i++)
+    {
+        corners[i] = project({
+            box_min.x + ((i & 1u) ? edge_length : 0.0f),
+            box_min.y + ((i & 2u) ? edge_length : 0.0f),
+            box_min.z + ((i & 4u) ? edge_length : 0.0f),
+        });
+
+        if (corners[i].m_w < m_near_plane)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void OcclusionBuffer::rasterize_box(const DirectX::XMFLOAT3 box_min, const float edge_length)
+{
+    std::array<ProjectedPoint, 8u> corners{};
+    if (!project_box(box_min, edge_length, corners))
+    {
+        return;
+    }
+
+    const std::array<float, 3u> camera_position = {m_camera_position.x, m_camera_position.y, m_camera_position.z};
+    const std::array<float, 3u> min = {box_min.x, box_min.y, box_min.z};
+
+    for (const BoxFace &face : BOX_FACES)
+    {
+        // Only the faces that face the camera make up the silhouette of the box.
+        const bool is_facing_camera = face.m_is_max_side ? camera_position[face.m_axis] > min[face.m_axis] + edge_length
+                                                         : camera_position[face.m_axis] < min[face.m_axis];
+        if (!is_facing_camera)
+        {
+            continue;
+        }
+
+        std::array<ProjectedPoint, 4u> face_corners{};
+        float depth = 0.0f;
+        for (u32 i = 0u; i < 4u; i++)
+        {
+            face_corners[i] = corners[face.m_corner_indices[i]];
+            depth = std::max(depth, face_corners[i].m_w);
+        }
+
+        rasterize_quad(face_corners, depth);
+    }
+}
+
+void OcclusionBuffer::rasterize_quad(const std::array<ProjectedPoint, 4u> &corners, const float depth)
+{
+    float double_area = 0.0f;
+    float min_x = corners[0].m_x;
+    float max_x = corners[0].m_x;
+    float min_y = corners[0].m_y;
+    float max_y = corners[0].m_y;
+
+    for (u32 i = 0u; i < 4u; i++)
+    {
+        const ProjectedPoint &a = corners[i];
+        const ProjectedPoint &b = corners[(i + 1u) % 4u];
+        double_area += a.m_x * b.m_y - b.m_x * a.m_y;
+
+        min_x = std::min(min_x, a.m_x);
+        max_x = std::max(max_x, a.m_x);
+        min_y = std::min(min_y, a.m_y);
+        max_y = std::max(max_y, a.m_y);
+    }
+
+    // Edge on quads do not cover anything.
+    if (std::abs(double_area) < 1e-6f)
+    {
+        return;
+    }
+
+    // A pixel is covered if its center is inside of the quad.
+    const i32 first_x = std::max(static_cast<i32>(std::ceil(min_x - 0.5f)), 0);
+    const i32 last_x = std::min(static_cast<i32>(std::floor(max_x - 0.5f)), static_cast<i32>(WIDTH) - 1);
+    const i32 first_y = std::max(static_cast<i32>(std::ceil(min_y - 0.5f)), 0);
+    const i32 last_y = std::min(static_cast<i32>(std::floor(max_y - 0.5f)), static_cast<i32>(HEIGHT) - 1);
+
+    if (first_x > last_x || first_y > last_y)
+    {
+        return;
+    }
+
+    // Edge functions, in the form a * x + b * y + c. They are all positive inside of the quad, whatever its winding.
+    const float winding = double_area > 0.0f ? 1.0f : -1.0f;
+
+    std::array<float, 4u> edge_a{};
+    std::array<float, 4u> edge_b{};
+    std::array<float, 4u> edge_c{};
+    for (u32 i = 0u; i < 4u; i++)
+    {
+        const ProjectedPoint &a = corners[i];
+        const ProjectedPoint &b = corners[(i + 1u) % 4u];
+
+        edge_a[i] = -(b.m_y - a.m_y) * winding;
+        edge_b[i] = (b.m_x - a.m_x) * winding;
+        edge_c[i] = -(edge_a[i] * a.m_x + edge_b[i] * a.m_y);
+    }
+
+    for (i32 y = first_y; y <= last_y; y++)
+    {
+        const float pixel_y = static_cast<float>(y) + 0.5f;
+
+        std::array<float, 4u> edge_row{};
+        for (u32 i = 0u; i < 4u; i++)
+        {
+            edge_row[i] = edge_b[i] * pixel_y + edge_c[i];
+        }
+
+        float *const depth_row = m_depth.data() + static_cast<size_t>(y) * WIDTH;
+
+#if defined(__AVX2__)
+        // Rows are made of whole blocks of 8 pixels. Pixels of the block that are outside of the bounding rectangle of
+        // the quad are outside of the quad as well, so they do not have to be masked.
+        const __m256 pixel_offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+        const __m256 quad_depth = _mm256_set1_ps(depth);
+
+        for (i32 x = first_x & ~7; x <= last_x; x += 8)
+        {
+            const __m256 pixel_x = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), pixel_offsets);
+
+            __m256 is_inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (u32 i = 0u; i < 4u; i++)
+            {
+                const __m256 edge = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(edge_a[i]), pixel_x),
+                                                  _mm256_set1_ps(edge_row[i]));
+                is_inside = _mm256_and_ps(is_inside, _mm256_cmp_ps(edge, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+
+            const __m256 current_depth = _mm256_loadu_ps(depth_row + x);
+            _mm256_storeu_ps(depth_row + x,
+                             _mm256_blendv_ps(current_depth, _mm256_min_ps(current_depth, quad_depth), is_inside));
+        }
+#else
+        for (i32 x = first_x; x <= last_x; x++)
+        {
+            const float pixel_x = static_cast<float>(x) + 0.5f;
+
+            bool is_inside = true;
+            for (u32 i = 0u; i < 4u; i++)
+            {
+                is_inside &= edge_a[i] * pixel_x + edge_row[i] >= 0.0f;
+            }
+
+            if (is_inside)
+            {
+                depth_row[x] = std::min(depth_row[x], depth);
+            }
+        }
+#endif
+    }
+}
+
+bool OcclusionBuffer::is_box_occluded(const DirectX::XMFLOAT3 box_min, const float edge_length) const
+{
+    std::array<ProjectedPoint, 8u> corners{};
+    if (!project_box(box_min, edge_length, corners))
+    {
+        return false;
+    }
+
+    float nearest_depth = corners[0].m_w;
+    float min_x = corners[0].m_x;
+    float max_x = corners[0].m_x;
+    float min_y = corners[0].m_y;
+    float max_y = corners[0].m_y;
+
+    for (const ProjectedPoint &corner : corners)
+    {
+        nearest_depth = std::min(nearest_depth, corner.m_w);
+
+        min_x = std::min(min_x, corner.m_x);
+        max_x = std::max(max_x, corner.m_x);
+        min_y = std::min(min_y, corner.m_y);
+        max_y = std::max(max_y, corner.m_y);
+    }
+
+    // Every pixel that the bounding rectangle of the box touches is tested. Boxes that are entirely off screen are
+    // left to frustum culling.
+    const i32 first_x = std::max(static_cast<i32>(std::floor(min_x)), 0);
+    const i32 last_x = std::min(static_cast<i32>(std::floor(max_x)), static_cast<i32>(WIDTH) - 1);
+    const i32 first_y = std::max(static_cast<i32>(std::floor(min_y)), 0);
+    const i32 last_y = std::min(static_cast<i32>(std::floor(max_y)), static_cast<i32>(HEIGHT) - 1);
+
+    if (first_x > last_x || first_y > last_y)
+    {
+        return false;
+    }
+
+    for (i32 y = first_y; y <= last_y; y++)
+    {
+        const float *const depth_row = m_depth.data() + static_cast<size_t>(y) * WIDTH;
+
+#if defined(__AVX2__)
+        const __m256i pixel_offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i first_pixel_x = _mm256_set1_epi32(first_x - 1);
+        const __m256i last_pixel_x = _mm256_set1_epi32(last_x + 1);
+        const __m256 box_depth = _mm256_set1_ps(nearest_depth);
+
+        for (i32 x = first_x & ~7; x <= last_x; x += 8)
+        {
+            // Pixels of the block that are outside of the bounding rectangle are masked out.
+            const __m256i pixel_x = _mm256_add_epi32(_mm256_set1_epi32(x), pixel_offsets);
+            const __m256i is_in_rectangle = _mm256_and_si256(_mm256_cmpgt_epi32(pixel_x, first_pixel_x),
+                                                             _mm256_cmpgt_epi32(last_pixel_x, pixel_x));
+
+            const __m256 is_visible =
+                _mm256_and_ps(_mm256_castsi256_ps(is_in_rectangle),
+                              _mm256_cmp_ps(_mm256_loadu_ps(depth_row + x), box_depth, _CMP_GE_OQ));
+            if (_mm256_movemask_ps(is_visible) != 0)
+            {
+                return false;
+            }
+        }
+#else
+        for (i32 x = first_x; x <= last_x; x++)
+        {
+            if (depth_row[x] >= nearest_depth)
+            {
+                return false;
+            }
+        }
+#endif
+    }
+
+    return true;
+}
+
+bool OcclusionCuller::submit(JobSystem &job_system, Frame &&frame)
+{
+    if (m_frame_in_flight)
+    {
+        return false;
+    }
+
+    m_frame_in_flight = std::make_shared<FrameInFlight>();
+    m_frame_in_flight->m_frame = std::move(frame);
+
+    // The result is needed by the next frame, so it is not queued behind the chunks that are waiting to be setup.
+    const JobSystem::JobHandle occlusion_culling_job = job_system.create_job(
+        [frame_in_flight = m_frame_in_flight]() {
+            cull(frame_in_flight->m_frame);
+            frame_in_flight->m_is_complete.store(true, std::memory_order_release);
+        },
+        JobPriority::High);
+    job_system.submit(occlusion_culling_job);
+
+    return true;
+}
+
+bool OcclusionCuller::poll()
+{
+    if (!m_frame_in_flight || !m_frame_in_flight->m_is_complete.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+
+    m_completed_frame = std::move(m_frame_in_flight->m_frame);
+    m_frame_in_flight.reset();
+    ++m_number_of_completed_frames;
+
+    return true;
+}
+
+bool OcclusionCuller::is_frame_in_flight() const
+{
+    return m_frame_in_flight != nullptr;
+}
+
+bool OcclusionCuller::is_chunk_occluded(const size_t chunk_index) const
+{
+    return std::binary_search(m_completed_frame.m_occluded_chunk_indices.begin(),
+                              m_completed_frame.m_occluded_chunk_indices.end(), chunk_index);
+}
+
+void OcclusionCuller::cull(Frame &frame)
+{
+    Timer culling_timer{};
+    culling_timer.start();
+
+    // Each worker has its own buffer, which keeps its storage from one frame to the next.
+    thread_local OcclusionBuffer occlusion_buffer{};
+    occlusion_buffer.set_view(frame.m_view_projection_matrix, frame.m_camera_position, frame.m_near_plane);
+
+    for (const DirectX::XMFLOAT3 &occluder_chunk_min : frame.m_occluder_chunk_mins)
+    {
+        occlusion_buffer.rasterize_box(occluder_chunk_min, frame.m_chunk_length);
+    }
+
+    frame.m_occluded_chunk_indices.clear();
+    for (size_t i = 0u; i < frame.m_chunk_indices.size(); i++)
+    {
+        if (occlusion_buffer.is_box_occluded(frame.m_chunk_mins[i], frame.m_chunk_length))
+        {
+            frame.m_occluded_chunk_indices.push_back(frame.m_chunk_indices[i]);
+        }
+    }
+
+    std::sort(frame.m_occluded_chunk_indices.begin(), frame.m_occluded_chunk_indices.end());
+
+    culling_timer.stop();
+    frame.m_culling_time_us = culling_timer.get_delta_time() * 1000000.0f;
+}
@@ -12,6 +12,20 @@ extern "C"
     __declspec(dllexport) extern const char *D3D12SDKPath = ".\\D3D12\\";
 }
 
+static_assert(sizeof(IndexBufferView) == sizeof(D3D12_INDEX_BUFFER_VIEW));
+static_assert(INDEX_FORMAT_R16_UINT == DXGI_FORMAT_R16_UINT && INDEX_FORMAT_R32_UINT == DXGI_FORMAT_R32_UINT);
+
+// The reference held by the com pointer is handed over to the returned resource.
+static GpuResource to_gpu_resource(Microsoft::WRL::ComPtr<ID3D12Resource> &&resource)
+{
+    return GpuResource(resource.Detach(), [](void *const resource) {
+        if (resource)
+        {
+            static_cast<ID3D12Resource *>(resource)->Release();
+        }
+    });
+}
+
 D3D12_GPU_DESCRIPTOR_HANDLE Renderer::DescriptorHeap::get_gpu_descriptor_handle_at_index(const size_t index) const
 {
     D3D12_GPU_DESCRIPTOR_HANDLE handle = descriptor_heap->GetGPUDescriptorHandleForHeapStart();
@@ -231,16 +245,20 @@ Renderer::IndexBufferWithIntermediateResource Renderer::create_index_buffer(cons
         .Flags = D3D12_RESOURCE_FLAG_NONE,
     };
 
-    throw_if_failed(m_device->CreateCommittedResource(
-        &upload_heap_properties, D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES, &buffer_resource_desc,
-        D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, nullptr, IID_PPV_ARGS(&intermediate_buffer_resource)));
+    // Buffers without data are written later on (see copy_buffer_region), and have no upload buffer.
+    if (data)
+    {
+        throw_if_failed(m_device->CreateCommittedResource(
+            &upload_heap_properties, D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES, &buffer_resource_desc,
+            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, nullptr, IID_PPV_ARGS(&intermediate_buffer_resource)));
 
-    // Now that a resource is created, copy CPU data to this upload buffer.
-    const D3D12_RANGE read_range{.Begin = 0u, .End = 0u};
+        // Now that a resource is created, copy CPU data to this upload buffer.
+        const D3D12_RANGE read_range{.Begin = 0u, .End = 0u};
 
-    throw_if_failed(intermediate_buffer_resource->Map(0u, &read_range, (void **)&resource_ptr));
+        throw_if_failed(intermediate_buffer_resource->Map(0u, &read_range, (void **)&resource_ptr));
 
-    memcpy(resource_ptr, data, size_in_bytes);
+        memcpy(resource_ptr, data, size_in_bytes);
+    }
 
     // Create the final resource and transfer the data from upload buffer to the final buffer.
     // The heap type is : Default (no CPU access).
@@ -259,26 +277,32 @@ Renderer::IndexBufferWithIntermediateResource Renderer::create_index_buffer(cons
     std::scoped_lock<std::mutex> scoped_lock(m_resource_mutex);
 
     name_d3d12_object(buffer_resource.Get(), buffer_name);
-    name_d3d12_object(intermediate_buffer_resource.Get(), std::wstring(buffer_name) + std::wstring(L" [intermediate]"));
 
-    auto command_allocator_list_pair = m_copy_queue.get_command_allocator_list_pair(m_device.Get());
+    if (data)
+    {
+        name_d3d12_object(intermediate_buffer_resource.Get(),
+                          std::wstring(buffer_name) + std::wstring(L" [intermediate]"));
 
-    command_allocator_list_pair.m_command_list->CopyResource(buffer_resource.Get(), intermediate_buffer_resource.Get());
-    m_copy_queue.execute_command_list(std::move(command_allocator_list_pair));
+        auto command_allocator_list_pair = m_copy_queue.get_command_allocator_list_pair(m_device.Get());
 
-    const D3D12_INDEX_BUFFER_VIEW index_buffer_view = {
-        .BufferLocation = buffer_resource->GetGPUVirtualAddress(),
-        .SizeInBytes = static_cast<UINT>(size_in_bytes),
-        .Format = DXGI_FORMAT_R16_UINT,
+        command_allocator_list_pair.m_command_list->CopyResource(buffer_resource.Get(),
+                                                                 intermediate_buffer_resource.Get());
+        m_copy_queue.execute_command_list(std::move(command_allocator_list_pair));
+    }
+
+    const IndexBufferView index_buffer_view = {
+        .buffer_location = buffer_resource->GetGPUVirtualAddress(),
+        .size_in_bytes = static_cast<u32>(size_in_bytes),
+        .format = stride == sizeof(u32) ? INDEX_FORMAT_R32_UINT : INDEX_FORMAT_R16_UINT,
     };
 
     return {
         IndexBuffer{
-            .resource = buffer_resource,
+            .resource = to_gpu_resource(std::move(buffer_resource)),
             .indices_count = indices_count,
             .index_buffer_view = index_buffer_view,
         },
-        intermediate_buffer_resource,
+        to_gpu_resource(std::move(intermediate_buffer_resource)),
     };
 }
 
@@ -313,17 +337,21 @@ Renderer::StucturedBufferWithIntermediateResource Renderer::create_structured_bu
         .Flags = D3D12_RESOURCE_FLAG_NONE,
     };
 
-    throw_if_failed(m_device->CreateCommittedResource(
-        &upload_heap_properties, D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES | D3D12_HEAP_FLAG_CREATE_NOT_ZEROED,
-        &buffer_resource_desc, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, nullptr,
-        IID_PPV_ARGS(&intermediate_buffer_resource)));
+    // Buffers without data are written later on (see copy_buffer_region), and have no upload buffer.
+    if (data)
+    {
+        throw_if_failed(m_device->CreateCommittedResource(
+            &upload_heap_properties,
+            D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES | D3D12_HEAP_FLAG_CREATE_NOT_ZEROED, &buffer_resource_desc,
+            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, nullptr, IID_PPV_ARGS(&intermediate_buffer_resource)));
 
-    // Now that a resource is created, copy CPU data to this upload buffer.
-    const D3D12_RANGE read_range{.Begin = 0u, .End = 0u};
+        // Now that a resource is created, copy CPU data to this upload buffer.
+        const D3D12_RANGE read_range{.Begin = 0u, .End = 0u};
 
-    throw_if_failed(intermediate_buffer_resource->Map(0u, &read_range, (void **)&resource_ptr));
+        throw_if_failed(intermediate_buffer_resource->Map(0u, &read_range, (void **)&resource_ptr));
 
-    memcpy(resource_ptr, data, size_in_bytes);
+        memcpy(resource_ptr, data, size_in_bytes);
+    }
 
     // Create the final resource and transfer the data from upload buffer to the final buffer.
     // The heap type is : Default (no CPU access).
@@ -342,27 +370,33 @@ Renderer::StucturedBufferWithIntermediateResource Renderer::create_structured_bu
     std::scoped_lock<std::mutex> scoped_lock(m_resource_mutex);
 
     name_d3d12_object(buffer_resource.Get(), buffer_name);
-    name_d3d12_object(intermediate_buffer_resource.Get(), std::wstring(buffer_name) + std::wstring(L" [intermediate]"));
 
-    auto command_allocator_list_pair = m_copy_queue.get_command_allocator_list_pair(m_device.Get());
+    if (data)
+    {
+        name_d3d12_object(intermediate_buffer_resource.Get(),
+                          std::wstring(buffer_name) + std::wstring(L" [intermediate]"));
 
-    command_allocator_list_pair.m_command_list->CopyResource(buffer_resource.Get(), intermediate_buffer_resource.Get());
-    m_copy_queue.execute_command_list(std::move(command_allocator_list_pair));
+        auto command_allocator_list_pair = m_copy_queue.get_command_allocator_list_pair(m_device.Get());
+
+        command_allocator_list_pair.m_command_list->CopyResource(buffer_resource.Get(),
+                                                                 intermediate_buffer_resource.Get());
+        m_copy_queue.execute_command_list(std::move(command_allocator_list_pair));
+    }
 
     // Create structured buffer view.
     size_t srv_index = create_shader_resource_view(buffer_resource.Get(), stride, num_elements);
 
     return {
         StructuredBuffer{
-            .resource = buffer_resource,
+            .resource = to_gpu_resource(std::move(buffer_resource)),
             .srv_index = srv_index,
+            .size_in_bytes = size_in_bytes,
         },
-        intermediate_buffer_resource,
+        to_gpu_resource(std::move(intermediate_buffer_resource)),
     };
 }
 
-ConstantBuffer Renderer::internal_create_constant_buffer(const size_t size_in_bytes,
-                                                         const std::wstring_view buffer_name)
+ConstantBuffer Renderer::create_constant_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name)
 {
     u8 *resource_ptr{};
     Microsoft::WRL::ComPtr<ID3D12Resource> buffer_resource{};
@@ -406,13 +440,72 @@ ConstantBuffer Renderer::internal_create_constant_buffer(const size_t size_in_by
     size_t cbv_index = create_constant_buffer_view(buffer_resource.Get(), size_in_bytes);
 
     return ConstantBuffer{
-        .resource = buffer_resource,
+        .resource = to_gpu_resource(std::move(buffer_resource)),
         .cbv_index = cbv_index,
         .size_in_bytes = size_in_bytes,
         .resource_mapped_ptr = resource_ptr,
     };
 }
 
+UploadBuffer Renderer::create_upload_buffer(const size_t size_in_bytes, const std::wstring_view buffer_name)
+{
+    u8 *resource_ptr{};
+    Microsoft::WRL::ComPtr<ID3D12Resource> buffer_resource{};
+
+    const D3D12_HEAP_PROPERTIES upload_heap_properties = {
+        .Type = D3D12_HEAP_TYPE_UPLOAD,
+        .CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN,
+        .MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN,
+        .CreationNodeMask = 0u,
+        .VisibleNodeMask = 0u,
+    };
+
+    const D3D12_RESOURCE_DESC buffer_resource_desc = {
+        .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+        .Width = size_in_bytes,
+        .Height = 1u,
+        .DepthOrArraySize = 1u,
+        .MipLevels = 1u,
+        .Format = DXGI_FORMAT_UNKNOWN,
+        .SampleDesc = {1u, 0u},
+        .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+        .Flags = D3D12_RESOURCE_FLAG_NONE,
+    };
+
+    throw_if_failed(m_device->CreateCommittedResource(
+        &upload_heap_properties, D3D12_HEAP_FLAG_ALLOW_ALL_BUFFERS_AND_TEXTURES | D3D12_HEAP_FLAG_CREATE_NOT_ZEROED,
+        &buffer_resource_desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer_resource)));
+
+    const D3D12_RANGE read_range{.Begin = 0u, .End = 0u};
+
+    throw_if_failed(buffer_resource->Map(0u, &read_range, (void **)&resource_ptr));
+
+    std::scoped_lock<std::mutex> scoped_lock(m_resource_mutex);
+
+    name_d3d12_object(buffer_resource.Get(), buffer_name);
+
+    return UploadBuffer{
+        .resource = to_gpu_resource(std::move(buffer_resource)),
+        .resource_mapped_ptr = resource_ptr,
+        .size_in_bytes = size_in_bytes,
+    };
+}
+
+void Renderer::copy_buffer_region(const GpuResource &destination, const size_t destination_offset,
+                                  const UploadBuffer &source, const size_t source_offset, const size_t size_in_bytes)
+{
+    std::scoped_lock<std::mutex> scoped_lock(m_resource_mutex);
+
+    auto command_allocator_list_pair = m_copy_queue.get_command_allocator_list_pair(m_device.Get());
+
+    // Buffers decay to the common state once the direct queue is done with them, so the copy queue can write the
+    // range while the direct queue reads (other ranges of) the buffer in later frames.
+    command_allocator_list_pair.m_command_list->CopyBufferRegion(
+        static_cast<ID3D12Resource *>(destination.get()), destination_offset,
+        static_cast<ID3D12Resource *>(source.resource.get()), source_offset, size_in_bytes);
+    m_copy_queue.execute_command_list(std::move(command_allocator_list_pair));
+}
+
 CommandBuffer Renderer::create_command_buffer(const size_t stride, const size_t max_number_of_elements,
                                               const std::wstring_view buffer_name)
 {
@@ -534,6 +627,24 @@ CommandBuffer Renderer::create_command_buffer(const size_t stride, const size_t
     };
 }
 
+u64 Renderer::get_last_copy_queue_fence_value() const
+{
+    // The copy queue is signalled by the resource creation functions, which hold the resource mutex.
+    std::scoped_lock<std::mutex> scoped_lock(m_resource_mutex);
+
+    return m_copy_queue.m_monotonic_fence_value;
+}
+
+u64 Renderer::get_completed_copy_queue_fence_value() const
+{
+    return m_copy_queue.m_fence->GetCompletedValue();
+}
+
+void Renderer::flush_copy_queue()
+{
+    m_copy_queue.flush_queue();
+}
+
 size_t Renderer::create_constant_buffer_view(ID3D12Resource *const resource, const size_t size)
 {
     const D3D12_CPU_DESCRIPTOR_HANDLE handle = m_cbv_srv_uav_descriptor_heap.current_cpu_descriptor_handle;
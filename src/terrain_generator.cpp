@@ -0,0 +1,264 @@
+#include "voxel-engine/terrain_generator.hpp"
+
+namespace TerrainGenerator
+{
+// Number of voxels below the surface that are soil (rather than stone).
+static constexpr float SOIL_DEPTH = 4.0f;
+
+// Block type of a solid voxel, from its depth below the terrain surface (in voxels) and the height of the surface.
+static inline BlockType get_block_type(const TerrainSettings &terrain_settings, const float surface_height,
+                                       const float depth)
+{
+    if (depth >= SOIL_DEPTH)
+    {
+        return BlockType::Stone;
+    }
+
+    const float relative_surface_height = (surface_height - static_cast<float>(terrain_settings.m_base_height)) /
+                                          terrain_settings.m_height_amplitude;
+
+    if (relative_surface_height > 0.5f)
+    {
+        return BlockType::Snow;
+    }
+
+    if (relative_surface_height < -0.4f)
+    {
+        return BlockType::Sand;
+    }
+
+    return depth < 1.0f ? BlockType::Grass : BlockType::Dirt;
+}
+
+u32 get_chunk_seed(const u32 world_seed, const size_t chunk_index)
+{
+    // splitmix64 finalizer.
+    u64 seed = (static_cast<u64>(world_seed) << 32u) ^ static_cast<u64>(chunk_index);
+    seed += 0x9e3779b97f4a7c15ull;
+    seed = (seed ^ (seed >> 30u)) * 0xbf58476d1ce4e5b9ull;
+    seed = (seed ^ (seed >> 27u)) * 0x94d049bb133111ebull;
+    seed = seed ^ (seed >> 31u);
+
+    return static_cast<u32>(seed);
+}
+
+template <u32 N>
+void generate_heightmap_column(const TerrainSettings &terrain_settings, const u32 chunk_x, const u32 chunk_z,
+                               BasicHeightmapColumn<N> &heightmap_column)
+{
+    for (u32 z = 0; z < N; z++)
+    {
+        float *const heights = heightmap_column.m_heights.data() + z * N;
+
+        // The heightmap is a 2D function, so it is sampled on the y = 0 plane of the 3D noise.
+        Noise::fbm_3d_row(terrain_settings.m_fbm_settings, static_cast<float>(chunk_x * N), 0.0f,
+                          static_cast<float>(chunk_z * N + z), terrain_settings.m_seed, N, heights);
+
+        for (u32 x = 0; x < N; x++)
+        {
+            heights[x] =
+                static_cast<float>(terrain_settings.m_base_height) + heights[x] * terrain_settings.m_height_amplitude;
+        }
+    }
+}
+
+template <u32 N>
+void generate_heightmap(const TerrainSettings &terrain_settings, const DirectX::XMUINT3 chunk_index_3d,
+                        const BasicHeightmapColumn<N> &heightmap_column, BasicChunk<N> &chunk)
+{
+    const u32 chunk_offset_y = chunk_index_3d.y * N;
+
+    // Fast path for chunks that are entirely above the surface, or entirely stone below it.
+    const auto [min_height, max_height] =
+        std::minmax_element(heightmap_column.m_heights.begin(), heightmap_column.m_heights.end());
+
+    if (static_cast<float>(chunk_offset_y) >= *max_height)
+    {
+        chunk.set_uniform(OccupancyState::Empty);
+        return;
+    }
+
+    if (static_cast<float>(chunk_offset_y + N - 1u) + SOIL_DEPTH <= *min_height)
+    {
+        chunk.set_uniform(OccupancyState::Full, BlockType::Stone);
+        return;
+    }
+
+    for (u32 z = 0; z < N; z++)
+    {
+        const float *const heights = heightmap_column.m_heights.data() + z * N;
+
+        for (u32 y = 0; y < N; y++)
+        {
+            const float world_y = static_cast<float>(chunk_offset_y + y);
+
+            u64 row = 0ull;
+            for (u32 x = 0; x < N; x++)
+            {
+                row |= static_cast<u64>(world_y < heights[x]) << x;
+            }
+
+            chunk.set_row(y, z, row);
+
+            // Stone is the default block type, so only the soil has to be set.
+            while (row)
+            {
+                const u32 x = static_cast<u32>(std::countr_zero(row));
+                row &= row - 1ull;
+
+                const BlockType block_type = get_block_type(terrain_settings, heights[x], heights[x] - world_y);
+                if (block_type != BasicChunk<N>::DEFAULT_BLOCK_TYPE)
+                {
+                    chunk.set_block_type({x, y, z}, block_type);
+                }
+            }
+        }
+    }
+}
+
+template <u32 N>
+void generate_density(const TerrainSettings &terrain_settings, const DirectX::XMUINT3 chunk_index_3d,
+                      BasicChunk<N> &chunk)
+{
+    const DirectX::XMUINT3 chunk_offset = {chunk_index_3d.x * N, chunk_index_3d.y * N, chunk_index_3d.z * N};
+
+    // Density falls off linearly with height, and reaches zero at the base height.
+    // A voxel is active if the density is positive.
+    const float inverse_height_amplitude = 1.0f / terrain_settings.m_height_amplitude;
+
+    // fbm is in the range [-1, 1], so chunks that are far enough from the base height are uniform, and no noise has to
+    // be evaluated for them.
+    const float base_height = static_cast<float>(terrain_settings.m_base_height);
+    if ((base_height - static_cast<float>(chunk_offset.y + N - 1u)) * inverse_height_amplitude > 1.0f)
+    {
+        chunk.set_uniform(OccupancyState::Full);
+        return;
+    }
+
+    if ((base_height - static_cast<float>(chunk_offset.y)) * inverse_height_amplitude < -1.0f)
+    {
+        chunk.set_uniform(OccupancyState::Empty);
+        return;
+    }
+
+    std::array<float, N> densities{};
+
+    // Returns the active voxels of the row of the chunk column at world y and z.
+    const auto get_density_row = [&](const u32 world_y, const u32 z) {
+        Noise::fbm_3d_row(terrain_settings.m_fbm_settings, static_cast<float>(chunk_offset.x),
+                          static_cast<float>(world_y), static_cast<float>(chunk_offset.z + z), terrain_settings.m_seed,
+                          N, densities.data());
+
+        const float height_gradient = (base_height - static_cast<float>(world_y)) * inverse_height_amplitude;
+
+        u64 row = 0ull;
+        for (u32 x = 0; x < N; x++)
+        {
+            row |= static_cast<u64>(densities[x] + height_gradient > 0.0f) << x;
+        }
+
+        return row;
+    };
+
+    for (u32 z = 0; z < N; z++)
+    {
+        for (u32 y = 0; y < N; y++)
+        {
+            chunk.set_row(y, z, get_density_row(chunk_offset.y + y, z));
+        }
+    }
+
+    // The surface is not known for the density preset, so the depth of a voxel is the number of active voxels above
+    // it. The SOIL_DEPTH rows above the chunk are sampled too, so that the depth carries across the top of the chunk :
+    // otherwise, the top solid voxels of every buried chunk would be soil. They are all empty if they are far enough
+    // above the base height.
+    static constexpr u32 SOIL_DEPTH_IN_VOXELS = static_cast<u32>(SOIL_DEPTH);
+    const bool is_above_chunk_empty =
+        (base_height - static_cast<float>(chunk_offset.y + N)) * inverse_height_amplitude < -1.0f;
+
+    for (u32 z = 0; z < N; z++)
+    {
+        // Number of consecutive active voxels right above the chunk, in each column (up to SOIL_DEPTH).
+        std::array<u32, N> depths_above_chunk{};
+        for (u32 i = 0; i < SOIL_DEPTH_IN_VOXELS && !is_above_chunk_empty; i++)
+        {
+            const u64 row = get_density_row(chunk_offset.y + N + i, z);
+            for (u32 x = 0; x < N; x++)
+            {
+                depths_above_chunk[x] += depths_above_chunk[x] == i && ((row >> x) & 1ull);
+            }
+        }
+
+        for (u32 x = 0; x < N; x++)
+        {
+            u32 depth = depths_above_chunk[x];
+            for (u32 y = N; y-- > 0u;)
+            {
+                if (!chunk.is_voxel_active({x, y, z}))
+                {
+                    depth = 0u;
+                    continue;
+                }
+
+                const float surface_height = static_cast<float>(chunk_offset.y + y + depth + 1u);
+                const BlockType block_type =
+                    get_block_type(terrain_settings, surface_height, static_cast<float>(depth));
+                if (block_type != BasicChunk<N>::DEFAULT_BLOCK_TYPE)
+                {
+                    chunk.set_block_type({x, y, z}, block_type);
+                }
+
+                ++depth;
+            }
+        }
+    }
+}
+
+template <u32 N>
+void generate(const TerrainPreset terrain_preset, const TerrainSettings &terrain_settings,
+              const DirectX::XMUINT3 chunk_index_3d, const BasicHeightmapColumn<N> *const heightmap_column,
+              BasicChunk<N> &chunk)
+{
+    switch (terrain_preset)
+    {
+    case TerrainPreset::Heightmap: {
+        if (heightmap_column)
+        {
+            generate_heightmap(terrain_settings, chunk_index_3d, *heightmap_column, chunk);
+        }
+        else
+        {
+            BasicHeightmapColumn<N> local_heightmap_column{};
+            generate_heightmap_column(terrain_settings, chunk_index_3d.x, chunk_index_3d.z, local_heightmap_column);
+            generate_heightmap(terrain_settings, chunk_index_3d, local_heightmap_column, chunk);
+        }
+    }
+    break;
+
+    case TerrainPreset::Density: {
+        generate_density(terrain_settings, chunk_index_3d, chunk);
+    }
+    break;
+    }
+
+    // Uniform chunks do not keep any voxel data.
+    chunk.update_occupancy_state();
+}
+
+// Chunk dimensions that are supported (see chunk.cpp).
+#define VX_INSTANTIATE_TERRAIN_GENERATOR(N)                                                                            \
+    template void generate_heightmap_column<N>(const TerrainSettings &, const u32, const u32,                          \
+                                               BasicHeightmapColumn<N> &);                                             \
+    template void generate_heightmap<N>(const TerrainSettings &, const DirectX::XMUINT3,                               \
+                                        const BasicHeightmapColumn<N> &, BasicChunk<N> &);                             \
+    template void generate_density<N>(const TerrainSettings &, const DirectX::XMUINT3, BasicChunk<N> &);               \
+    template void generate<N>(const TerrainPreset, const TerrainSettings &, const DirectX::XMUINT3,                    \
+                              const BasicHeightmapColumn<N> *const, BasicChunk<N> &);
+
+VX_INSTANTIATE_TERRAIN_GENERATOR(8u)
+VX_INSTANTIATE_TERRAIN_GENERATOR(16u)
+VX_INSTANTIATE_TERRAIN_GENERATOR(32u)
+VX_INSTANTIATE_TERRAIN_GENERATOR(64u)
+
+#undef VX_INSTANTIATE_TERRAIN_GENERATOR
+} // namespace TerrainGenerator
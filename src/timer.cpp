@@ -1,24 +1,18 @@
 #include "voxel-engine/timer.hpp"
 
-Timer::Timer()
-{
-    // Get the performance counter frequency (in seconds).
-    QueryPerformanceFrequency(&m_performance_frequency);
-
-    m_seconds_per_count = 1.0f / (float)m_performance_frequency.QuadPart;
-}
+// The steady clock is backed by the performance counter on Windows (and the monotonic clock elsewhere).
 
 void Timer::start()
 {
-    QueryPerformanceCounter(&m_start_time);
+    m_start_time = std::chrono::steady_clock::now();
 }
 
 void Timer::stop()
 {
-    QueryPerformanceCounter(&m_end_time);
+    m_end_time = std::chrono::steady_clock::now();
 }
 
 float Timer::get_delta_time() const
 {
-    return (m_end_time.QuadPart - m_start_time.QuadPart) * m_seconds_per_count;
+    return std::chrono::duration<float>(m_end_time - m_start_time).count();
 }
\ No newline at end of file
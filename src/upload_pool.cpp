@@ -0,0 +1,111 @@
+#include "voxel-engine/upload_pool.hpp"
+
+UploadPool::UploadPool(const size_t page_size) : m_page_size(round_up_to_multiple(page_size, ALIGNMENT))
+{
+}
+
+UploadAllocation UploadPool::allocate(GpuBackend &gpu_backend, const size_t size_in_bytes)
+{
+    const size_t aligned_size_in_bytes = round_up_to_multiple(size_in_bytes, ALIGNMENT);
+
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    // First fit, in the first page that has room.
+    const auto find_free_range = [&](Page &page) {
+        return std::find_if(page.m_free_ranges.begin(), page.m_free_ranges.end(),
+                            [&](const Range &range) { return range.m_size_in_bytes >= aligned_size_in_bytes; });
+    };
+
+    u32 page_index = 0u;
+    while (page_index < m_pages.size() &&
+           find_free_range(m_pages[page_index]) == m_pages[page_index].m_free_ranges.end())
+    {
+        ++page_index;
+    }
+
+    // A range that is larger than a page gets a page of its own size.
+    if (page_index == m_pages.size())
+    {
+        const size_t page_size = std::max(m_page_size, aligned_size_in_bytes);
+
+        Page &page = m_pages.emplace_back();
+        page.m_upload_buffer = gpu_backend.create_upload_buffer(
+            page_size, std::wstring(L"Upload pool page : ") + std::to_wstring(page_index));
+        page.m_free_ranges = {Range{0u, page_size}};
+
+        m_statistics.m_number_of_page_allocations++;
+        m_statistics.m_reserved_size_in_bytes += page_size;
+    }
+
+    Page &page = m_pages[page_index];
+    const auto free_range = find_free_range(page);
+
+    const UploadAllocation allocation = {
+        .m_upload_buffer = page.m_upload_buffer,
+        .m_page_index = page_index,
+        .m_offset = free_range->m_offset,
+        .m_size_in_bytes = aligned_size_in_bytes,
+    };
+
+    free_range->m_offset += aligned_size_in_bytes;
+    free_range->m_size_in_bytes -= aligned_size_in_bytes;
+    if (free_range->m_size_in_bytes == 0u)
+    {
+        page.m_free_ranges.erase(free_range);
+    }
+
+    m_statistics.m_number_of_allocations++;
+    m_statistics.m_size_in_bytes_in_use += aligned_size_in_bytes;
+    m_statistics.m_peak_size_in_bytes_in_use =
+        std::max(m_statistics.m_peak_size_in_bytes_in_use, m_statistics.m_size_in_bytes_in_use);
+
+    return allocation;
+}
+
+void UploadPool::free(const UploadAllocation &allocation)
+{
+    if (!allocation.is_valid())
+    {
+        return;
+    }
+
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    Page &page = m_pages[allocation.m_page_index];
+
+    // The range is merged with the free ranges right before and after it, if any.
+    const auto next_range =
+        std::lower_bound(page.m_free_ranges.begin(), page.m_free_ranges.end(), allocation.m_offset,
+                         [](const Range &range, const size_t offset) { return range.m_offset < offset; });
+
+    const auto range = page.m_free_ranges.insert(next_range, Range{
+                                                                 .m_offset = allocation.m_offset,
+                                                                 .m_size_in_bytes = allocation.m_size_in_bytes,
+                                                             });
+
+    if (const auto next = std::next(range);
+        next != page.m_free_ranges.end() && range->m_offset + range->m_size_in_bytes == next->m_offset)
+    {
+        range->m_size_in_bytes += next->m_size_in_bytes;
+        page.m_free_ranges.erase(next);
+    }
+
+    if (range != page.m_free_ranges.begin())
+    {
+        const auto previous = std::prev(range);
+        if (previous->m_offset + previous->m_size_in_bytes == range->m_offset)
+        {
+            previous->m_size_in_bytes += range->m_size_in_bytes;
+            page.m_free_ranges.erase(range);
+        }
+    }
+
+    m_statistics.m_size_in_bytes_in_use -= allocation.m_size_in_bytes;
+}
+
+UploadPool::Statistics UploadPool::get_statistics() const
+{
+    std::scoped_lock<std::mutex> scoped_lock(m_mutex);
+
+    return m_statistics;
+}
@@ -1,326 +1,1153 @@
 #include "voxel-engine/voxel.hpp"
 
+#include "voxel-engine/timer.hpp"
+
 #include "shaders/interop/render_resources.hlsli"
 
-Chunk::Chunk()
+ChunkManager::ChunkManager(GpuBackend &gpu_backend, const u32 number_of_worker_threads)
+    : m_job_system(number_of_worker_threads)
 {
-    m_voxels = new Voxel[NUMBER_OF_VOXELS];
+    // Create the position buffer : one position per lattice point (i.e voxel corner) of the chunk.
+    static constexpr u32 NUMBER_OF_LATTICE_POINTS_PER_DIMENSION = Chunk::NUMBER_OF_VOXELS_PER_DIMENSION + 1u;
+
+    std::vector<DirectX::XMFLOAT3> chunk_position_data{};
+    chunk_position_data.reserve(NUMBER_OF_SHARED_VERTICES<CHUNK_DIMENSION>);
+
+    for (u32 z = 0; z < NUMBER_OF_LATTICE_POINTS_PER_DIMENSION; z++)
+    {
+        for (u32 y = 0; y < NUMBER_OF_LATTICE_POINTS_PER_DIMENSION; y++)
+        {
+            for (u32 x = 0; x < NUMBER_OF_LATTICE_POINTS_PER_DIMENSION; x++)
+            {
+                chunk_position_data.push_back(
+                    DirectX::XMFLOAT3(x * Voxel::EDGE_LENGTH, y * Voxel::EDGE_LENGTH, z * Voxel::EDGE_LENGTH));
+            }
+        }
+    }
+
+    const auto result =
+        gpu_backend.create_structured_buffer(chunk_position_data.data(), sizeof(DirectX::XMFLOAT3),
+                                             chunk_position_data.size(), L"shared chunk position buffer");
+
+    gpu_backend.flush_copy_queue();
+    m_shared_chunk_position_buffer = result.structured_buffer;
 }
-Chunk::Chunk(Chunk &&other) noexcept : m_voxels(std::move(other.m_voxels)), m_chunk_index(other.m_chunk_index)
 
+void ChunkManager::internal_mt_generate_chunk(SetupChunkData &setup_chunk_data, const size_t index,
+                                              const TerrainPreset terrain_preset,
+                                              const TerrainSettings &terrain_settings,
+                                              const std::shared_ptr<HeightmapColumnCache::Entry> &heightmap_column,
+                                              const CancellationToken &cancellation_token)
 {
-    other.m_voxels = nullptr;
+    setup_chunk_data.m_chunk.m_chunk_index = index;
+
+    if (cancellation_token.is_cancelled())
+    {
+        return;
+    }
+
+    Timer generation_timer{};
+    generation_timer.start();
+
+    const HeightmapColumn *const heightmap_column_data =
+        heightmap_column ? &heightmap_column->get_or_generate(terrain_settings,
+                                                              setup_chunk_data.m_is_heightmap_column_generated)
+                         : nullptr;
+
+    TerrainGenerator::generate(terrain_preset, terrain_settings, convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(index),
+                               heightmap_column_data, setup_chunk_data.m_chunk);
+
+    generation_timer.stop();
+
+    setup_chunk_data.m_is_generated = true;
+    setup_chunk_data.m_terrain_preset = terrain_preset;
+    setup_chunk_data.m_generation_time_us = generation_timer.get_delta_time() * 1000000.0f;
 }
 
-Chunk &Chunk::operator=(Chunk &&other) noexcept
+ChunkManager::SetupChunkData ChunkManager::internal_mt_remesh_chunk(GpuBackend &gpu_backend, Chunk &&chunk,
+                                                                    const MeshingMode meshing_mode, const u32 lod,
+                                                                    const ChunkNeighborApron &apron,
+                                                                    const CancellationToken &cancellation_token)
 {
-    this->m_voxels = std::move(other.m_voxels);
-    this->m_chunk_index = other.m_chunk_index;
+    SetupChunkData setup_chunk_data{};
+    setup_chunk_data.m_chunk = std::move(chunk);
 
-    other.m_voxels = nullptr;
+    internal_mt_mesh_chunk(gpu_backend, setup_chunk_data, meshing_mode, lod, apron, cancellation_token);
 
-    return *this;
+    return setup_chunk_data;
 }
 
-Chunk::~Chunk()
+void ChunkManager::internal_mt_mesh_chunk(GpuBackend &gpu_backend, SetupChunkData &setup_chunk_data,
+                                          const MeshingMode meshing_mode, const u32 lod,
+                                          const ChunkNeighborApron &apron,
+                                          const CancellationToken &cancellation_token)
 {
-    if (m_voxels)
+    if (cancellation_token.is_cancelled())
+    {
+        return;
+    }
+
+    const size_t index = setup_chunk_data.m_chunk.m_chunk_index;
+
+    setup_chunk_data.m_chunk.m_meshed_neighbors_mask = apron.m_available_neighbors_mask;
+    setup_chunk_data.m_meshing_mode = meshing_mode;
+    setup_chunk_data.m_lod = lod;
+
+    // Only depends on the voxels of the chunk itself, so it is up to date whenever the chunk is (re-)meshed.
+    setup_chunk_data.m_face_connectivity = CaveCulling::compute_face_connectivity(setup_chunk_data.m_chunk);
+
+    // Uniform chunks that cannot have any visible face skip meshing and buffer creation entirely. They still take part
+    // in neighbor aware culling, as the neighbors read their boundary slabs.
+    if (!ChunkMesher::is_mesh_required(setup_chunk_data.m_chunk, apron))
+    {
+        return;
+    }
+
+    setup_chunk_data.m_is_meshed = true;
+
+    // Iterate over each voxel in chunk and setup the chunk index and color buffer.
+    Timer meshing_timer{};
+    meshing_timer.start();
+
+    ChunkMesh &chunk_mesh = ChunkMesher::get_scratch_mesh<CHUNK_DIMENSION>();
+    const size_t scratch_mesh_capacity_in_bytes = chunk_mesh.get_capacity_in_bytes();
+
+    if (lod == 0u)
+    {
+        ChunkMesher::mesh(meshing_mode, setup_chunk_data.m_chunk, apron, chunk_mesh);
+    }
+    else
+    {
+        ChunkMesher::downsampled_greedy_mesh(setup_chunk_data.m_chunk, apron, lod, chunk_mesh);
+    }
+
+    meshing_timer.stop();
+
+    setup_chunk_data.m_meshing_time_us = meshing_timer.get_delta_time() * 1000000.0f;
+    setup_chunk_data.m_number_of_triangles = chunk_mesh.get_triangle_count();
+    setup_chunk_data.m_face_direction_index_ranges = chunk_mesh.m_face_direction_index_ranges;
+
+    if (chunk_mesh.get_capacity_in_bytes() != scratch_mesh_capacity_in_bytes)
+    {
+        m_number_of_scratch_mesh_allocations++;
+    }
+
+    // Writing the upload range is what costs upload bandwidth, so it is worth checking again.
+    if (cancellation_token.is_cancelled())
+    {
+        return;
+    }
+
+    // The mesh is copied into the upload range, so the scratch mesh can be re-used after this. The indices are
+    // re-encoded for the region of the chunk, as the chunks of a region share the same buffers.
+    if (!chunk_mesh.m_indices.empty())
     {
-        delete[] m_voxels;
+        const size_t indices_size_in_bytes = sizeof(ChunkRegions::Index) * chunk_mesh.m_indices.size();
+        const size_t colors_size_in_bytes = sizeof(DirectX::XMFLOAT3) * chunk_mesh.m_colors.size();
+
+        setup_chunk_data.m_mesh_upload_allocation =
+            m_mesh_upload_pool.allocate(gpu_backend, indices_size_in_bytes + colors_size_in_bytes);
+
+        const u32 region_chunk_slot =
+            ChunkRegions::get_region_chunk_slot(convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(index));
+
+        ChunkRegions::Index *const indices =
+            reinterpret_cast<ChunkRegions::Index *>(setup_chunk_data.m_mesh_upload_allocation.get_mapped_ptr());
+        for (size_t i = 0u; i < chunk_mesh.m_indices.size(); i++)
+        {
+            indices[i] = ChunkRegions::encode_index(chunk_mesh.m_indices[i], region_chunk_slot);
+        }
+
+        memcpy(setup_chunk_data.m_mesh_upload_allocation.get_mapped_ptr() + indices_size_in_bytes,
+               chunk_mesh.m_colors.data(), colors_size_in_bytes);
     }
 }
 
-ChunkManager::ChunkManager(Renderer &renderer)
+std::optional<size_t> ChunkManager::get_neighbor_chunk_index(const size_t chunk_index,
+                                                             const FaceDirection face_direction)
 {
-    // Create the position buffer.
-    std::vector<DirectX::XMFLOAT3> chunk_position_data{};
+    const DirectX::XMUINT3 chunk_index_3d = convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+    const DirectX::XMINT3 offset = FACE_DIRECTION_OFFSETS[static_cast<u32>(face_direction)];
 
-    static constexpr std::array<DirectX::XMFLOAT3, 8> chunk_voxel_vertices{
-        DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f),
-        DirectX::XMFLOAT3(0.0f, Voxel::EDGE_LENGTH, 0.0f),
-        DirectX::XMFLOAT3(Voxel::EDGE_LENGTH, Voxel::EDGE_LENGTH, 0.0f),
-        DirectX::XMFLOAT3(Voxel::EDGE_LENGTH, 0.0f, 0.0f),
-        DirectX::XMFLOAT3(0.0f, 0.0f, Voxel::EDGE_LENGTH),
-        DirectX::XMFLOAT3(0.0f, Voxel::EDGE_LENGTH, Voxel::EDGE_LENGTH),
-        DirectX::XMFLOAT3(Voxel::EDGE_LENGTH, Voxel::EDGE_LENGTH, Voxel::EDGE_LENGTH),
-        DirectX::XMFLOAT3(Voxel::EDGE_LENGTH, 0.0f, Voxel::EDGE_LENGTH),
+    const DirectX::XMINT3 neighbor_index_3d = {
+        static_cast<i32>(chunk_index_3d.x) + offset.x,
+        static_cast<i32>(chunk_index_3d.y) + offset.y,
+        static_cast<i32>(chunk_index_3d.z) + offset.z,
     };
 
-    for (size_t i = 0; i < Chunk::NUMBER_OF_VOXELS; i++)
+    for (const i32 component : {neighbor_index_3d.x, neighbor_index_3d.y, neighbor_index_3d.z})
     {
-        const DirectX::XMUINT3 index_3d = convert_to_3d(i, Chunk::NUMBER_OF_VOXELS_PER_DIMENSION);
-        const DirectX::XMFLOAT3 offset = DirectX::XMFLOAT3(
-            index_3d.x * Voxel::EDGE_LENGTH, index_3d.y * Voxel::EDGE_LENGTH, index_3d.z * Voxel::EDGE_LENGTH);
-
-        for (const auto &vertex : chunk_voxel_vertices)
+        if (component < 0 || component >= static_cast<i32>(NUMBER_OF_CHUNKS_PER_DIMENSION))
         {
-            chunk_position_data.push_back({vertex.x + offset.x, vertex.y + offset.y, vertex.z + offset.z});
+            return std::nullopt;
         }
     }
 
-    const auto result = renderer.create_structured_buffer(chunk_position_data.data(), sizeof(DirectX::XMFLOAT3),
-                                                          chunk_position_data.size(), L"shared chunk position buffer");
+    return convert_to_1d<NUMBER_OF_CHUNKS_PER_DIMENSION>({static_cast<u32>(neighbor_index_3d.x),
+                                                          static_cast<u32>(neighbor_index_3d.y),
+                                                          static_cast<u32>(neighbor_index_3d.z)});
+}
 
-    renderer.m_copy_queue.flush_queue();
-    m_shared_chunk_position_buffer = result.structured_buffer;
+ChunkNeighborApron ChunkManager::capture_neighbor_apron(const size_t chunk_index) const
+{
+    // Neighbors that are still being setup are not available here. Once they are loaded, resolve_neighbor_borders
+    // takes care of the faces that were emitted towards them.
+    ChunkNeighborApron apron{};
+
+    for (u32 face = 0; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+    {
+        const FaceDirection face_direction = static_cast<FaceDirection>(face);
+
+        if (const LoadedChunk *const neighbor = m_loaded_chunks.find_neighbor(chunk_index, face_direction))
+        {
+            apron.m_slabs[face] = neighbor->m_chunk.get_boundary_slab(get_opposite_face_direction(face_direction));
+            apron.m_available_neighbors_mask |= static_cast<u8>(1u << face);
+        }
+    }
 
-    m_thread_pool.reset(6);
+    return apron;
 }
 
-ChunkManager::SetupChunkData ChunkManager::internal_mt_setup_chunk(Renderer &renderer, const size_t index)
+void ChunkManager::resolve_neighbor_borders(const size_t chunk_index)
 {
-    SetupChunkData setup_chunk_data{};
+    static constexpr auto is_slab_empty = [](const std::array<u64, Chunk::NUMBER_OF_VOXELS_PER_DIMENSION> &slab) {
+        return std::all_of(slab.begin(), slab.end(), [](const u64 row) { return row == 0ull; });
+    };
 
-    // Iterate over each voxel in chunk and setup the chunk index and color buffer.
-    std::vector<u16> chunk_index_data{};
-    std::vector<DirectX::XMFLOAT3> color_data{};
-
-    std::random_device random_device{};
-    std::mt19937 engine(random_device());
-    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
-
-    // note(rtarun9) : Only for demo purposes.
-    const DirectX::XMFLOAT3 chunk_color = {
-        dist(engine),
-        dist(engine),
-        dist(engine),
+    // Returns true if chunk (which was meshed without knowing about neighbor) has to be re-meshed.
+    // If either side of the border is empty, the faces emitted by chunk are already correct.
+    const auto is_remesh_required = [&](const Chunk &chunk, const Chunk &neighbor, const FaceDirection face_direction) {
+        return !is_slab_empty(chunk.get_boundary_slab(face_direction)) &&
+               !is_slab_empty(neighbor.get_boundary_slab(get_opposite_face_direction(face_direction)));
     };
 
-    for (size_t i = 0; i < Chunk::NUMBER_OF_VOXELS; i++)
+    Chunk &chunk = m_loaded_chunks.find(chunk_index)->m_chunk;
+    bool is_chunk_remesh_required = false;
+
+    for (u32 face = 0; face < NUMBER_OF_FACE_DIRECTIONS; face++)
     {
-        if (!setup_chunk_data.m_chunk.m_voxels[i].m_active)
+        const FaceDirection face_direction = static_cast<FaceDirection>(face);
+        const u8 face_bit = static_cast<u8>(1u << face);
+        const u8 opposite_face_bit =
+            static_cast<u8>(1u << static_cast<u32>(get_opposite_face_direction(face_direction)));
+
+        LoadedChunk *const loaded_neighbor = m_loaded_chunks.find_neighbor(chunk_index, face_direction);
+        if (!loaded_neighbor)
         {
             continue;
         }
 
-        const auto voxel_color = chunk_color;
-
-        const DirectX::XMUINT3 index_3d = convert_to_3d(i, Chunk::NUMBER_OF_VOXELS_PER_DIMENSION);
-        const u16 shared_index_buffer_offset = i * 8u;
+        Chunk &neighbor = loaded_neighbor->m_chunk;
+        const size_t neighbor_index = neighbor.m_chunk_index;
 
-        // Check if there is a voxel that blocks the front face of current voxel.
+        // The neighbor may have been loaded after this chunk was submitted for setup.
+        if (!(chunk.m_meshed_neighbors_mask & face_bit))
         {
-
-            const bool is_front_face_covered =
-                (index_3d.z != 0 && setup_chunk_data.m_chunk
-                                        .m_voxels[convert_to_1d({index_3d.x, index_3d.y, index_3d.z - 1},
-                                                                Chunk::NUMBER_OF_VOXELS_PER_DIMENSION)]
-                                        .m_active);
-
-            if (!is_front_face_covered)
+            if (is_remesh_required(chunk, neighbor, face_direction))
             {
-                color_data.emplace_back(voxel_color);
-                for (const auto &vertex_index : {0u, 1u, 2u, 0u, 2u, 3u})
-                {
-                    chunk_index_data.push_back(vertex_index + shared_index_buffer_offset);
-                }
+                is_chunk_remesh_required = true;
+            }
+            else
+            {
+                chunk.m_meshed_neighbors_mask |= face_bit;
             }
         }
 
-        // Check if there is a voxel that blocks the back face of current voxel.
+        // If the neighbor is already waiting for a re-mesh, it will capture this chunk when it is submitted.
+        if (!(neighbor.m_meshed_neighbors_mask & opposite_face_bit) &&
+            !m_chunk_indices_that_are_being_setup.contains(neighbor_index))
         {
-
-            const bool is_back_face_covered = (index_3d.z != Chunk::NUMBER_OF_VOXELS_PER_DIMENSION - 1u &&
-                                               setup_chunk_data.m_chunk
-                                                   .m_voxels[convert_to_1d({index_3d.x, index_3d.y, index_3d.z + 1},
-                                                                           Chunk::NUMBER_OF_VOXELS_PER_DIMENSION)]
-                                                   .m_active);
-
-            color_data.emplace_back(voxel_color);
-            if (!is_back_face_covered)
+            if (is_remesh_required(neighbor, chunk, get_opposite_face_direction(face_direction)))
             {
-                for (const auto &vertex_index : {4u, 6u, 5u, 4u, 7u, 6u})
-                {
-                    chunk_index_data.push_back(vertex_index + shared_index_buffer_offset);
-                }
+                add_chunk_to_remesh_queue(neighbor_index);
+            }
+            else
+            {
+                neighbor.m_meshed_neighbors_mask |= opposite_face_bit;
             }
         }
+    }
 
-        // Check if there is a voxel that blocks the left hand side face of current voxel.
-        {
+    if (is_chunk_remesh_required)
+    {
+        add_chunk_to_remesh_queue(chunk_index);
+    }
+}
 
-            const bool is_left_face_covered =
-                (index_3d.x != 0u && setup_chunk_data.m_chunk
-                                         .m_voxels[convert_to_1d({index_3d.x - 1, index_3d.y, index_3d.z},
-                                                                 Chunk::NUMBER_OF_VOXELS_PER_DIMENSION)]
-                                         .m_active);
+void ChunkManager::add_chunk_to_remesh_queue(const size_t chunk_index)
+{
+    m_chunk_indices_that_are_being_setup.insert(chunk_index);
+    m_chunks_to_remesh_queue.push(chunk_index);
+    update_chunk_octree_flags(chunk_index);
+}
 
-            color_data.emplace_back(voxel_color);
-            if (!is_left_face_covered)
-            {
-                for (const auto &vertex_index : {4u, 5u, 1u, 4u, 1u, 0u})
-                {
-                    chunk_index_data.push_back(vertex_index + shared_index_buffer_offset);
-                }
-            }
-        }
+void ChunkManager::remesh_chunk_if_lod_changed(const size_t chunk_index, const DirectX::XMINT3 center_chunk_index_3d)
+{
+    const LoadedChunk *const loaded_chunk = m_loaded_chunks.find(chunk_index);
 
-        // Check if there is a voxel that blocks the right hand side face of current voxel.
-        {
+    // Uniform chunks have the same mesh (if any) at every level of detail.
+    if (!loaded_chunk || loaded_chunk->m_chunk.m_occupancy_state != OccupancyState::Mixed ||
+        m_chunk_indices_that_are_being_setup.contains(chunk_index) ||
+        loaded_chunk->m_lod == get_chunk_lod(chunk_index, center_chunk_index_3d))
+    {
+        return;
+    }
 
-            const bool is_right_face_covered = (index_3d.x != Chunk::NUMBER_OF_VOXELS_PER_DIMENSION - 1u &&
-                                                setup_chunk_data.m_chunk
-                                                    .m_voxels[convert_to_1d({index_3d.x + 1, index_3d.y, index_3d.z},
-                                                                            Chunk::NUMBER_OF_VOXELS_PER_DIMENSION)]
-                                                    .m_active);
+    add_chunk_to_remesh_queue(chunk_index);
+    m_number_of_lod_remeshes++;
+}
 
-            if (!is_right_face_covered)
-            {
-                color_data.emplace_back(voxel_color);
-                for (const auto &vertex_index : {3u, 2u, 6u, 3u, 6u, 7u})
-                {
-                    chunk_index_data.push_back(vertex_index + shared_index_buffer_offset);
-                }
-            }
-        }
+void ChunkManager::update_chunk_octree_flags(const size_t chunk_index)
+{
+    const LoadedChunk &loaded_chunk = *m_loaded_chunks.find(chunk_index);
 
-        // Check if there is a voxel that blocks the top side face of current voxel.
-        {
+    u8 flags = 0u;
+    flags |= loaded_chunk.m_chunk.m_occupancy_state == OccupancyState::Empty ? ChunkOctree::FLAG_EMPTY : 0u;
+    flags |= loaded_chunk.m_chunk.m_occupancy_state == OccupancyState::Full ? ChunkOctree::FLAG_FULL : 0u;
+    flags |= loaded_chunk.m_indirect_command_handle != ChunkIndirectCommandArray::INVALID_HANDLE
+                 ? ChunkOctree::FLAG_HAS_MESH
+                 : 0u;
+    flags |= m_chunk_indices_that_are_being_setup.contains(chunk_index) ? ChunkOctree::FLAG_DIRTY : 0u;
+
+    m_chunk_octree.set_chunk(chunk_index, convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index), flags);
+}
+
+void ChunkManager::retire_chunk_buffers(const size_t chunk_index, const u64 direct_queue_fence_value)
+{
+    LoadedChunk *const loaded_chunk = m_loaded_chunks.find(chunk_index);
+    if (!loaded_chunk || !loaded_chunk->m_region_allocation.is_valid())
+    {
+        return;
+    }
+
+    m_number_of_loaded_triangles -= loaded_chunk->m_region_allocation.m_number_of_faces * 2u;
+
+    if (const std::optional<size_t> moved_chunk_index =
+            m_chunk_indirect_commands.remove(loaded_chunk->m_indirect_command_handle))
+    {
+        m_loaded_chunks.find(*moved_chunk_index)->m_indirect_command_handle = loaded_chunk->m_indirect_command_handle;
+    }
+    loaded_chunk->m_indirect_command_handle = ChunkIndirectCommandArray::INVALID_HANDLE;
+    loaded_chunk->m_face_direction_index_ranges = {};
+
+    // The range is no longer drawn by the commands of the region, but frames in flight may still read it. The range of
+    // a loaded chunk has been uploaded already, so there is no upload buffer left.
+    m_chunk_regions.set_loaded_mesh(convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index),
+                                    ChunkRegionAllocation{}, FaceDirectionIndexRanges{}, direct_queue_fence_value);
 
-            const bool is_top_face_covered = (index_3d.y != Chunk::NUMBER_OF_VOXELS_PER_DIMENSION - 1 &&
-                                              setup_chunk_data.m_chunk
-                                                  .m_voxels[convert_to_1d({index_3d.x, index_3d.y + 1, index_3d.z},
-                                                                          Chunk::NUMBER_OF_VOXELS_PER_DIMENSION)]
-                                                  .m_active);
+    m_direct_queue_retired_chunk_buffers.emplace(RetiredChunkBuffers{
+        .m_fence_value = direct_queue_fence_value,
+        .m_region_allocation = loaded_chunk->m_region_allocation,
+    });
+    loaded_chunk->m_region_allocation = {};
+}
+
+void ChunkManager::add_chunk_to_setup_queue(const size_t index)
+{
+    if (m_loaded_chunks.contains(index) || m_chunk_indices_that_are_being_setup.contains(index))
+    {
+        return;
+    }
+
+    const DirectX::XMUINT3 index_3d = convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(index);
+    m_heightmap_column_cache.acquire(index_3d.x, index_3d.z);
+
+    m_chunk_indices_that_are_being_setup.insert(index);
+    m_chunk_load_scheduler.add(index, index_3d);
+}
+
+// Inclusive range of chunk indices along one axis. Empty if min > max.
+struct ChunkRange
+{
+    i32 m_min{};
+    i32 m_max{};
+};
+
+// Chunks along one axis that are in a but not in b. As both ranges have the same length, this is a single range.
+static ChunkRange get_chunk_range_difference(const ChunkRange a, const ChunkRange b)
+{
+    if (b.m_max < a.m_min || b.m_min > a.m_max)
+    {
+        return a;
+    }
+
+    if (b.m_min > a.m_min)
+    {
+        return {a.m_min, b.m_min - 1};
+    }
+
+    return {b.m_max + 1, a.m_max};
+}
+
+static ChunkRange get_chunk_range_intersection(const ChunkRange a, const ChunkRange b)
+{
+    return {std::max(a.m_min, b.m_min), std::min(a.m_max, b.m_max)};
+}
 
-            if (!is_top_face_covered)
+// Calls function with the index of each chunk (inside the world grid) that is within distance of center a, but not
+// of center b (along the axis where the distance is largest). The difference of the two cubes is split into (at most)
+// three disjoint slabs, one per axis, so only the chunks in the difference are visited.
+template <typename Function>
+static void for_each_chunk_in_cube_difference(const DirectX::XMINT3 a, const DirectX::XMINT3 b, const i32 distance,
+                                              Function &&function)
+{
+    const std::array<ChunkRange, 3u> a_ranges = {
+        ChunkRange{a.x - distance, a.x + distance},
+        ChunkRange{a.y - distance, a.y + distance},
+        ChunkRange{a.z - distance, a.z + distance},
+    };
+    const std::array<ChunkRange, 3u> b_ranges = {
+        ChunkRange{b.x - distance, b.x + distance},
+        ChunkRange{b.y - distance, b.y + distance},
+        ChunkRange{b.z - distance, b.z + distance},
+    };
+
+    static constexpr i32 MAX_CHUNK_INDEX = static_cast<i32>(ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION) - 1;
+
+    for (u32 axis = 0u; axis < 3u; axis++)
+    {
+        // Axes before the slab axis are restricted to the intersection, so that the slabs do not overlap.
+        std::array<ChunkRange, 3u> slab = a_ranges;
+        for (u32 previous_axis = 0u; previous_axis < axis; previous_axis++)
+        {
+            slab[previous_axis] = get_chunk_range_intersection(a_ranges[previous_axis], b_ranges[previous_axis]);
+        }
+        slab[axis] = get_chunk_range_difference(a_ranges[axis], b_ranges[axis]);
+
+        for (i32 z = std::max(slab[2].m_min, 0); z <= std::min(slab[2].m_max, MAX_CHUNK_INDEX); z++)
+        {
+            for (i32 y = std::max(slab[1].m_min, 0); y <= std::min(slab[1].m_max, MAX_CHUNK_INDEX); y++)
             {
-                color_data.emplace_back(voxel_color);
-                for (const auto &vertex_index : {1u, 5u, 6u, 1u, 6u, 2u})
+                for (i32 x = std::max(slab[0].m_min, 0); x <= std::min(slab[0].m_max, MAX_CHUNK_INDEX); x++)
                 {
-                    chunk_index_data.push_back(vertex_index + shared_index_buffer_offset);
+                    function(convert_to_1d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(
+                        {static_cast<u32>(x), static_cast<u32>(y), static_cast<u32>(z)}));
                 }
             }
         }
+    }
+}
 
-        // Check if there is a voxel that blocks the bottom side face of current voxel.
-        {
+void ChunkManager::add_chunks_around_player_to_setup_queue(const DirectX::XMUINT3 player_chunk_index_3d)
+{
+    if (m_player_chunk_index_3d.has_value() && m_player_chunk_index_3d->x == player_chunk_index_3d.x &&
+        m_player_chunk_index_3d->y == player_chunk_index_3d.y && m_player_chunk_index_3d->z == player_chunk_index_3d.z)
+    {
+        return;
+    }
 
-            const bool is_bottom_face_covered =
-                (index_3d.y != 0u && setup_chunk_data.m_chunk
-                                         .m_voxels[convert_to_1d({index_3d.x, index_3d.y - 1, index_3d.z},
-                                                                 Chunk::NUMBER_OF_VOXELS_PER_DIMENSION)]
-                                         .m_active);
+    const DirectX::XMINT3 center = {
+        static_cast<i32>(player_chunk_index_3d.x),
+        static_cast<i32>(player_chunk_index_3d.y),
+        static_cast<i32>(player_chunk_index_3d.z),
+    };
 
-            if (!is_bottom_face_covered)
-            {
-                color_data.emplace_back(voxel_color);
-                for (const auto &vertex_index : {4u, 0u, 3u, 4u, 3u, 7u})
-                {
-                    chunk_index_data.push_back(vertex_index + shared_index_buffer_offset);
-                }
-            }
+    // Chunks that were added from the previous position are already loaded or being setup, so only the chunks that
+    // entered render distance are added. Without a previous position, the previous cube is placed out of reach so that
+    // every chunk around the player is added.
+    static constexpr i32 FAR_AWAY_CHUNK_INDEX = -4 * static_cast<i32>(CHUNK_UNLOAD_DISTANCE);
+    const DirectX::XMINT3 previous_center =
+        m_player_chunk_index_3d.has_value()
+            ? DirectX::XMINT3{static_cast<i32>(m_player_chunk_index_3d->x),
+                              static_cast<i32>(m_player_chunk_index_3d->y),
+                              static_cast<i32>(m_player_chunk_index_3d->z)}
+            : DirectX::XMINT3{FAR_AWAY_CHUNK_INDEX, FAR_AWAY_CHUNK_INDEX, FAR_AWAY_CHUNK_INDEX};
+
+    for_each_chunk_in_cube_difference(center, previous_center, static_cast<i32>(CHUNK_RENDER_DISTANCE),
+                                      [&](const size_t chunk_index) { add_chunk_to_setup_queue(chunk_index); });
+
+    if (m_player_chunk_index_3d.has_value())
+    {
+        // The level of detail of a chunk only changes if it crossed one of the level of detail distances, i.e if it is
+        // within the distance of one of the centers but not of the other.
+        const auto remesh_chunk = [&](const size_t chunk_index) { remesh_chunk_if_lod_changed(chunk_index, center); };
+        for (const u32 lod_distance : CHUNK_LOD_DISTANCES)
+        {
+            for_each_chunk_in_cube_difference(center, previous_center, static_cast<i32>(lod_distance), remesh_chunk);
+            for_each_chunk_in_cube_difference(previous_center, center, static_cast<i32>(lod_distance), remesh_chunk);
         }
+
+        for_each_chunk_in_cube_difference(previous_center, center, static_cast<i32>(CHUNK_RENDER_DISTANCE),
+                                          [&](const size_t chunk_index) {
+                                              if (m_loaded_chunks.contains(chunk_index))
+                                              {
+                                                  m_eviction_candidates.push_back(EvictionCandidate{
+                                                      .m_chunk_index = chunk_index,
+                                                  });
+                                              }
+                                          });
+    }
+    else
+    {
+        gather_eviction_candidates(center);
     }
+    m_eviction_candidates_view_chunk_index_3d.reset();
 
-    setup_chunk_data.m_chunk_indices_data = std::move(chunk_index_data);
-    setup_chunk_data.m_chunk_color_data = std::move(color_data);
+    // Chunks that are waiting to be setup would be dropped once popped anyway. Removing them now keeps the scheduler
+    // from dropping chunks that are still required.
+    for (const size_t chunk_index : m_chunk_load_scheduler.remove_if([&](const size_t chunk_index) {
+             return get_chunk_distance(chunk_index, center) > CHUNK_SETUP_CANCELLATION_DISTANCE;
+         }))
+    {
+        remove_chunk_from_setup(chunk_index);
+        m_number_of_cancelled_setup_chunks++;
+    }
 
-    if (!setup_chunk_data.m_chunk_indices_data.empty())
+    m_player_chunk_index_3d = player_chunk_index_3d;
+}
+
+void ChunkManager::gather_eviction_candidates(const DirectX::XMINT3 center)
+{
+    m_eviction_candidates.clear();
+    m_chunk_octree.for_each_chunk_further_than(center, CHUNK_RENDER_DISTANCE, [&](const size_t chunk_index) {
+        m_eviction_candidates.push_back(EvictionCandidate{
+            .m_chunk_index = chunk_index,
+        });
+    });
+}
+
+void ChunkManager::set_view(const ChunkLoadScheduler::View &view)
+{
+    // Chunks dropped by the scheduler are no longer being setup.
+    for (const size_t dropped_chunk_index : m_chunk_load_scheduler.set_view(view))
     {
+        remove_chunk_from_setup(dropped_chunk_index);
+    }
 
-        setup_chunk_data.m_chunk_index_buffer =
-            renderer.create_index_buffer((void *)setup_chunk_data.m_chunk_indices_data.data(), sizeof(u16),
-                                         setup_chunk_data.m_chunk_indices_data.size(),
-                                         std::wstring(L"Chunk Index buffer : ") + std::to_wstring(index));
-        setup_chunk_data.m_chunk_color_buffer =
-            renderer.create_structured_buffer((void *)setup_chunk_data.m_chunk_color_data.data(),
-                                              sizeof(DirectX::XMFLOAT3), setup_chunk_data.m_chunk_color_data.size(),
-                                              std::wstring(L"Chunk color buffer : ") + std::to_wstring(index));
+    m_view_chunk_index_3d = DirectX::XMINT3{
+        static_cast<i32>(std::floor(view.m_position.x)),
+        static_cast<i32>(std::floor(view.m_position.y)),
+        static_cast<i32>(std::floor(view.m_position.z)),
+    };
 
-        setup_chunk_data.m_chunk_constant_buffer = renderer.create_constant_buffer<1>(
-            sizeof(ChunkConstantBuffer), std::wstring(L"Chunk constant buffer : ") + std::to_wstring(index))[0];
+    // Cancelled chunks are only discarded once the workers are done with them (see
+    // transfer_chunks_from_setup_to_loaded_state).
+    for (const auto &[chunk_index, cancellation_token] : m_setup_chunk_cancellation_tokens)
+    {
+        if (!is_chunk_in_setup_range(chunk_index))
+        {
+            cancellation_token.cancel();
+        }
     }
+}
 
-    setup_chunk_data.m_chunk.m_chunk_index = index;
-    return setup_chunk_data;
+void ChunkManager::remove_chunk_from_setup(const size_t chunk_index)
+{
+    m_chunk_indices_that_are_being_setup.erase(chunk_index);
+
+    // A loaded chunk (i.e one that was waiting to be re-meshed) holds its own reference.
+    if (!m_loaded_chunks.contains(chunk_index))
+    {
+        const DirectX::XMUINT3 chunk_index_3d = convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+        m_heightmap_column_cache.release(chunk_index_3d.x, chunk_index_3d.z);
+    }
+    else
+    {
+        update_chunk_octree_flags(chunk_index);
+    }
 }
 
-void ChunkManager::add_chunk_to_setup_stack(const u64 index)
+bool ChunkManager::is_chunk_in_setup_range(const size_t chunk_index) const
 {
-    if (m_loaded_chunks.contains(index) || m_chunk_indices_that_are_being_setup.contains(index))
+    if (!m_view_chunk_index_3d.has_value())
     {
-        return;
+        return true;
     }
 
-    m_chunk_indices_that_are_being_setup.insert(index);
-    m_chunks_to_setup_stack.push(index);
+    return get_chunk_distance_to_view(chunk_index) <= CHUNK_SETUP_CANCELLATION_DISTANCE;
+}
+
+u32 ChunkManager::get_chunk_distance_to_view(const size_t chunk_index) const
+{
+    return get_chunk_distance(chunk_index, *m_view_chunk_index_3d);
+}
+
+u32 ChunkManager::get_chunk_lod(const size_t chunk_index, const DirectX::XMINT3 center_chunk_index_3d)
+{
+    const u32 distance = get_chunk_distance(chunk_index, center_chunk_index_3d);
+
+    return static_cast<u32>(std::count_if(CHUNK_LOD_DISTANCES.begin(), CHUNK_LOD_DISTANCES.end(),
+                                          [&](const u32 lod_distance) { return distance > lod_distance; }));
+}
+
+u32 ChunkManager::get_chunk_lod_from_view(const size_t chunk_index) const
+{
+    return m_view_chunk_index_3d.has_value() ? get_chunk_lod(chunk_index, *m_view_chunk_index_3d) : 0u;
 }
 
-void ChunkManager::create_chunks_from_setup_stack(Renderer &renderer)
+u32 ChunkManager::get_chunk_distance(const size_t chunk_index, const DirectX::XMINT3 center_chunk_index_3d)
 {
+    const DirectX::XMUINT3 chunk_index_3d = convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+
+    return static_cast<u32>(std::max({
+        std::abs(static_cast<i32>(chunk_index_3d.x) - center_chunk_index_3d.x),
+        std::abs(static_cast<i32>(chunk_index_3d.y) - center_chunk_index_3d.y),
+        std::abs(static_cast<i32>(chunk_index_3d.z) - center_chunk_index_3d.z),
+    }));
+}
+
+bool ChunkManager::unload_chunk(const size_t chunk_index, const u64 direct_queue_fence_value)
+{
+    if (!m_loaded_chunks.contains(chunk_index) || m_chunk_indices_that_are_being_setup.contains(chunk_index))
+    {
+        return false;
+    }
+
+    retire_chunk_buffers(chunk_index, direct_queue_fence_value);
+
+    const Chunk &chunk = m_loaded_chunks.find(chunk_index)->m_chunk;
+    m_number_of_loaded_chunks_per_occupancy_state[static_cast<u32>(chunk.m_occupancy_state)]--;
+    m_loaded_voxel_data_size_in_bytes -= chunk.get_voxel_data_size_in_bytes();
+    m_loaded_chunks.erase(chunk_index);
+
+    m_face_connectivity_version++;
+
+    const DirectX::XMUINT3 index_3d = convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+    m_chunk_octree.remove_chunk(index_3d);
+    m_heightmap_column_cache.release(index_3d.x, index_3d.z);
+
+    m_number_of_unloaded_chunks++;
+
+    return true;
+}
+
+void ChunkManager::create_chunks_from_setup_queue(GpuBackend &gpu_backend)
+{
+    // The meshing mode and terrain settings are captured by value, as they can be changed by the main thread while the
+    // task is running.
+    const MeshingMode meshing_mode = m_meshing_mode;
+    const TerrainPreset terrain_preset = m_terrain_preset;
+    const TerrainSettings terrain_settings = m_terrain_settings;
+
     u64 chunks_that_are_setup = 0u;
-    while (chunks_that_are_setup++ < ChunkManager::NUMBER_OF_CHUNKS_TO_CREATE_PER_FRAME &&
-           !m_chunks_to_setup_stack.empty())
+    while (chunks_that_are_setup < ChunkManager::NUMBER_OF_CHUNKS_TO_CREATE_PER_FRAME)
     {
-        const size_t top = m_chunks_to_setup_stack.top();
-        m_chunks_to_setup_stack.pop();
+        const std::optional<size_t> chunk_index = m_chunk_load_scheduler.pop();
+        if (!chunk_index.has_value())
+        {
+            break;
+        }
 
-        m_setup_chunk_futures_queue.emplace(std::pair{
-            renderer.m_copy_queue.m_monotonic_fence_value + 1,
-            m_thread_pool.submit_task([this, &renderer, top]() { return internal_mt_setup_chunk(renderer, top); })});
+        // The player has moved away since the chunk was added. It will be added again if the player comes back.
+        if (!is_chunk_in_setup_range(*chunk_index))
+        {
+            remove_chunk_from_setup(*chunk_index);
+            m_number_of_cancelled_setup_chunks++;
+
+            continue;
+        }
+
+        const ChunkNeighborApron apron = capture_neighbor_apron(*chunk_index);
+
+        // The column is shared by all chunks stacked vertically, and is generated by the first of them to run.
+        std::shared_ptr<HeightmapColumnCache::Entry> heightmap_column{};
+        if (terrain_preset == TerrainPreset::Heightmap)
+        {
+            const DirectX::XMUINT3 chunk_index_3d = convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(*chunk_index);
+            heightmap_column = m_heightmap_column_cache.get(chunk_index_3d.x, chunk_index_3d.z);
+        }
+
+        // Setup is split into a generation and a meshing job. Buffers are created by the meshing job, as the mesh only
+        // lives in the scratch mesh of the worker that created it.
+        const std::shared_ptr<SetupChunkData> setup_chunk_data = std::make_shared<SetupChunkData>();
+        const CancellationToken cancellation_token = m_setup_chunk_cancellation_tokens[*chunk_index];
+
+        const JobSystem::JobHandle generation_job = m_job_system.create_job(
+            [this, setup_chunk_data, chunk_index = *chunk_index, terrain_preset, terrain_settings, heightmap_column,
+             cancellation_token]() {
+                internal_mt_generate_chunk(*setup_chunk_data, chunk_index, terrain_preset, terrain_settings,
+                                           heightmap_column, cancellation_token);
+            },
+            JobPriority::High);
+
+        // Cancelled chunks are pushed into the completion queue too, so that the main thread knows when the workers
+        // are done with them.
+        const JobSystem::JobHandle meshing_job = m_job_system.create_job(
+            [this, &gpu_backend, setup_chunk_data, meshing_mode, lod = get_chunk_lod_from_view(*chunk_index), apron,
+             cancellation_token]() {
+                internal_mt_mesh_chunk(gpu_backend, *setup_chunk_data, meshing_mode, lod, apron, cancellation_token);
+                m_setup_chunk_completion_queue.push(std::move(*setup_chunk_data));
+            },
+            JobPriority::High);
+
+        JobSystem::add_dependency(meshing_job, generation_job);
+
+        m_job_system.submit(meshing_job);
+        m_job_system.submit(generation_job);
+
+        ++chunks_that_are_setup;
+    }
+
+    // New chunks take priority, re-meshing only removes faces that are hidden anyway.
+    while (chunks_that_are_setup < ChunkManager::NUMBER_OF_CHUNKS_TO_CREATE_PER_FRAME &&
+           !m_chunks_to_remesh_queue.empty())
+    {
+        const size_t front = m_chunks_to_remesh_queue.front();
+        m_chunks_to_remesh_queue.pop();
+
+        // The chunk keeps its current mesh, and can be unloaded.
+        if (!is_chunk_in_setup_range(front))
+        {
+            remove_chunk_from_setup(front);
+            m_number_of_cancelled_setup_chunks++;
+
+            continue;
+        }
+
+        const ChunkNeighborApron apron = capture_neighbor_apron(front);
+
+        // The job must be copyable, so the copy of the chunk is passed to it via a shared pointer.
+        const std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>(m_loaded_chunks.find(front)->m_chunk.clone());
+        const CancellationToken cancellation_token = m_setup_chunk_cancellation_tokens[front];
+
+        const JobSystem::JobHandle remeshing_job = m_job_system.create_job(
+            [this, &gpu_backend, chunk, meshing_mode, lod = get_chunk_lod_from_view(front), apron,
+             cancellation_token]() {
+                m_setup_chunk_completion_queue.push(internal_mt_remesh_chunk(gpu_backend, std::move(*chunk),
+                                                                             meshing_mode, lod, apron,
+                                                                             cancellation_token));
+            },
+            JobPriority::Normal);
+
+        m_job_system.submit(remeshing_job);
+
+        ++chunks_that_are_setup;
     }
 }
 
-void ChunkManager::transfer_chunks_from_setup_to_loaded_state(const u64 current_copy_queue_fence_value)
+void ChunkManager::load_setup_chunk(SetupChunkData &&setup_chunk_data, const u64 direct_queue_fence_value)
 {
-    using namespace std::chrono_literals;
+    const size_t chunk_index = setup_chunk_data.m_chunk.m_chunk_index;
 
-    u64 chunks_loaded = 0u;
-    while (!m_setup_chunk_futures_queue.empty() && chunks_loaded < ChunkManager::NUMBER_OF_CHUNKS_TO_LOAD_PER_FRAME)
+    if (setup_chunk_data.m_is_meshed)
+    {
+        MeshingStatistics &meshing_statistics = m_meshing_statistics[static_cast<u32>(setup_chunk_data.m_meshing_mode)];
+        meshing_statistics.m_number_of_chunks_meshed++;
+        meshing_statistics.m_number_of_triangles += setup_chunk_data.m_number_of_triangles;
+        meshing_statistics.m_total_meshing_time_us += setup_chunk_data.m_meshing_time_us;
+    }
+
+    if (setup_chunk_data.m_is_generated)
     {
-        auto &setup_chunk_data = m_setup_chunk_futures_queue.front();
+        GenerationStatistics &generation_statistics =
+            m_generation_statistics[static_cast<u32>(setup_chunk_data.m_terrain_preset)];
+        generation_statistics.m_number_of_chunks_generated++;
+        generation_statistics.m_number_of_voxels_generated += Chunk::NUMBER_OF_VOXELS;
+        generation_statistics.m_total_generation_time_us += setup_chunk_data.m_generation_time_us;
+        generation_statistics.m_number_of_heightmap_columns_generated +=
+            setup_chunk_data.m_is_heightmap_column_generated ? 1u : 0u;
+    }
 
-        switch (std::future_status status = setup_chunk_data.second.wait_for(0s); status)
+    m_number_of_loaded_triangles += setup_chunk_data.m_number_of_triangles;
+
+    // If the chunk was re-meshed, the previous range may still be in use by the GPU.
+    retire_chunk_buffers(chunk_index, direct_queue_fence_value);
+
+    // If the chunk was re-meshed, it is already counted.
+    LoadedChunk *loaded_chunk = m_loaded_chunks.find(chunk_index);
+    const bool is_chunk_remeshed = loaded_chunk != nullptr;
+    if (loaded_chunk)
+    {
+        m_number_of_loaded_chunks_per_occupancy_state[static_cast<u32>(loaded_chunk->m_chunk.m_occupancy_state)]--;
+        m_loaded_voxel_data_size_in_bytes -= loaded_chunk->m_chunk.get_voxel_data_size_in_bytes();
+    }
+    else
+    {
+        // The slot is free, see transfer_chunks_from_setup_to_loaded_state.
+        loaded_chunk = &m_loaded_chunks.insert(chunk_index);
+
+        // The player may have moved away while the chunk was being setup, in which case it has already left render
+        // distance.
+        if (m_view_chunk_index_3d.has_value() && get_chunk_distance_to_view(chunk_index) > CHUNK_RENDER_DISTANCE)
         {
-        case std::future_status::timeout: {
+            m_eviction_candidates.push_back(EvictionCandidate{
+                .m_chunk_index = chunk_index,
+            });
+            m_eviction_candidates_view_chunk_index_3d.reset();
+        }
+    }
+
+    // Chunks with no visible faces have no range. The upload range of the mesh is freed, as the copy is complete.
+    if (setup_chunk_data.m_region_allocation.is_valid())
+    {
+        loaded_chunk->m_region_allocation = setup_chunk_data.m_region_allocation;
+        m_mesh_upload_pool.free(setup_chunk_data.m_mesh_upload_allocation);
+        setup_chunk_data.m_mesh_upload_allocation = {};
+
+        const DirectX::XMUINT3 chunk_index_3d =
+            convert_to_3d<ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+
+        loaded_chunk->m_face_direction_index_ranges = setup_chunk_data.m_face_direction_index_ranges;
 
-            return;
+        // The faces of the range are in face direction order, just like the ones of the mesh.
+        ChunkIndirectCommand indirect_command = m_chunk_regions.create_indirect_command(
+            loaded_chunk->m_region_allocation, ChunkRegions::get_region_chunk_slot(chunk_index_3d));
+        for (u32 face = 0u; face < NUMBER_OF_FACE_DIRECTIONS; face++)
+        {
+            indirect_command.face_direction_index_counts[face] =
+                loaded_chunk->m_face_direction_index_ranges[face].m_number_of_indices;
         }
-        break;
 
-        case std::future_status::ready: {
-            // If this condition is satisfied, the buffers are ready, so chunk is ready to be loaded :)
-            if (setup_chunk_data.first <= current_copy_queue_fence_value)
-            {
-                SetupChunkData chunk_to_load = setup_chunk_data.second.get();
+        const DirectX::XMFLOAT3 chunk_min = {
+            static_cast<float>(chunk_index_3d.x * Chunk::CHUNK_LENGTH),
+            static_cast<float>(chunk_index_3d.y * Chunk::CHUNK_LENGTH),
+            static_cast<float>(chunk_index_3d.z * Chunk::CHUNK_LENGTH),
+        };
+        loaded_chunk->m_indirect_command_handle =
+            m_chunk_indirect_commands.add(chunk_index, indirect_command, chunk_min);
+
+        m_chunk_regions.set_loaded_mesh(chunk_index_3d, loaded_chunk->m_region_allocation,
+                                        loaded_chunk->m_face_direction_index_ranges, direct_queue_fence_value);
+    }
 
-                const size_t num_vertices = chunk_to_load.m_chunk_indices_data.size();
-                const size_t chunk_index = chunk_to_load.m_chunk.m_chunk_index;
+    m_chunk_indices_that_are_being_setup.erase(chunk_index);
 
-                m_chunk_index_buffers[chunk_index] = std::move(chunk_to_load.m_chunk_index_buffer.index_buffer);
-                m_chunk_color_buffers[chunk_index] = std::move(chunk_to_load.m_chunk_color_buffer.structured_buffer);
-                m_chunk_constant_buffers[chunk_index] = std::move(chunk_to_load.m_chunk_constant_buffer);
+    m_number_of_loaded_chunks_per_occupancy_state[static_cast<u32>(setup_chunk_data.m_chunk.m_occupancy_state)]++;
+    m_loaded_voxel_data_size_in_bytes += setup_chunk_data.m_chunk.get_voxel_data_size_in_bytes();
 
-                const DirectX::XMUINT3 chunk_index_3d =
-                    convert_to_3d(chunk_index, ChunkManager::NUMBER_OF_CHUNKS_PER_DIMENSION);
+    loaded_chunk->m_chunk = std::move(setup_chunk_data.m_chunk);
+
+    // Re-meshes (e.g to resolve neighbor borders) usually leave the face connectivity unchanged, in which case the
+    // potentially visible chunks do not have to be searched again. A chunk that was not loaded was all connected.
+    if (is_chunk_remeshed ? loaded_chunk->m_face_connectivity != setup_chunk_data.m_face_connectivity
+                          : setup_chunk_data.m_face_connectivity != CaveCulling::FaceConnectivity::all_connected())
+    {
+        m_face_connectivity_version++;
+    }
+    loaded_chunk->m_face_connectivity = setup_chunk_data.m_face_connectivity;
+    loaded_chunk->m_lod = setup_chunk_data.m_lod;
 
-                const DirectX::XMUINT3 chunk_offset =
-                    DirectX::XMUINT3(chunk_index_3d.x * Voxel::EDGE_LENGTH * Chunk::NUMBER_OF_VOXELS_PER_DIMENSION,
-                                     chunk_index_3d.y * Voxel::EDGE_LENGTH * Chunk::NUMBER_OF_VOXELS_PER_DIMENSION,
-                                     chunk_index_3d.z * Voxel::EDGE_LENGTH * Chunk::NUMBER_OF_VOXELS_PER_DIMENSION);
+    update_chunk_octree_flags(chunk_index);
+    resolve_neighbor_borders(chunk_index);
 
-                const ChunkConstantBuffer chunk_constant_buffer_data = {
-                    .translation_vector = {chunk_offset.x, chunk_offset.y, chunk_offset.z, 0u},
-                    .position_buffer_index = static_cast<u32>(m_shared_chunk_position_buffer.srv_index),
-                    .color_buffer_index = static_cast<u32>(m_chunk_color_buffers[chunk_index].srv_index),
-                };
+    // The player may have moved to another level of detail while the chunk was being setup.
+    if (m_view_chunk_index_3d.has_value())
+    {
+        remesh_chunk_if_lod_changed(chunk_index, *m_view_chunk_index_3d);
+    }
+}
+
+void ChunkManager::transfer_chunks_from_setup_to_loaded_state(GpuBackend &gpu_backend,
+                                                              const u64 current_copy_queue_fence_value,
+                                                              const u64 direct_queue_fence_value)
+{
+    // The mesh of a chunk is copied into a range of its region as soon as the chunk is done, unless it was cancelled.
+    m_setup_chunk_completion_queue.pop_all([&](SetupChunkData &&setup_chunk_data) {
+        const size_t chunk_index = setup_chunk_data.m_chunk.m_chunk_index;
+        if (setup_chunk_data.m_mesh_upload_allocation.is_valid() &&
+            !m_setup_chunk_cancellation_tokens[chunk_index].is_cancelled())
+        {
+            const u32 number_of_faces = static_cast<u32>(setup_chunk_data.m_number_of_triangles / 2u);
+            setup_chunk_data.m_region_allocation =
+                m_chunk_regions.allocate(gpu_backend, convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index),
+                                         number_of_faces, m_shared_chunk_position_buffer.srv_index);
 
-                m_chunk_constant_buffers[chunk_index].update(&chunk_constant_buffer_data);
+            const ChunkRegions::Page &page = m_chunk_regions.get_page(setup_chunk_data.m_region_allocation);
+            const size_t first_face = setup_chunk_data.m_region_allocation.m_first_face;
+            const size_t indices_size_in_bytes = sizeof(ChunkRegions::Index) * 6u * number_of_faces;
 
-                m_setup_chunk_futures_queue.pop();
+            gpu_backend.copy_buffer_region(page.m_index_buffer.resource, sizeof(ChunkRegions::Index) * 6u * first_face,
+                                           setup_chunk_data.m_mesh_upload_allocation.m_upload_buffer,
+                                           setup_chunk_data.m_mesh_upload_allocation.m_offset, indices_size_in_bytes);
+            gpu_backend.copy_buffer_region(page.m_color_buffer.resource, sizeof(DirectX::XMFLOAT3) * first_face,
+                                           setup_chunk_data.m_mesh_upload_allocation.m_upload_buffer,
+                                           setup_chunk_data.m_mesh_upload_allocation.m_offset + indices_size_in_bytes,
+                                           sizeof(DirectX::XMFLOAT3) * number_of_faces);
 
-                m_chunk_indices_that_are_being_setup.erase(chunk_index);
-                m_loaded_chunks[chunk_index] = std::move(chunk_to_load.m_chunk);
+            setup_chunk_data.m_copy_queue_fence_value = gpu_backend.get_last_copy_queue_fence_value();
+        }
+
+        m_completed_setup_chunks.emplace_back(std::move(setup_chunk_data));
+    });
+
+    // Each chunk is loaded as soon as its own range is ready, regardless of the chunks that completed before it.
+    u64 chunks_loaded = 0u;
+    auto setup_chunk_data = m_completed_setup_chunks.begin();
+    while (setup_chunk_data != m_completed_setup_chunks.end() &&
+           chunks_loaded < ChunkManager::NUMBER_OF_CHUNKS_TO_LOAD_PER_FRAME)
+    {
+        const size_t chunk_index = setup_chunk_data->m_chunk.m_chunk_index;
+
+        // The chunk may have been cancelled after its mesh was copied, in which case the range (and the upload
+        // range) are retired until the copy queue is done with them.
+        if (m_setup_chunk_cancellation_tokens[chunk_index].is_cancelled())
+        {
+            if (setup_chunk_data->m_mesh_upload_allocation.is_valid())
+            {
+                m_copy_queue_retired_chunk_buffers.emplace(RetiredChunkBuffers{
+                    .m_fence_value = setup_chunk_data->m_copy_queue_fence_value,
+                    .m_region_allocation = setup_chunk_data->m_region_allocation,
+                    .m_mesh_upload_allocation = std::move(setup_chunk_data->m_mesh_upload_allocation),
+                });
             }
-            else
+
+            m_setup_chunk_cancellation_tokens.erase(chunk_index);
+            remove_chunk_from_setup(chunk_index);
+            m_number_of_cancelled_setup_chunks++;
+
+            // The player may have come back within render distance of the chunk while the workers were still busy
+            // with it. The chunk was not added again then, as it was still being setup, so it is added now.
+            if (m_player_chunk_index_3d.has_value() &&
+                get_chunk_distance(chunk_index, DirectX::XMINT3{static_cast<i32>(m_player_chunk_index_3d->x),
+                                                                static_cast<i32>(m_player_chunk_index_3d->y),
+                                                                static_cast<i32>(m_player_chunk_index_3d->z)}) <=
+                    CHUNK_RENDER_DISTANCE)
             {
-                return;
+                if (m_loaded_chunks.contains(chunk_index))
+                {
+                    add_chunk_to_remesh_queue(chunk_index);
+                }
+                else
+                {
+                    add_chunk_to_setup_queue(chunk_index);
+                }
             }
+
+            setup_chunk_data = m_completed_setup_chunks.erase(setup_chunk_data);
+            continue;
         }
-        break;
+
+        // If this condition is satisfied, the range is ready, so chunk is ready to be loaded :)
+        if (setup_chunk_data->m_copy_queue_fence_value > current_copy_queue_fence_value)
+        {
+            ++setup_chunk_data;
+            continue;
+        }
+
+        // The slot of the chunk may still hold a chunk the player has moved away from, which is evicted right away
+        // rather than by evict_chunks. If that chunk is being re-meshed, it is out of setup range, so its re-mesh is
+        // about to be discarded : loading waits until then.
+        if (const size_t slot_chunk_index = m_loaded_chunks.get_slot(chunk_index).m_chunk_index;
+            slot_chunk_index != LoadedChunkGrid::EMPTY_SLOT && slot_chunk_index != chunk_index &&
+            !unload_chunk(slot_chunk_index, direct_queue_fence_value))
+        {
+            ++setup_chunk_data;
+            continue;
         }
 
+        m_setup_chunk_cancellation_tokens.erase(chunk_index);
+
+        load_setup_chunk(std::move(*setup_chunk_data), direct_queue_fence_value);
+        setup_chunk_data = m_completed_setup_chunks.erase(setup_chunk_data);
+
         ++chunks_loaded;
     }
 }
+
+size_t ChunkManager::evict_chunks(const u64 direct_queue_fence_value)
+{
+    if (!m_view_chunk_index_3d.has_value())
+    {
+        return 0u;
+    }
+
+    const DirectX::XMINT3 view_chunk_index_3d = *m_view_chunk_index_3d;
+    if (!m_eviction_candidates_view_chunk_index_3d.has_value() ||
+        m_eviction_candidates_view_chunk_index_3d->x != view_chunk_index_3d.x ||
+        m_eviction_candidates_view_chunk_index_3d->y != view_chunk_index_3d.y ||
+        m_eviction_candidates_view_chunk_index_3d->z != view_chunk_index_3d.z)
+    {
+        m_eviction_candidates_view_chunk_index_3d = view_chunk_index_3d;
+
+        for (EvictionCandidate &eviction_candidate : m_eviction_candidates)
+        {
+            eviction_candidate.m_distance = get_chunk_distance_to_view(eviction_candidate.m_chunk_index);
+        }
+
+        std::erase_if(m_eviction_candidates, [&](const EvictionCandidate &eviction_candidate) {
+            return eviction_candidate.m_distance <= CHUNK_RENDER_DISTANCE ||
+                   !m_loaded_chunks.contains(eviction_candidate.m_chunk_index);
+        });
+
+        std::sort(m_eviction_candidates.begin(), m_eviction_candidates.end(),
+                  [](const EvictionCandidate &a, const EvictionCandidate &b) { return a.m_distance < b.m_distance; });
+    }
+
+    // Chunks that are being re-meshed cannot be unloaded yet, so they are tried again next frame.
+    std::vector<EvictionCandidate> deferred_eviction_candidates{};
+
+    size_t number_of_evicted_chunks = 0u;
+    while (!m_eviction_candidates.empty() && number_of_evicted_chunks < CHUNKS_TO_UNLOAD_PER_FRAME)
+    {
+        // Once a candidate is within unload distance and the memory budget is not exceeded, so are the closer ones.
+        const EvictionCandidate &eviction_candidate = m_eviction_candidates.back();
+        if (eviction_candidate.m_distance <= CHUNK_UNLOAD_DISTANCE &&
+            get_memory_usage_in_bytes() <= m_memory_budget_in_bytes)
+        {
+            break;
+        }
+
+        if (unload_chunk(eviction_candidate.m_chunk_index, direct_queue_fence_value))
+        {
+            ++number_of_evicted_chunks;
+        }
+        else if (m_loaded_chunks.contains(eviction_candidate.m_chunk_index))
+        {
+            deferred_eviction_candidates.push_back(eviction_candidate);
+        }
+
+        m_eviction_candidates.pop_back();
+    }
+
+    // The deferred candidates were the furthest ones, so appending them (closest first) keeps the candidates sorted.
+    m_eviction_candidates.insert(m_eviction_candidates.end(), deferred_eviction_candidates.rbegin(),
+                                 deferred_eviction_candidates.rend());
+
+    return number_of_evicted_chunks;
+}
+
+void ChunkManager::release_retired_chunk_buffers(const u64 completed_copy_queue_fence_value,
+                                                 const u64 completed_direct_queue_fence_value)
+{
+    u32 number_of_released_chunk_buffers = 0u;
+
+    // The chunk buffers of each queue are released in the order they were retired in, until one of them is still in
+    // use.
+    const auto release_chunk_buffers = [&](std::queue<RetiredChunkBuffers> &retired_chunk_buffers_queue,
+                                           const u64 completed_fence_value) {
+        while (!retired_chunk_buffers_queue.empty() &&
+               number_of_released_chunk_buffers < NUMBER_OF_RETIRED_CHUNK_BUFFERS_TO_RELEASE_PER_FRAME &&
+               retired_chunk_buffers_queue.front().m_fence_value <= completed_fence_value)
+        {
+            const RetiredChunkBuffers &retired_chunk_buffers = retired_chunk_buffers_queue.front();
+            if (retired_chunk_buffers.m_region_allocation.is_valid())
+            {
+                m_chunk_regions.free(retired_chunk_buffers.m_region_allocation);
+            }
+
+            m_mesh_upload_pool.free(retired_chunk_buffers.m_mesh_upload_allocation);
+            retired_chunk_buffers_queue.pop();
+
+            ++number_of_released_chunk_buffers;
+        }
+    };
+
+    // The copy queue retired chunk buffers hold upload ranges, which have to be freed for the mesh upload pool to stay
+    // small, so they are released first.
+    release_chunk_buffers(m_copy_queue_retired_chunk_buffers, completed_copy_queue_fence_value);
+    release_chunk_buffers(m_direct_queue_retired_chunk_buffers, completed_direct_queue_fence_value);
+}
+
+u64 ChunkManager::get_memory_usage_in_bytes() const
+{
+    return m_loaded_voxel_data_size_in_bytes + m_chunk_regions.m_pages_size_in_bytes +
+           m_mesh_upload_pool.get_statistics().m_reserved_size_in_bytes;
+}
+
+void ChunkManager::update_occlusion_culling(const DirectX::XMFLOAT4X4 &view_projection_matrix,
+                                            const DirectX::XMFLOAT3 camera_position, const float near_plane)
+{
+    m_occlusion_culler.poll();
+    if (m_occlusion_culler.is_frame_in_flight())
+    {
+        return;
+    }
+
+    constexpr float chunk_length = static_cast<float>(Chunk::CHUNK_LENGTH);
+
+    OcclusionCuller::Frame frame{
+        .m_view_projection_matrix = view_projection_matrix,
+        .m_camera_position = camera_position,
+        .m_near_plane = near_plane,
+        .m_chunk_length = chunk_length,
+    };
+
+    const auto get_chunk_min = [&](const size_t chunk_index) {
+        const DirectX::XMUINT3 chunk_index_3d = convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index);
+        return DirectX::XMFLOAT3{
+            static_cast<float>(chunk_index_3d.x) * chunk_length,
+            static_cast<float>(chunk_index_3d.y) * chunk_length,
+            static_cast<float>(chunk_index_3d.z) * chunk_length,
+        };
+    };
+
+    // Chunks that are entirely full are solid boxes, whatever their neighbors.
+    m_chunk_octree.for_each_chunk(ChunkOctree::FLAG_FULL, [&](const size_t chunk_index) {
+        frame.m_occluder_chunk_mins.push_back(get_chunk_min(chunk_index));
+    });
+
+    if (frame.m_occluder_chunk_mins.size() > MAX_NUMBER_OF_OCCLUDERS)
+    {
+        const auto get_squared_distance_to_camera = [&](const DirectX::XMFLOAT3 &chunk_min) {
+            const float x = chunk_min.x + chunk_length * 0.5f - camera_position.x;
+            const float y = chunk_min.y + chunk_length * 0.5f - camera_position.y;
+            const float z = chunk_min.z + chunk_length * 0.5f - camera_position.z;
+
+            return x * x + y * y + z * z;
+        };
+
+        const auto nearest_occluders_end = frame.m_occluder_chunk_mins.begin() + MAX_NUMBER_OF_OCCLUDERS;
+        std::nth_element(frame.m_occluder_chunk_mins.begin(), nearest_occluders_end, frame.m_occluder_chunk_mins.end(),
+                         [&](const DirectX::XMFLOAT3 &a, const DirectX::XMFLOAT3 &b) {
+                             return get_squared_distance_to_camera(a) < get_squared_distance_to_camera(b);
+                         });
+        frame.m_occluder_chunk_mins.resize(MAX_NUMBER_OF_OCCLUDERS);
+    }
+
+    frame.m_chunk_indices = m_chunk_indirect_commands.m_owners;
+    frame.m_chunk_mins.reserve(m_chunk_indirect_commands.size());
+    for (size_t i = 0u; i < m_chunk_indirect_commands.size(); i++)
+    {
+        frame.m_chunk_mins.push_back({
+            m_chunk_indirect_commands.m_bounds_min_x[i],
+            m_chunk_indirect_commands.m_bounds_min_y[i],
+            m_chunk_indirect_commands.m_bounds_min_z[i],
+        });
+    }
+
+    m_occlusion_culler.submit(m_job_system, std::move(frame));
+}
+
+void ChunkManager::update_cave_culling(const DirectX::XMUINT3 camera_chunk_index_3d)
+{
+    const DirectX::XMINT3 camera_chunk_index = {
+        static_cast<i32>(camera_chunk_index_3d.x),
+        static_cast<i32>(camera_chunk_index_3d.y),
+        static_cast<i32>(camera_chunk_index_3d.z),
+    };
+
+    const CaveCulling::PotentiallyVisibleSet &potentially_visible_chunks = m_potentially_visible_chunks;
+    if (potentially_visible_chunks.m_is_valid &&
+        potentially_visible_chunks.m_camera_chunk_index_3d.x == camera_chunk_index.x &&
+        potentially_visible_chunks.m_camera_chunk_index_3d.y == camera_chunk_index.y &&
+        potentially_visible_chunks.m_camera_chunk_index_3d.z == camera_chunk_index.z &&
+        m_potentially_visible_chunks_version == m_face_connectivity_version)
+    {
+        return;
+    }
+
+    m_potentially_visible_chunks.update<NUMBER_OF_CHUNKS_PER_DIMENSION>(
+        camera_chunk_index, CHUNK_UNLOAD_DISTANCE,
+        [&](const size_t chunk_index) { return get_face_connectivity(chunk_index); });
+
+    m_potentially_visible_chunks_version = m_face_connectivity_version;
+    m_number_of_cave_culling_searches++;
+}
+
+CaveCulling::FaceConnectivity ChunkManager::get_face_connectivity(const size_t chunk_index) const
+{
+    const LoadedChunk *const loaded_chunk = m_loaded_chunks.find(chunk_index);
+
+    return loaded_chunk ? loaded_chunk->m_face_connectivity : CaveCulling::FaceConnectivity::all_connected();
+}
+
+bool ChunkManager::is_chunk_potentially_visible(const size_t chunk_index) const
+{
+    return m_potentially_visible_chunks.contains(convert_to_3d<NUMBER_OF_CHUNKS_PER_DIMENSION>(chunk_index));
+}
+
+size_t ChunkManager::cull_chunks_hierarchical(const FrustumCulling::Frustum &frustum,
+                                              u32 *const visible_command_indices)
+{
+    m_visible_chunk_indices.clear();
+    m_chunk_octree.cull_chunks(frustum, static_cast<float>(Chunk::CHUNK_LENGTH), m_visible_chunk_indices);
+
+    size_t number_of_visible_commands = 0u;
+    for (const size_t chunk_index : m_visible_chunk_indices)
+    {
+        visible_command_indices[number_of_visible_commands++] =
+            m_loaded_chunks.find(chunk_index)->m_indirect_command_handle;
+    }
+
+    return number_of_visible_commands;
+}